@@ -0,0 +1,56 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "hart/bb_cache.hh"
+
+namespace {
+
+constexpr std::int64_t kLRUSize = 256;
+constexpr std::size_t kNumLookups = 4096;
+
+sim::CachedBlock makeBlock(sim::Addr /* entry */) {
+  sim::Instruction inst{};
+  inst.type = sim::OpType::ADDI;
+  sim::CachedBlock cached{};
+  cached.bb.assign(4, inst);
+  return cached;
+}
+
+/*
+  Args: cache size (-1 - unbounded, 0 - none, LRU otherwise) & number of
+  distinct blocks: lookups are uniform over them, so the hit rate is about
+  min(1, size / blocks) for LRU.
+*/
+void lookup(benchmark::State &state) {
+  auto cache = sim::makeBBCache(state.range(0));
+  auto numBlocks = static_cast<sim::Addr>(state.range(1));
+
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<sim::Addr> dist{0, numBlocks - 1};
+  std::vector<sim::Addr> entries(kNumLookups);
+  for (auto &entry : entries)
+    entry = dist(gen) * 16;
+
+  std::int64_t numMisses{};
+  auto slowGetData = [&numMisses](sim::Addr entry) {
+    ++numMisses;
+    return makeBlock(entry);
+  };
+  for (auto _ : state)
+    for (auto entry : entries)
+      benchmark::DoNotOptimize(&cache->lookupUpdate(entry, slowGetData));
+
+  auto numLookups =
+      state.iterations() * static_cast<std::int64_t>(kNumLookups);
+  state.SetItemsProcessed(numLookups);
+  state.counters["miss_rate"] =
+      static_cast<double>(numMisses) / static_cast<double>(numLookups);
+}
+
+} // namespace
+
+BENCHMARK(lookup)
+    ->ArgNames({"size", "blocks"})
+    ->ArgsProduct({{-1, 0, kLRUSize}, {64, 1024}});
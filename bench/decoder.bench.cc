@@ -0,0 +1,47 @@
+#include <array>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "decoder/decoder.hh"
+
+namespace {
+
+// Instruction words of a compiled loop: arithmetic, memory, branches, CSRs
+constexpr std::array<sim::Word, 16> kWords{
+    0x00000513, // addi a0, zero, 0
+    0x00150513, // addi a0, a0, 1
+    0x00b50633, // add a2, a0, a1
+    0x40b50633, // sub a2, a0, a1
+    0x02b50533, // mul a0, a0, a1
+    0x02b54533, // div a0, a0, a1
+    0x0005a603, // lw a2, 0(a1)
+    0x00c5a023, // sw a2, 0(a1)
+    0x0045c603, // lbu a2, 4(a1)
+    0x000102b7, // lui t0, 0x10
+    0x00000297, // auipc t0, 0
+    0xfeb51ee3, // bne a0, a1, -4
+    0x00b54463, // blt a0, a1, 8
+    0x008000ef, // jal ra, 8
+    0x00008067, // ret
+    0x30529073, // csrw mtvec, t0
+};
+
+void decode(benchmark::State &state) {
+  for (auto word : kWords)
+    if (sim::Decoder::decode(word).type == sim::OpType::UNKNOWN) {
+      state.SkipWithError(("Unknown instruction " + std::to_string(word))
+                              .c_str());
+      return;
+    }
+
+  for (auto _ : state)
+    for (auto word : kWords)
+      benchmark::DoNotOptimize(sim::Decoder::decode(word));
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(kWords.size()));
+}
+
+} // namespace
+
+BENCHMARK(decode);
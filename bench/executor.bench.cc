@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+
+#include "common/state.hh"
+#include "decoder/decoder.hh"
+#include "executor/executor.hh"
+
+namespace {
+
+constexpr sim::Addr kDataAddr = 0x1000;
+
+/* Dispatch of a single handler through Executor::execute */
+void execute(benchmark::State &state, sim::Word word) {
+  auto inst = sim::Decoder::decode(word);
+  if (inst.type == sim::OpType::UNKNOWN) {
+    state.SkipWithError("Unknown instruction");
+    return;
+  }
+
+  sim::State simState{};
+  sim::Executor executor{};
+  simState.mem.storeEntity<sim::Word>(kDataAddr, 42);
+  simState.regs.set(10, 7);
+  simState.regs.set(11, kDataAddr);
+
+  for (auto _ : state) {
+    executor.execute(inst, simState);
+    benchmark::DoNotOptimize(simState.regs.get(12));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(execute, add, sim::Word{0x00b50633});  // add a2, a0, a1
+BENCHMARK_CAPTURE(execute, addi, sim::Word{0x00150613}); // addi a2, a0, 1
+BENCHMARK_CAPTURE(execute, mul, sim::Word{0x02b50633});  // mul a2, a0, a1
+BENCHMARK_CAPTURE(execute, lw, sim::Word{0x0005a603});   // lw a2, 0(a1)
+BENCHMARK_CAPTURE(execute, sw, sim::Word{0x00a5a023});   // sw a0, 0(a1)
+BENCHMARK_CAPTURE(execute, bne, sim::Word{0x00b51463});  // bne a0, a1, 8
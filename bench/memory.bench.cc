@@ -0,0 +1,104 @@
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "memory/memory.hh"
+
+namespace {
+
+constexpr std::size_t kNumAccesses = 4096;
+// Larger than TLB reach
+constexpr sim::Addr kRegionSize = 16 * 1024 * 1024;
+
+enum Pattern : std::int64_t { SEQUENTIAL, STRIDED, RANDOM };
+
+std::vector<sim::Addr> makeAddrs(Pattern pattern) {
+  std::vector<sim::Addr> addrs(kNumAccesses);
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<sim::Addr> dist{0, kRegionSize / 4 - 1};
+  for (std::size_t i = 0; i < kNumAccesses; ++i) {
+    auto idx = static_cast<sim::Addr>(i);
+    switch (pattern) {
+    case SEQUENTIAL:
+      addrs[i] = idx * 4;
+      break;
+    case STRIDED:
+      // New page every access
+      addrs[i] = (idx * (sim::kPageSize + 4)) % kRegionSize;
+      break;
+    case RANDOM:
+      addrs[i] = dist(gen) * 4;
+      break;
+    default:
+      throw std::invalid_argument{"Unknown access pattern"};
+    }
+  }
+  return addrs;
+}
+
+/* Memory w/ all pages of the region present */
+void populate(sim::Memory &mem) {
+  for (sim::Addr addr = 0; addr < kRegionSize; addr += sim::kPageSize)
+    mem.storeEntity<sim::Word>(addr, 0);
+}
+
+void load(benchmark::State &state) {
+  sim::Memory mem{};
+  populate(mem);
+  auto addrs = makeAddrs(static_cast<Pattern>(state.range(0)));
+
+  for (auto _ : state)
+    for (auto addr : addrs)
+      benchmark::DoNotOptimize(mem.loadEntity<sim::Word>(addr));
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(kNumAccesses));
+}
+
+void store(benchmark::State &state) {
+  sim::Memory mem{};
+  populate(mem);
+  auto addrs = makeAddrs(static_cast<Pattern>(state.range(0)));
+
+  sim::Word val{};
+  for (auto _ : state)
+    for (auto addr : addrs)
+      mem.storeEntity<sim::Word>(addr, ++val);
+  benchmark::DoNotOptimize(val);
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(kNumAccesses));
+}
+
+/* Args: number of pages looked up in a loop */
+void tlbLookup(benchmark::State &state) {
+  sim::TLB tlb{};
+  auto numPages = static_cast<std::size_t>(state.range(0));
+  std::vector<sim::Page> pages(numPages);
+  for (std::size_t i = 0; i < numPages; ++i) {
+    auto addr = static_cast<sim::Addr>(i * sim::kPageSize);
+    tlb.tlbUpdate(addr, &pages[i]);
+  }
+
+  std::int64_t numHits{};
+  for (auto _ : state)
+    for (std::size_t i = 0; i < numPages; ++i) {
+      auto addr = static_cast<sim::Addr>(i * sim::kPageSize);
+      auto *page = tlb.tlbLookup(addr);
+      numHits += page != nullptr;
+      if (!page)
+        tlb.tlbUpdate(addr, &pages[i]);
+    }
+
+  auto numLookups = state.iterations() * static_cast<std::int64_t>(numPages);
+  state.SetItemsProcessed(numLookups);
+  state.counters["hit_rate"] =
+      static_cast<double>(numHits) / static_cast<double>(numLookups);
+}
+
+} // namespace
+
+BENCHMARK(load)->ArgName("pattern")->DenseRange(SEQUENTIAL, RANDOM);
+BENCHMARK(store)->ArgName("pattern")->DenseRange(SEQUENTIAL, RANDOM);
+BENCHMARK(tlbLookup)->ArgName("pages")->Arg(64)->Arg(sim::kTLBSize)->Arg(
+    4 * sim::kTLBSize);
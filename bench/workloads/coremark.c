@@ -0,0 +1,134 @@
+// CoreMark-like kernels: list processing, matrix ops, state machine, CRC
+#include "workload.h"
+
+#define NUM_ITERS 300
+#define LIST_SIZE 128
+#define MAT_SIZE 16
+#define INPUT_SIZE 256
+
+struct Node {
+  struct Node *next;
+  short data;
+  short idx;
+};
+
+static struct Node nodes[LIST_SIZE];
+static short matA[MAT_SIZE][MAT_SIZE];
+static short matB[MAT_SIZE][MAT_SIZE];
+static int matC[MAT_SIZE][MAT_SIZE];
+static char input[INPUT_SIZE];
+
+static unsigned short crc16(unsigned short crc, unsigned char data) {
+  for (int i = 0; i < 8; ++i) {
+    unsigned carry = (crc ^ data) & 1;
+    data >>= 1;
+    crc >>= 1;
+    if (carry)
+      crc ^= 0xA001;
+  }
+  return crc;
+}
+
+static struct Node *reverse(struct Node *list) {
+  struct Node *res = 0;
+  while (list) {
+    struct Node *next = list->next;
+    list->next = res;
+    res = list;
+    list = next;
+  }
+  return res;
+}
+
+static unsigned listBench(struct Node *list, short key) {
+  unsigned found = 0;
+  for (struct Node *cur = list; cur; cur = cur->next)
+    if (cur->data == key)
+      found += (unsigned)cur->idx;
+  return found;
+}
+
+static unsigned matrixBench(short val) {
+  for (int i = 0; i < MAT_SIZE; ++i)
+    for (int j = 0; j < MAT_SIZE; ++j)
+      matA[i][j] = (short)(matA[i][j] + val);
+  unsigned res = 0;
+  for (int i = 0; i < MAT_SIZE; ++i)
+    for (int j = 0; j < MAT_SIZE; ++j) {
+      int acc = 0;
+      for (int k = 0; k < MAT_SIZE; ++k)
+        acc += matA[i][k] * matB[k][j];
+      matC[i][j] = acc;
+      res += (unsigned)(acc >> 2);
+    }
+  return res;
+}
+
+enum State { START, INT, FLOAT, EXP, INVALID };
+
+static unsigned stateBench(void) {
+  unsigned counts[5] = {0, 0, 0, 0, 0};
+  enum State state = START;
+  for (int i = 0; i < INPUT_SIZE; ++i) {
+    char ch = input[i];
+    if (ch == ',') {
+      ++counts[state];
+      state = START;
+      continue;
+    }
+    switch (state) {
+    case START:
+      state = ch >= '0' && ch <= '9' ? INT : INVALID;
+      break;
+    case INT:
+      if (ch == '.')
+        state = FLOAT;
+      else if (ch < '0' || ch > '9')
+        state = INVALID;
+      break;
+    case FLOAT:
+      if (ch == 'e')
+        state = EXP;
+      else if (ch < '0' || ch > '9')
+        state = INVALID;
+      break;
+    case EXP:
+      if (ch < '0' || ch > '9')
+        state = INVALID;
+      break;
+    default:
+      break;
+    }
+  }
+  return counts[INT] + 3 * counts[FLOAT] + 7 * counts[EXP] + counts[INVALID];
+}
+
+int main(void) {
+  static const char kAlphabet[] = "0123456789.e,x";
+  for (int i = 0; i < INPUT_SIZE; ++i)
+    input[i] = kAlphabet[rand32() % (sizeof(kAlphabet) - 1)];
+  for (int i = 0; i < MAT_SIZE; ++i)
+    for (int j = 0; j < MAT_SIZE; ++j) {
+      matA[i][j] = (short)(rand32() & 0xff);
+      matB[i][j] = (short)(rand32() & 0xff);
+    }
+  struct Node *list = 0;
+  for (int i = 0; i < LIST_SIZE; ++i) {
+    nodes[i].data = (short)(rand32() & 0x3f);
+    nodes[i].idx = (short)i;
+    nodes[i].next = list;
+    list = &nodes[i];
+  }
+
+  unsigned short crc = 0;
+  for (int iter = 0; iter < NUM_ITERS; ++iter) {
+    unsigned res = listBench(list, (short)(iter & 0x3f));
+    list = reverse(list);
+    res += matrixBench((short)iter);
+    res += stateBench();
+    for (int i = 0; i < 4; ++i)
+      crc = crc16(crc, (unsigned char)(res >> (8 * i)));
+  }
+  finish(crc);
+  return 0;
+}
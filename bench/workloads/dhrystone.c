@@ -0,0 +1,99 @@
+// Dhrystone-like mix: records, short strings, enums & integer arithmetic
+#include "workload.h"
+
+#define NUM_RUNS 50000
+
+enum Ident { IDENT_1, IDENT_2, IDENT_3, IDENT_4, IDENT_5 };
+
+struct Record {
+  struct Record *next;
+  enum Ident discr;
+  enum Ident enumComp;
+  int intComp;
+  char strComp[31];
+};
+
+static struct Record glob;
+static struct Record next;
+static int arr1[50];
+static int arr2[50][50];
+static char str1[31];
+static char str2[31];
+
+static void strCopy(char *dst, const char *src) {
+  while ((*dst++ = *src++))
+    ;
+}
+
+static int strCompare(const char *lhs, const char *rhs) {
+  while (*lhs && *lhs == *rhs) {
+    ++lhs;
+    ++rhs;
+  }
+  return *lhs - *rhs;
+}
+
+static enum Ident func1(char ch1, char ch2) {
+  return ch1 != ch2 ? IDENT_1 : IDENT_2;
+}
+
+static int func2(const char *s1, const char *s2) {
+  int idx = 2;
+  while (idx <= 2)
+    if (func1(s1[idx], s2[idx + 1]) == IDENT_1)
+      ++idx;
+  return strCompare(s1, s2) > 0;
+}
+
+static void proc8(int *a1, int (*a2)[50], int val1, int val2) {
+  int loc = val1 + 5;
+  a1[loc] = val2;
+  a1[loc + 1] = a1[loc];
+  a1[loc + 30] = loc;
+  for (int idx = loc; idx <= loc + 1; ++idx)
+    a2[loc][idx] = loc;
+  a2[loc][loc - 1] += 1;
+  a2[loc + 20][loc] = a1[loc];
+}
+
+static void proc3(struct Record *rec) {
+  // Field by field: freestanding build has no memcpy for struct copy
+  rec->next = &next;
+  next.next = rec->next;
+  next.discr = rec->discr;
+  next.enumComp = rec->enumComp;
+  next.intComp = rec->intComp + 10;
+  if (next.discr == IDENT_1)
+    next.enumComp = (enum Ident)((next.intComp % 5));
+}
+
+int main(void) {
+  glob.discr = IDENT_1;
+  glob.enumComp = IDENT_3;
+  glob.intComp = 40;
+  strCopy(glob.strComp, "DHRYSTONE PROGRAM, SOME STRING");
+  strCopy(str1, "DHRYSTONE PROGRAM, 1'ST STRING");
+
+  unsigned check = 0;
+  for (int run = 1; run <= NUM_RUNS; ++run) {
+    int int1 = 2;
+    int int2 = 3;
+    strCopy(str2, "DHRYSTONE PROGRAM, 2'ND STRING");
+    int boolVal = !func2(str1, str2);
+    int int3 = 0;
+    while (int1 < int2) {
+      int3 = 5 * int1 - int2;
+      ++int1;
+    }
+    proc8(arr1, arr2, int1, int3);
+    proc3(&glob);
+    for (char ch = 'A'; ch <= 'C'; ++ch)
+      if (func1(ch, 'C') == IDENT_2)
+        int2 = run;
+    int2 = int2 * int1;
+    int1 = int2 / int3;
+    check += (unsigned)(int1 + int2 + int3 + boolVal + next.intComp);
+  }
+  finish(check);
+  return 0;
+}
@@ -0,0 +1,36 @@
+// Integer matrix multiplication, row-major w/ transposed operand
+#include "workload.h"
+
+#define SIZE 64
+#define NUM_ROUNDS 8
+
+static int matA[SIZE][SIZE];
+static int matB[SIZE][SIZE];
+static int matBT[SIZE][SIZE];
+static int matC[SIZE][SIZE];
+
+int main(void) {
+  for (int i = 0; i < SIZE; ++i)
+    for (int j = 0; j < SIZE; ++j) {
+      matA[i][j] = (int)(rand32() & 0xffff) - 0x8000;
+      matB[i][j] = (int)(rand32() & 0xffff) - 0x8000;
+    }
+
+  unsigned check = 0;
+  for (int round = 0; round < NUM_ROUNDS; ++round) {
+    for (int i = 0; i < SIZE; ++i)
+      for (int j = 0; j < SIZE; ++j)
+        matBT[j][i] = matB[i][j] + round;
+    for (int i = 0; i < SIZE; ++i)
+      for (int j = 0; j < SIZE; ++j) {
+        int acc = 0;
+        for (int k = 0; k < SIZE; ++k)
+          acc += matA[i][k] * matBT[j][k];
+        matC[i][j] = acc;
+      }
+    for (int i = 0; i < SIZE; ++i)
+      check ^= (unsigned)matC[i][(i + round) % SIZE];
+  }
+  finish(check);
+  return 0;
+}
@@ -0,0 +1,33 @@
+// Pointer chasing over a random cycle larger than TLB reach
+#include "workload.h"
+
+#define NUM_NODES (256 * 1024)
+#define NUM_STEPS (2 * 1024 * 1024)
+
+struct Node {
+  struct Node *next;
+  unsigned pad[3];
+};
+
+static struct Node nodes[NUM_NODES];
+static unsigned order[NUM_NODES];
+
+int main(void) {
+  // Sattolo's shuffle: single cycle through all the nodes
+  for (unsigned i = 0; i < NUM_NODES; ++i)
+    order[i] = i;
+  for (unsigned i = NUM_NODES - 1; i > 0; --i) {
+    unsigned j = rand32() % i;
+    unsigned tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+  for (unsigned i = 0; i < NUM_NODES; ++i)
+    nodes[order[i]].next = &nodes[order[(i + 1) % NUM_NODES]];
+
+  struct Node *cur = &nodes[0];
+  for (unsigned step = 0; step < NUM_STEPS; ++step)
+    cur = cur->next;
+  finish((unsigned)(cur - nodes));
+  return 0;
+}
@@ -0,0 +1,168 @@
+#! /usr/bin/env python3
+"""This module runs workloads under simulator configurations & records
+performance, optionally comparing it w/ baseline results."""
+
+import argparse
+import json
+import statistics
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+# Basic block & TLB configurations: name -> simulator options
+CONFIGS = {
+    "bbc-inf": ["--bbc-size=-1"],
+    "bbc-256": ["--bbc-size=256"],
+    "bbc-off": ["--bbc-size=0"],
+    "tlb-64x4": ["--tlb-size=64", "--tlb-ways=4"],
+}
+
+STATS_GROUPS = "executor,bbcache,tlb"
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("workloads", nargs="+", type=Path, help="ELF files")
+    parser.add_argument("--simulator", required=True, type=Path)
+    parser.add_argument(
+        "--repeat", type=int, default=3, help="Number of timed runs"
+    )
+    parser.add_argument(
+        "--config",
+        action="append",
+        choices=CONFIGS.keys(),
+        help="Configurations to run (all by default)",
+    )
+    parser.add_argument("--out", required=True, type=Path, help="JSON file")
+    parser.add_argument("--baseline", type=Path, help="Previous results")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=5.0,
+        help="MIPS drop in percent reported as regression",
+    )
+    parser.add_argument(
+        "--fail-on-regression",
+        action="store_true",
+        help="Exit w/ error if any workload regressed",
+    )
+    return parser.parse_args()
+
+
+def run_timed(simulator, workload, options):
+    """Return MIPS of a run w/o instrumentation."""
+    out = subprocess.run(
+        [simulator, workload, "--print-perf", *options],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    for line in out.splitlines():
+        if line.startswith("Perf: "):
+            return float(line.split()[1])
+    # Run was too short to be timed
+    return 0.0
+
+
+def hit_rate(stats, prefix):
+    requests = stats.get(f"{prefix}_requests")
+    if not requests:
+        return None
+    return stats[f"{prefix}_hits"] / requests
+
+
+def run_stats(simulator, workload, options):
+    """Return final statistics of an instrumented run."""
+    with tempfile.TemporaryDirectory() as tmp:
+        stats_file = Path(tmp) / "stats.json"
+        subprocess.run(
+            [
+                simulator,
+                workload,
+                "--stats-file",
+                stats_file,
+                "--stats-groups",
+                STATS_GROUPS,
+                *options,
+            ],
+            check=True,
+            capture_output=True,
+        )
+        stats = json.loads(stats_file.read_text())[-1]
+
+    lookups = stats["bbcache.lookups"]
+    return {
+        "instructions": stats["executor.instructions"],
+        "bbcache_hit_rate": (
+            1.0 - stats["bbcache.misses"] / lookups if lookups else None
+        ),
+        # TLB statistics are collected only in TLB_STATS builds
+        "itlb_hit_rate": hit_rate(stats, "tlb.instr"),
+        "dtlb_hit_rate": hit_rate(stats, "tlb.data"),
+    }
+
+
+def fmt_rate(rate):
+    return "n/a" if rate is None else f"{100 * rate:.2f}%"
+
+
+def compare(results, baseline, threshold):
+    """Print MIPS change against baseline, return number of regressions."""
+    previous = {(res["workload"], res["config"]): res for res in baseline}
+    num_regressions = 0
+    print(f"\n{'Workload':<16}{'Config':<10}{'Base MIPS':>10}{'MIPS':>10}"
+          f"{'Change':>9}")
+    for res in results:
+        base = previous.get((res["workload"], res["config"]))
+        if not base or not base["mips"]:
+            continue
+        change = 100.0 * (res["mips"] / base["mips"] - 1.0)
+        mark = ""
+        if change < -threshold:
+            mark = "  REGRESSION"
+            num_regressions += 1
+        print(f"{res['workload']:<16}{res['config']:<10}{base['mips']:>10.2f}"
+              f"{res['mips']:>10.2f}{change:>+8.1f}%{mark}")
+    return num_regressions
+
+
+def main():
+    args = parse_args()
+    configs = args.config or list(CONFIGS)
+
+    results = []
+    print(f"{'Workload':<16}{'Config':<10}{'Instructions':>14}{'MIPS':>10}"
+          f"{'BBC hit':>9}{'ITLB hit':>9}{'DTLB hit':>9}")
+    for workload in args.workloads:
+        for config in configs:
+            options = CONFIGS[config]
+            runs = [
+                run_timed(args.simulator, workload, options)
+                for _ in range(args.repeat)
+            ]
+            res = {
+                "workload": workload.stem,
+                "config": config,
+                "mips": statistics.median(runs),
+                "mips_runs": runs,
+                **run_stats(args.simulator, workload, options),
+            }
+            results.append(res)
+            print(f"{res['workload']:<16}{config:<10}{res['instructions']:>14}"
+                  f"{res['mips']:>10.2f}{fmt_rate(res['bbcache_hit_rate']):>9}"
+                  f"{fmt_rate(res['itlb_hit_rate']):>9}"
+                  f"{fmt_rate(res['dtlb_hit_rate']):>9}")
+
+    args.out.write_text(json.dumps({"results": results}, indent=2) + "\n")
+
+    if not args.baseline:
+        return 0
+    baseline = json.loads(args.baseline.read_text())["results"]
+    num_regressions = compare(results, baseline, args.threshold)
+    print(f"\n{num_regressions} regression(s) over {args.threshold}%")
+    return 1 if num_regressions and args.fail_on_regression else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,58 @@
+// Quicksort w/ insertion sort for short ranges
+#include "workload.h"
+
+#define SIZE 16384
+#define NUM_ROUNDS 4
+
+static int arr[SIZE];
+
+static void insertionSort(int *begin, int *end) {
+  for (int *cur = begin + 1; cur < end; ++cur) {
+    int val = *cur;
+    int *pos = cur;
+    for (; pos > begin && pos[-1] > val; --pos)
+      *pos = pos[-1];
+    *pos = val;
+  }
+}
+
+static void quickSort(int *begin, int *end) {
+  while (end - begin > 16) {
+    int pivot = begin[(end - begin) / 2];
+    int *lo = begin;
+    int *hi = end - 1;
+    while (lo <= hi) {
+      while (*lo < pivot)
+        ++lo;
+      while (*hi > pivot)
+        --hi;
+      if (lo <= hi) {
+        int tmp = *lo;
+        *lo++ = *hi;
+        *hi-- = tmp;
+      }
+    }
+    // Recurse into the smaller part to bound the stack
+    if (hi - begin < end - lo) {
+      quickSort(begin, hi + 1);
+      begin = lo;
+    } else {
+      quickSort(lo, end);
+      end = hi + 1;
+    }
+  }
+  insertionSort(begin, end);
+}
+
+int main(void) {
+  unsigned check = 0;
+  for (int round = 0; round < NUM_ROUNDS; ++round) {
+    for (int i = 0; i < SIZE; ++i)
+      arr[i] = (int)(rand32() >> 1);
+    quickSort(arr, arr + SIZE);
+    for (int i = 1; i < SIZE; ++i)
+      check += arr[i - 1] <= arr[i];
+  }
+  finish(check);
+  return 0;
+}
@@ -0,0 +1,71 @@
+// String processing: tokenizing, hashing, searching & reversing words
+#include "workload.h"
+
+#define TEXT_SIZE 65536
+#define NUM_ROUNDS 4
+
+static char text[TEXT_SIZE + 1];
+
+static unsigned length(const char *str) {
+  const char *cur = str;
+  while (*cur)
+    ++cur;
+  return (unsigned)(cur - str);
+}
+
+static unsigned hashWord(const char *begin, const char *end) {
+  unsigned hash = 2166136261u;
+  for (; begin != end; ++begin)
+    hash = (hash ^ (unsigned char)*begin) * 16777619u;
+  return hash;
+}
+
+static void reverse(char *begin, char *end) {
+  while (begin < --end) {
+    char tmp = *begin;
+    *begin++ = *end;
+    *end = tmp;
+  }
+}
+
+static unsigned count(const char *str, const char *pattern) {
+  unsigned res = 0;
+  for (; *str; ++str) {
+    const char *lhs = str;
+    const char *rhs = pattern;
+    while (*rhs && *lhs == *rhs) {
+      ++lhs;
+      ++rhs;
+    }
+    res += !*rhs;
+  }
+  return res;
+}
+
+int main(void) {
+  static const char kLetters[] = "etaoinshrdlu   ";
+  for (int i = 0; i < TEXT_SIZE; ++i)
+    text[i] = kLetters[rand32() % (sizeof(kLetters) - 1)];
+  text[TEXT_SIZE] = '\0';
+
+  unsigned check = 0;
+  for (int round = 0; round < NUM_ROUNDS; ++round) {
+    unsigned numWords = 0;
+    char *cur = text;
+    while (*cur) {
+      while (*cur == ' ')
+        ++cur;
+      char *begin = cur;
+      while (*cur && *cur != ' ')
+        ++cur;
+      if (begin == cur)
+        continue;
+      check += hashWord(begin, cur);
+      reverse(begin, cur);
+      ++numWords;
+    }
+    check += numWords + length(text) + count(text, "the");
+  }
+  finish(check);
+  return 0;
+}
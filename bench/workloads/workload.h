@@ -0,0 +1,21 @@
+#ifndef __BENCH_WORKLOADS_WORKLOAD_H__
+#define __BENCH_WORKLOADS_WORKLOAD_H__
+
+/* Workloads are freestanding: main is the entry point & ends w/ ECALL */
+
+/* Results are stored here, so the work is not optimized out */
+volatile unsigned sink;
+
+static unsigned lcgState = 12345;
+
+static inline unsigned rand32(void) {
+  lcgState = lcgState * 1664525u + 1013904223u;
+  return lcgState;
+}
+
+static inline void finish(unsigned result) {
+  sink = result;
+  __asm__ volatile("ecall");
+}
+
+#endif // __BENCH_WORKLOADS_WORKLOAD_H__
@@ -0,0 +1,185 @@
+#ifndef __INCLUDE_ASSEMBLER_ASSEMBLER_HH__
+#define __INCLUDE_ASSEMBLER_ASSEMBLER_HH__
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common/common.hh"
+#include "common/inst.hh"
+
+namespace sim {
+
+namespace fs = std::filesystem;
+
+/* ABI register names */
+namespace reg {
+enum : RegId {
+  ZERO,
+  RA,
+  SP,
+  GP,
+  TP,
+  T0,
+  T1,
+  T2,
+  S0,
+  S1,
+  A0,
+  A1,
+  A2,
+  A3,
+  A4,
+  A5,
+  A6,
+  A7,
+  S2,
+  S3,
+  S4,
+  S5,
+  S6,
+  S7,
+  S8,
+  S9,
+  S10,
+  S11,
+  T3,
+  T4,
+  T5,
+  T6,
+};
+} // namespace reg
+
+/**
+ * @brief Mini RV32 assembler producing executables accepted by ELFLoader
+ * @details
+ * Instructions are encoded w/ Encoder generated from the same riscv-opcodes
+ * tables as the decoder. Code goes to text segment & data to data segment
+ * (initialized words followed by zeroed space), both of them are loadable.
+ * References to labels are resolved when the executable is written, so
+ * labels may be used before they are bound.
+ */
+class Assembler final {
+public:
+  static constexpr Addr kDefaultTextBase = 0x10000;
+  static constexpr Addr kDefaultDataBase = 0x400000;
+
+  /* Position in text or data segment */
+  struct Label final {
+    std::size_t id{};
+  };
+
+  explicit Assembler(Addr textBase = kDefaultTextBase,
+                     Addr dataBase = kDefaultDataBase);
+
+  [[nodiscard]] Label newLabel();
+  /* Bind label to the next instruction */
+  void bind(Label label);
+  [[nodiscard]] Label here() {
+    auto label = newLabel();
+    bind(label);
+    return label;
+  }
+  /* Address of bound label */
+  [[nodiscard]] Addr getAddr(Label label) const;
+
+  /* Start function symbol at the next instruction */
+  void beginFunction(const std::string &name);
+  void endFunction();
+  /* Program entry point, start of text by default */
+  void setEntry(Label label) { entry_ = label; }
+
+  /* Append instruction w/ fields set as for decoded one */
+  void emit(const Instruction &inst);
+
+  void rType(OpType type, RegId rd, RegId rs1, RegId rs2);
+  void iType(OpType type, RegId rd, RegId rs1, Word imm);
+  void load(OpType type, RegId rd, RegId base, Word offset) {
+    iType(type, rd, base, offset);
+  }
+  void store(OpType type, RegId src, RegId base, Word offset);
+  void branch(OpType type, RegId rs1, RegId rs2, Label target);
+  void lui(RegId rd, Word imm);
+  void jal(RegId rd, Label target);
+  void jalr(RegId rd, RegId rs1, Word offset);
+  void ecall();
+
+  /* Pseudo instructions */
+  void nop() { iType(OpType::ADDI, reg::ZERO, reg::ZERO, 0); }
+  void mv(RegId rd, RegId rs) { iType(OpType::ADDI, rd, rs, 0); }
+  void li(RegId rd, Word val);
+  /* Load address of label (always lui + addi) */
+  void la(RegId rd, Label label);
+  void j(Label target) { jal(reg::ZERO, target); }
+  void call(Label target) { jal(reg::RA, target); }
+  void ret() { jalr(reg::ZERO, reg::RA, 0); }
+
+  /* Data segment: initialized data is placed before zeroed one */
+  [[nodiscard]] Label dataWords(std::span<const Word> words);
+  /* Words w/ addresses of labels, e.g. jump tables */
+  [[nodiscard]] Label dataAddrs(std::span<const Label> labels);
+  /* Zeroed space, size is rounded up to words */
+  [[nodiscard]] Label bss(std::size_t size);
+
+  [[nodiscard]] Addr getPC() const {
+    return textBase_ + static_cast<Addr>(text_.size() * kXLENInBytes);
+  }
+  [[nodiscard]] std::size_t getNumInstrs() const { return text_.size(); }
+
+  /* Text w/ all the references resolved */
+  [[nodiscard]] std::vector<Word> assemble() const;
+  /* Write RV32 executable */
+  void write(std::ostream &ost) const;
+  void write(const fs::path &file) const;
+
+private:
+  enum class Fixup : std::uint8_t { BRANCH, JAL, HI20, LO12 };
+  struct TextRef final {
+    std::size_t index{};
+    Label label{};
+    Fixup fixup{};
+  };
+  struct DataRef final {
+    std::size_t index{};
+    Label label{};
+  };
+  /* Function symbol as range of instruction indices */
+  struct Symbol final {
+    std::string name{};
+    std::size_t begin{};
+    std::size_t end{};
+  };
+  /* Zeroed space follows initialized data, so it is placed on resolution */
+  enum class Segment : std::uint8_t { UNBOUND, TEXT, DATA, BSS };
+  struct LabelPos final {
+    Segment segment{Segment::UNBOUND};
+    // Instruction index for text, byte offset otherwise
+    std::size_t offset{};
+  };
+
+  [[nodiscard]] Label newLabel(Segment segment, std::size_t offset);
+  [[nodiscard]] Addr getBSSBase() const {
+    return dataBase_ + static_cast<Addr>(data_.size() * kXLENInBytes);
+  }
+  [[nodiscard]] std::vector<Word> resolveData() const;
+
+  Addr textBase_{};
+  Addr dataBase_{};
+  std::vector<Instruction> text_{};
+  std::vector<Word> data_{};
+  std::size_t bssSize_{};
+  std::vector<LabelPos> labels_{};
+  std::vector<TextRef> textRefs_{};
+  std::vector<DataRef> dataRefs_{};
+  std::vector<Symbol> symbols_{};
+  bool isInFunction_{false};
+  std::optional<Label> entry_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_ASSEMBLER_ASSEMBLER_HH__
@@ -0,0 +1,38 @@
+#ifndef __INCLUDE_ASSEMBLER_KERNELS_HH__
+#define __INCLUDE_ASSEMBLER_KERNELS_HH__
+
+#include <cstdint>
+
+#include "assembler/assembler.hh"
+
+namespace sim {
+
+/* Microkernels stressing particular parts of the simulator */
+enum class Kernel : std::uint8_t {
+  STRAIGHT_LINE, /* long basic blocks of ALU instructions */
+  LOOP,          /* tight inner loop, i.e. a lot of short blocks */
+  CALL_CHAIN,    /* deep chain of calls & returns */
+  INDIRECT_MAZE, /* blocks jumping to each other through jump table */
+  MEM_STRIDE,    /* loads & stores over array w/ given stride */
+};
+
+struct KernelParams final {
+  /* Number of iterations of the outer loop */
+  std::uint32_t iterations{1000};
+  /* Block length, inner loop trip count, call depth, number of maze blocks
+   * or number of array elements depending on kernel */
+  std::uint32_t size{64};
+  /* Distance between array elements in bytes, multiple of word size */
+  std::uint32_t stride{kXLENInBytes};
+};
+
+/**
+ * @brief Generate kernel finishing w/ ECALL
+ * @details Number of kernel's units of work (e.g. inner loop iterations,
+ * calls, visited blocks or accessed elements) is left in a0.
+ */
+void generateKernel(Assembler &as, Kernel kernel, const KernelParams &params);
+
+} // namespace sim
+
+#endif // __INCLUDE_ASSEMBLER_KERNELS_HH__
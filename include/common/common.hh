@@ -33,7 +33,7 @@ constexpr Word kDummyWord = 0;
 constexpr std::uint8_t kXLENInBytes = sizeof(Word);
 constexpr std::uint16_t kPageSize = 4096;
 constexpr std::uint16_t kTLBSize = 1024;
-constexpr std::uint16_t kTLBBits = 10;
+constexpr std::uint16_t kTLBWays = 4;
 constexpr std::uint16_t kOffsetBits = 12;
 constexpr std::uint32_t kTLBMask = -1U << kOffsetBits;
 
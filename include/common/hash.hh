@@ -0,0 +1,39 @@
+#ifndef __INCLUDE_COMMON_HASH_HH__
+#define __INCLUDE_COMMON_HASH_HH__
+
+#include <span>
+
+#include "common.hh"
+
+namespace sim {
+
+/**
+ * @brief Fast non-cryptographic hash for comparing simulation states
+ * @note Result depends on the order of added values
+ */
+class StateHasher final {
+public:
+  void add(DWord val) {
+    hash_ = (hash_ ^ val) * kMul;
+    hash_ ^= hash_ >> (sizeofBits<DWord>() / 2);
+  }
+
+  void add(std::span<const Word> words) {
+    auto size = words.size();
+    for (std::size_t i = 0; i + 1 < size; i += 2)
+      add(words[i] | DWord{words[i + 1]} << sizeofBits<Word>());
+    if (size % 2)
+      add(words.back());
+  }
+
+  [[nodiscard]] DWord get() const { return hash_; }
+
+private:
+  static constexpr DWord kMul = 0x9E3779B97F4A7C15;
+
+  DWord hash_{kMul};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_COMMON_HASH_HH__
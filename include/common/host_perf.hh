@@ -0,0 +1,101 @@
+#ifndef __INCLUDE_COMMON_HOST_PERF_HH__
+#define __INCLUDE_COMMON_HOST_PERF_HH__
+
+#include <algorithm>
+#include <array>
+#include <ostream>
+#include <string>
+
+#include "common/common.hh"
+
+namespace sim {
+
+/**
+ * @brief Host hardware performance counters of the simulator itself
+ * @details
+ * Counters are opened w/ perf_event_open for the calling thread (user space
+ * only) & run all the time, phases are measured as differences of readings.
+ * Decoding is nested in the run phase, so execution is run w/o decoding.
+ * Events which can not be opened (e.g. in containers) are reported as n/a.
+ */
+class HostPerf final {
+public:
+  enum Event : std::uint8_t {
+    CYCLES,
+    INSTRUCTIONS,
+    BRANCH_MISSES,
+    L1D_MISSES,
+    LLC_MISSES,
+    kNumEvents
+  };
+  enum Phase : std::uint8_t { LOAD, RUN, DECODE, kNumPhases };
+
+  using Values = std::array<std::uint64_t, kNumEvents>;
+
+  /* Measures phase till the end of scope, does nothing w/o counters */
+  class ScopedPhase final {
+  public:
+    ScopedPhase(HostPerf *perf, Phase phase) : perf_(perf), phase_(phase) {
+      if (perf_) [[unlikely]]
+        perf_->begin(phase_);
+    }
+    ScopedPhase(const ScopedPhase &) = delete;
+    ScopedPhase(ScopedPhase &&) = delete;
+    ScopedPhase &operator=(const ScopedPhase &) = delete;
+    ScopedPhase &operator=(ScopedPhase &&) = delete;
+    ~ScopedPhase() {
+      if (perf_) [[unlikely]]
+        perf_->end(phase_);
+    }
+
+  private:
+    HostPerf *perf_{};
+    Phase phase_{};
+  };
+
+  HostPerf();
+  HostPerf(const HostPerf &) = delete;
+  HostPerf(HostPerf &&) = delete;
+  HostPerf &operator=(const HostPerf &) = delete;
+  HostPerf &operator=(HostPerf &&) = delete;
+  ~HostPerf();
+
+  /* True if at least one event is counted */
+  [[nodiscard]] bool isAvailable() const;
+  [[nodiscard]] bool isAvailable(Event event) const {
+    return fds_[event] >= 0;
+  }
+  /* Reason of the first failed perf_event_open */
+  [[nodiscard]] const std::string &getError() const { return error_; }
+
+  void begin(Phase phase) { starts_[phase] = read(); }
+  void end(Phase phase) {
+    auto cur = read();
+    // Readings are scaled independently while multiplexed & may go back
+    for (std::size_t i = 0; i < kNumEvents; ++i)
+      totals_[phase][i] += cur[i] - std::min(cur[i], starts_[phase][i]);
+  }
+  void onBlock() { ++numBlocks_; }
+
+  [[nodiscard]] const Values &getTotals(Phase phase) const {
+    return totals_[phase];
+  }
+  [[nodiscard]] std::uint64_t getNumBlocks() const { return numBlocks_; }
+
+  /* Counters by phase & ratios per guest instruction/block */
+  void print(std::ostream &ost, std::uint64_t numGuestInstrs) const;
+
+private:
+  /* Current values scaled for multiplexing, 0 for unavailable events */
+  [[nodiscard]] Values read() const;
+
+  std::array<int, kNumEvents> fds_{};
+  std::string error_{};
+  std::array<Values, kNumPhases> starts_{};
+  std::array<Values, kNumPhases> totals_{};
+  std::uint64_t numBlocks_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_COMMON_HOST_PERF_HH__
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <spdlog/spdlog.h>
@@ -14,15 +15,25 @@
 #include "common/common.hh"
 #include "common/counters.hh"
 #include "memory/memory.hh"
+#include "trace/trace.hh"
 
 namespace sim {
 
 class RegFile final {
 private:
   std::array<RegVal, kRegNum> regs{};
+  Tracer *tracer_{};
+  bool isCosimLogged_{true};
 
 public:
   [[nodiscard]] RegVal get(RegId regnum) const { return regs.at(regnum); }
+  [[nodiscard]] const std::array<RegVal, kRegNum> &getAll() const {
+    return regs;
+  }
+  void setAll(const std::array<RegVal, kRegNum> &vals) {
+    regs = vals;
+    regs[0] = 0;
+  }
 
   void set(RegId regnum, RegVal val) {
     // NOP instruction looks like ADD x0, x0, 0 - assignment to x0,
@@ -31,11 +42,18 @@ public:
     if (!regnum)
       return;
 #ifdef SPDLOG
-    cosimLog("x{}=0x{:08x}", regnum, val);
+    if (isCosimLogged_)
+      cosimLog("x{}=0x{:08x}", regnum, val);
 #endif
+    if (tracer_) [[unlikely]]
+      tracer_->regWrite(regnum, val);
     regs.at(regnum) = val;
   }
 
+  void setTracer(Tracer *tracer) { tracer_ = tracer; }
+  /* Shadow register files (e.g. golden model ones) are not logged */
+  void setCosimLogged(bool isLogged) { isCosimLogged_ = isLogged; }
+
   [[nodiscard]] std::string str() const;
 };
 
@@ -44,10 +62,26 @@ private:
   std::vector<RegVal> regs{};
 
 public:
+  /* name bindings to supervisor CSRs */
+  enum SupervisorBindings {
+    SEPC = 0x141, /* Supervisor exception program counter */
+    SATP = 0x180, /* Supervisor address translation and protection */
+  };
+  /* name bindings to machine CSRs */
+  enum MachineBindings {
+    MHARTID = 0xF14, /* Hardware thread ID */
+  };
+
   CSRegFile() : regs(kCSRegNum) {}
 
   [[nodiscard]] RegVal get(CSRegId regnum) const { return regs.at(regnum); }
   void set(CSRegId regnum, RegVal val) { regs.at(regnum) = val; }
+  [[nodiscard]] const std::vector<RegVal> &getAll() const { return regs; }
+  void setAll(std::vector<RegVal> vals) {
+    if (vals.size() != kCSRegNum)
+      throw std::invalid_argument{"Wrong number of CSRs"};
+    regs = std::move(vals);
+  }
 
   void updateTimers(OpType type) {
     using CSRBindings = Counters::CSRBindings;
@@ -80,6 +114,7 @@ struct State final {
   RegFile regs{};
   CSRegFile csregs{};
   Memory mem{};
+  Tracer *tracer{};
   bool branchIsTaken{false};
   bool complete{false};
 };
@@ -0,0 +1,87 @@
+#ifndef __INCLUDE_COMMON_STATS_HH__
+#define __INCLUDE_COMMON_STATS_HH__
+
+#include <functional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/common.hh"
+
+namespace sim {
+
+/**
+ * @brief Registry of named statistics
+ * @details
+ * Subsystems register counters & fixed-size histograms under a group name.
+ * Values are pulled by getters only when dumped, so registered statistics
+ * cost nothing during simulation. Groups which need extra instrumentation
+ * (e.g. per block counters) are expected to turn it on only if enabled.
+ */
+class StatsRegistry final {
+public:
+  struct Stat final {
+    // "<group>.<name>"
+    std::string name{};
+    // 0 for counters, number of buckets for histograms
+    std::size_t numBuckets{};
+    std::function<void(std::span<std::uint64_t>)> read{};
+  };
+
+  /* All groups are enabled if the list is empty */
+  explicit StatsRegistry(std::vector<std::string> enabledGroups = {})
+      : enabledGroups_(std::move(enabledGroups)) {}
+
+  [[nodiscard]] bool isEnabled(std::string_view group) const;
+
+  /* Ignored if group is disabled */
+  void addCounter(std::string_view group, std::string_view name,
+                  std::function<std::uint64_t()> get);
+  /* Ignored if group is disabled, get returns numBuckets values */
+  void addHistogram(std::string_view group, std::string_view name,
+                    std::size_t numBuckets,
+                    std::function<std::vector<std::uint64_t>()> get);
+
+  [[nodiscard]] const std::vector<Stat> &getStats() const { return stats_; }
+
+private:
+  std::vector<std::string> enabledGroups_;
+  std::vector<Stat> stats_{};
+};
+
+/**
+ * @brief Writes snapshots of all registered statistics
+ * @details
+ * JSON output is an array of objects, CSV output has a header line &
+ * histogram buckets as separate "name[i]" columns. Every snapshot starts
+ * with the number of instructions executed so far.
+ */
+class StatsWriter final {
+public:
+  enum class Format { JSON, CSV };
+
+  StatsWriter(const StatsRegistry &registry, std::ostream &ost,
+              Format format);
+  StatsWriter(const StatsWriter &) = delete;
+  StatsWriter(StatsWriter &&) = delete;
+  StatsWriter &operator=(const StatsWriter &) = delete;
+  StatsWriter &operator=(StatsWriter &&) = delete;
+  ~StatsWriter() = default;
+
+  void dump(std::uint64_t numInstrs);
+  /* Close JSON array */
+  void finish();
+
+private:
+  const StatsRegistry &registry_;
+  std::ostream &ost_;
+  Format format_;
+  std::size_t numDumps_{};
+  std::vector<std::uint64_t> values_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_COMMON_STATS_HH__
@@ -1,7 +1,15 @@
 #ifndef __INCLUDE_COMMON_TIMER_HH__
 #define __INCLUDE_COMMON_TIMER_HH__
 
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 namespace timer {
 class Timer final {
@@ -28,6 +36,125 @@ public:
   }
 };
 
+#ifdef SELF_PROFILE
+inline constexpr bool kSelfProfile = true;
+#else
+inline constexpr bool kSelfProfile = false;
+#endif
+
+/* Simulator parts timed by self-profiler */
+enum class Section : std::uint8_t {
+  DECODE,
+  BBCACHE,
+  EXECUTE,
+  PAGE_TABLE,
+  kNumSections
+};
+
+inline constexpr auto kNumSections =
+    static_cast<std::size_t>(Section::kNumSections);
+
+/* Time stamp counter or nanoseconds where it is not available */
+inline std::uint64_t readTSC() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+struct SectionTimes final {
+  std::array<std::uint64_t, kNumSections> ticks{};
+  std::array<std::uint64_t, kNumSections> counts{};
+
+  SectionTimes &operator+=(const SectionTimes &rhs) {
+    for (std::size_t i = 0; i < kNumSections; ++i) {
+      ticks[i] += rhs.ticks[i];
+      counts[i] += rhs.counts[i];
+    }
+    return *this;
+  }
+};
+
+namespace detail {
+
+/* Times of finished threads */
+inline std::mutex finishedMutex{};
+inline SectionTimes finishedTimes{};
+
+/* Accumulated by every thread & merged on its exit */
+struct ThreadTimes final {
+  SectionTimes times{};
+
+  ThreadTimes() = default;
+  ThreadTimes(const ThreadTimes &) = delete;
+  ThreadTimes(ThreadTimes &&) = delete;
+  ThreadTimes &operator=(const ThreadTimes &) = delete;
+  ThreadTimes &operator=(ThreadTimes &&) = delete;
+  ~ThreadTimes() {
+    std::lock_guard lock{finishedMutex};
+    finishedTimes += times;
+  }
+};
+
+inline thread_local ThreadTimes threadTimes{};
+
+} // namespace detail
+
+#ifdef SELF_PROFILE
+/**
+ * @brief Accounts time of the scope to section
+ * @details Time is exclusive: nested timers pause the enclosing one
+ */
+class ScopedTimer final {
+public:
+  explicit ScopedTimer(Section section)
+      : section_(static_cast<std::size_t>(section)), parent_(current) {
+    auto now = readTSC();
+    if (parent_)
+      parent_->pause(now);
+    start_ = now;
+    current = this;
+  }
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer(ScopedTimer &&) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(ScopedTimer &&) = delete;
+  ~ScopedTimer() {
+    auto now = readTSC();
+    auto &times = detail::threadTimes.times;
+    times.ticks[section_] += now - start_;
+    ++times.counts[section_];
+    current = parent_;
+    if (parent_)
+      parent_->start_ = now;
+  }
+
+private:
+  void pause(std::uint64_t now) {
+    detail::threadTimes.times.ticks[section_] += now - start_;
+  }
+
+  static inline thread_local ScopedTimer *current{};
+
+  std::size_t section_;
+  ScopedTimer *parent_;
+  std::uint64_t start_{};
+};
+#else
+/* Self-profiling is disabled at compile time */
+class ScopedTimer final {
+public:
+  explicit ScopedTimer(Section /* section */) {}
+};
+#endif
+
+/* Sections of finished threads & the calling one */
+SectionTimes getSectionTimes();
+/* Breakdown of time by sections */
+void printSectionTimes(std::ostream &ost);
+
 } // namespace timer
 
 #endif // __INCLUDE_COMMON_TIMER_HH__
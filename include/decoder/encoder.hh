@@ -0,0 +1,23 @@
+#ifndef __INCLUDE_DECODER_ENCODER_HH__
+#define __INCLUDE_DECODER_ENCODER_HH__
+
+#include "common/common.hh"
+#include "common/inst.hh"
+
+namespace sim {
+
+class Encoder final {
+public:
+  /**
+   * @brief Encode an instruction function (inverse of Decoder::decode)
+   * @note Fields are truncated to their widths w/o any range checks
+   *
+   * @param inst instruction to encode
+   * @return Word instruction bytes
+   */
+  static Word encode(const Instruction &inst);
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_DECODER_ENCODER_HH__
@@ -3,6 +3,9 @@
 
 #include <filesystem>
 #include <span>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <elfio/elfio.hpp>
 
@@ -29,8 +32,18 @@ public:
   [[nodiscard]] std::size_t getSegmentMemorySize(IndexT index) const;
   [[nodiscard]] std::span<const Word> getSegment(IndexT index) const;
   [[nodiscard]] Addr getSegmentAddr(IndexT index) const;
+  [[nodiscard]] bool isSegmentWritable(IndexT index) const;
   [[nodiscard]] bool hasSegment(IndexT index) const;
 
+  struct Symbol final {
+    Addr addr{};
+    // Zero if unknown
+    Addr size{};
+    std::string name{};
+  };
+  /* Function symbols from symbol tables sorted by address */
+  [[nodiscard]] std::vector<Symbol> getFunctionSymbols() const;
+
 private:
   void check() const;
   [[nodiscard]] const ELFIO::section *
@@ -38,6 +51,22 @@ private:
   [[nodiscard]] const ELFIO::segment *getSegmentPtr(IndexT index) const;
 };
 
+/* Lookup of function symbols by address */
+class SymbolTable final {
+public:
+  /* Symbols have to be sorted by address */
+  explicit SymbolTable(std::vector<ELFLoader::Symbol> symbols)
+      : symbols_(std::move(symbols)) {}
+
+  /* Symbol containing addr or null if there is no such one */
+  [[nodiscard]] const ELFLoader::Symbol *find(Addr addr) const;
+  /* Address as "name+0xoffset", hex address if there is no symbol */
+  [[nodiscard]] std::string str(Addr addr) const;
+
+private:
+  std::vector<ELFLoader::Symbol> symbols_;
+};
+
 } // namespace sim
 
 #endif // __INCLUDE_ELFLOADER_ELFLOADER_HH__
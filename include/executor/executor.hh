@@ -10,6 +10,7 @@
 
 #include "common/inst.hh"
 #include "common/state.hh"
+#include "common/timer.hh"
 
 namespace sim {
 
@@ -39,12 +40,15 @@ public:
 
   template <InstForwardIterator It>
   void execute(It begin, It end, State &state) {
+    timer::ScopedTimer scopedTimer{timer::Section::EXECUTE};
     std::for_each(begin, end, [this, &state](const auto &inst) {
 #ifdef SPDLOG
       cosimLog("-----------------------");
       cosimLog("NUM={}", instrCount);
 #endif
       this->execute(inst, state);
+      if (state.tracer) [[unlikely]]
+        state.tracer->instrEnd(state.pc, getTraceFlags(inst));
 #ifdef SPDLOG
       cosimLog("PC=0x{:08x}", state.pc);
       spdlog::trace("Instruction:\n  [0x{:08x}]{}", state.pc, inst.str());
@@ -56,8 +60,17 @@ public:
   }
 
   [[nodiscard]] std::uint64_t getInstrCount() const { return instrCount; }
+  void setInstrCount(std::uint64_t count) { instrCount = count; }
 
 private:
+  static Byte getTraceFlags(const Instruction &inst) {
+    auto type = inst.type;
+    bool isCSR = type == OpType::CSRRW || type == OpType::CSRRS ||
+                 type == OpType::CSRRC || type == OpType::CSRRWI ||
+                 type == OpType::CSRRSI || type == OpType::CSRRCI;
+    return isCSR ? trace::CSR_ACCESS : 0;
+  }
+
   std::uint64_t instrCount{1};
 };
 
@@ -97,6 +110,8 @@ void executeCSRRC(const Instruction &inst, State &state);
 void executeCSRRWI(const Instruction &inst, State &state);
 void executeCSRRSI(const Instruction &inst, State &state);
 void executeCSRRCI(const Instruction &inst, State &state);
+void executeSFENCE_VMA(const Instruction &inst, State &state);
+void executeSRET(const Instruction &inst, State &state);
 
 /* unrealized */
 
@@ -126,27 +141,27 @@ void executeCSRRCI(const Instruction &inst, State &state);
 [[noreturn]] void executeREMU(const Instruction &inst, State &state);
 [[noreturn]] void executeSLT(const Instruction &inst, State &state);
 [[noreturn]] void executeSLTU(const Instruction &inst, State &state);
-[[noreturn]] void executeFENCE(const Instruction &inst, State &state);
+void executeFENCE(const Instruction &inst, State &state);
 [[noreturn]] void executeFLD(const Instruction &inst, State &state);
 [[noreturn]] void executeFLW(const Instruction &inst, State &state);
 [[noreturn]] void executeFSD(const Instruction &inst, State &state);
 [[noreturn]] void executeFSW(const Instruction &inst, State &state);
-[[noreturn]] void executeLB(const Instruction &inst, State &state);
-[[noreturn]] void executeLBU(const Instruction &inst, State &state);
-[[noreturn]] void executeLH(const Instruction &inst, State &state);
-[[noreturn]] void executeLHU(const Instruction &inst, State &state);
-[[noreturn]] void executeSB(const Instruction &inst, State &state);
-[[noreturn]] void executeSH(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOADD_W(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOAND_W(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOMAX_W(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOMAXU_W(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOMIN_W(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOMINU_W(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOOR_W(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOSWAP_W(const Instruction &inst, State &state);
-[[noreturn]] void executeAMOXOR_W(const Instruction &inst, State &state);
-[[noreturn]] void executeSC_W(const Instruction &inst, State &state);
+void executeLB(const Instruction &inst, State &state);
+void executeLBU(const Instruction &inst, State &state);
+void executeLH(const Instruction &inst, State &state);
+void executeLHU(const Instruction &inst, State &state);
+void executeSB(const Instruction &inst, State &state);
+void executeSH(const Instruction &inst, State &state);
+void executeAMOADD_W(const Instruction &inst, State &state);
+void executeAMOAND_W(const Instruction &inst, State &state);
+void executeAMOMAX_W(const Instruction &inst, State &state);
+void executeAMOMAXU_W(const Instruction &inst, State &state);
+void executeAMOMIN_W(const Instruction &inst, State &state);
+void executeAMOMINU_W(const Instruction &inst, State &state);
+void executeAMOOR_W(const Instruction &inst, State &state);
+void executeAMOSWAP_W(const Instruction &inst, State &state);
+void executeAMOXOR_W(const Instruction &inst, State &state);
+void executeSC_W(const Instruction &inst, State &state);
 [[noreturn]] void executeEBREAK(const Instruction &inst, State &state);
 [[noreturn]] void executeFADD_D(const Instruction &inst, State &state);
 [[noreturn]] void executeFADD_S(const Instruction &inst, State &state);
@@ -180,7 +195,7 @@ void executeCSRRCI(const Instruction &inst, State &state);
 [[noreturn]] void executeFNMADD_S(const Instruction &inst, State &state);
 [[noreturn]] void executeFNMSUB_D(const Instruction &inst, State &state);
 [[noreturn]] void executeFNMSUB_S(const Instruction &inst, State &state);
-[[noreturn]] void executeLR_W(const Instruction &inst, State &state);
+void executeLR_W(const Instruction &inst, State &state);
 
 } // namespace sim
 
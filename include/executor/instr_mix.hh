@@ -0,0 +1,87 @@
+#ifndef __INCLUDE_EXECUTOR_INSTR_MIX_HH__
+#define __INCLUDE_EXECUTOR_INSTR_MIX_HH__
+
+#include <array>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/common.hh"
+#include "common/inst.hh"
+
+namespace sim {
+
+/* Sparse static histogram of basic block: instruction type & count */
+using InstrHistogram = std::vector<std::pair<OpType, std::uint32_t>>;
+
+InstrHistogram makeHistogram(std::span<const Instruction> instrs);
+
+/**
+ * @brief Dynamic instruction mix
+ * @details
+ * Counting is done per basic block: static histogram of the block is
+ * precomputed at decode time & added on every execution. Only conditional
+ * branch outcome is accounted dynamically, branches can only end blocks.
+ */
+class InstrMix final {
+public:
+  enum Category : std::uint8_t {
+    ALU,
+    BRANCH,
+    JUMP,
+    LOAD,
+    STORE,
+    CSR,
+    SYSTEM,
+    OTHER,
+    kNumCategories
+  };
+
+  static Category getCategory(OpType type);
+  static std::string_view getCategoryName(Category category);
+  static bool isCondBranch(OpType type) {
+    return type == OpType::BEQ || type == OpType::BNE ||
+           type == OpType::BLT || type == OpType::BGE ||
+           type == OpType::BLTU || type == OpType::BGEU;
+  }
+
+  InstrMix();
+
+  void add(const InstrHistogram &histogram) {
+    for (auto [type, count] : histogram)
+      counts_[static_cast<std::size_t>(type)] += count;
+  }
+  void onBranch(bool isTaken) {
+    if (isTaken)
+      ++numTakenBranches_;
+  }
+
+  [[nodiscard]] std::uint64_t getCount(OpType type) const {
+    return counts_[static_cast<std::size_t>(type)];
+  }
+  [[nodiscard]] std::uint64_t getCount(Category category) const;
+  [[nodiscard]] std::uint64_t getNumTakenBranches() const {
+    return numTakenBranches_;
+  }
+
+  /* Categories & types in descending order of counts */
+  void print(std::ostream &ost) const;
+  void writeJSON(std::ostream &ost) const;
+
+private:
+  /* Categories w/ branches split by outcome: name & count */
+  [[nodiscard]] std::vector<std::pair<std::string_view, std::uint64_t>>
+  getCategoryCounts() const;
+  [[nodiscard]] std::vector<std::pair<OpType, std::uint64_t>>
+  getTypeCounts() const;
+
+  // Indexed by OpType
+  std::vector<std::uint64_t> counts_;
+  std::uint64_t numTakenBranches_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_EXECUTOR_INSTR_MIX_HH__
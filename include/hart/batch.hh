@@ -0,0 +1,142 @@
+#ifndef __INCLUDE_HART_BATCH_HH__
+#define __INCLUDE_HART_BATCH_HH__
+
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common.hh"
+#include "hart/hart.hh"
+#include "hart/program_image.hh"
+
+namespace sim {
+
+namespace fs = std::filesystem;
+
+struct BatchJob final {
+  fs::path executable{};
+  // Job is stopped after this number of instructions
+  std::uint64_t maxInstrs{Hart::kNoStop};
+  // UART output goes to this file, it is dropped if empty
+  fs::path console{};
+};
+
+/*
+  Jobs file is text, one job per line, '#' starts a comment:
+    <executable> [max-instrs=<N>] [console=<file>]
+*/
+std::vector<BatchJob> loadBatchJobs(const fs::path &file);
+/* Job from line of jobs file, nullopt for empty line */
+std::optional<BatchJob> parseBatchJob(const std::string &line);
+
+struct BatchResult final {
+  enum Status {
+    COMPLETED, /* Program has finished w/ ECALL or test finisher */
+    LIMIT,     /* Instruction limit reached */
+    FAILED,    /* Simulation error, see error */
+    STOPPED,   /* Stopped by runner of job before completion */
+  };
+
+  Status status{FAILED};
+  int exitCode{};
+  std::uint64_t numInstrs{};
+  std::uint64_t timeMcs{};
+  // Blocks decoded by the job itself & taken from the shared cache
+  std::uint64_t numDecodedBlocks{};
+  std::uint64_t numSharedBlocks{};
+  std::string error{};
+
+  [[nodiscard]] bool isPassed() const {
+    return status == COMPLETED && exitCode == 0;
+  }
+  [[nodiscard]] static const char *getStatusName(Status status);
+};
+
+/* Lets caller of BatchRunner::runJob watch & stop job from outside */
+struct JobHooks final {
+  // Called w/ hart of job before its run & w/ nullptr before its destruction,
+  // hart may be stopped from any thread in between
+  std::function<void(Hart *)> setHart{};
+  // Checked every JobHooks::kCheckInstrs instructions, true stops the job
+  std::function<bool()> isCancelled{};
+
+  static constexpr std::uint64_t kCheckInstrs = 1 << 20;
+};
+
+/**
+ * @brief Many independent simulations on a pool of threads in one process
+ * @details
+ * Every job is run by its own hart w/ devices attached. Executables are
+ * told apart by digests of contents: jobs of identical files share
+ * ProgramImage, i.e. copy-on-write pages & decoded blocks of read-only
+ * segments. Images are kept for later runs, up to kMaxImages least recently
+ * used of them.
+ */
+class BatchRunner final {
+public:
+  static constexpr std::size_t kMaxImages = 64;
+
+  explicit BatchRunner(HartConfig config) : config_(config) {}
+
+  /**
+   * @brief Run jobs till completion or their instruction limits
+   * @return results in order of jobs, failure of a job does not stop others
+   */
+  std::vector<BatchResult> run(const std::vector<BatchJob> &jobs,
+                               std::size_t numThreads);
+  /**
+   * @brief Run single job, thread-safe
+   *
+   * @param[in] console UART output, console file of job is ignored
+   */
+  BatchResult runJob(const BatchJob &job, std::ostream &console,
+                     const JobHooks &hooks = {});
+
+  /* Number of distinct executables kept loaded */
+  [[nodiscard]] std::size_t getNumImages() const;
+
+  /* Print every job & totals */
+  static void print(std::ostream &ost, const std::vector<BatchJob> &jobs,
+                    const std::vector<BatchResult> &results);
+
+private:
+  /* Size & two independent hashes of executable file contents */
+  struct ImageDigest final {
+    std::size_t size{};
+    DWord hash{};
+    std::size_t strHash{};
+
+    explicit ImageDigest(std::string_view contents);
+    bool operator==(const ImageDigest &) const = default;
+  };
+  struct ImageDigestHash final {
+    std::size_t operator()(const ImageDigest &digest) const noexcept {
+      return digest.strHash;
+    }
+  };
+
+  BatchResult runJob(const BatchJob &job);
+  /* Image of executable, loaded on the first use */
+  std::shared_ptr<const ProgramImage> getImage(const fs::path &executable);
+
+  HartConfig config_;
+  mutable std::mutex imagesMutex_{};
+  // Most recently used images first
+  using ImageList =
+      std::list<std::pair<ImageDigest, std::shared_ptr<const ProgramImage>>>;
+  ImageList images_{};
+  std::unordered_map<ImageDigest, ImageList::iterator, ImageDigestHash>
+      imagesMap_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_BATCH_HH__
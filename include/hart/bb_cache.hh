@@ -0,0 +1,105 @@
+#ifndef __INCLUDE_HART_BB_CACHE_HH__
+#define __INCLUDE_HART_BB_CACHE_HH__
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "common/common.hh"
+#include "common/inst.hh"
+#include "executor/instr_mix.hh"
+#include "hart/block_stats.hh"
+
+namespace sim {
+
+struct CachedBlock final {
+  BasicBlock bb{};
+  // Instrumentation counters, null if block statistics are disabled
+  BlockCounters *counters{};
+  // Empty if instruction mix is not counted
+  InstrHistogram histogram{};
+};
+
+class IBBCache {
+public:
+  virtual ~IBBCache() = default;
+  virtual const CachedBlock &
+  lookupUpdate(Addr key, std::function<CachedBlock(Addr)> slowGetData) = 0;
+  virtual void flush() = 0;
+};
+
+class InfCache final : public IBBCache {
+  std::unordered_map<Addr, CachedBlock> hash_{};
+
+public:
+  const CachedBlock &
+  lookupUpdate(Addr key,
+               std::function<CachedBlock(Addr)> slowGetData) override {
+    if (auto hit = hash_.find(key); hit != hash_.end())
+      return hit->second;
+
+    auto bb = slowGetData(key);
+    return hash_[key] = std::move(bb);
+  }
+
+  void flush() override { hash_.clear(); }
+};
+
+class NoCache final : public IBBCache {
+  // Per cache, so harts can run in different threads
+  CachedBlock cur_{};
+
+public:
+  const CachedBlock &
+  lookupUpdate(Addr key,
+               std::function<CachedBlock(Addr)> slowGetData) override {
+    cur_ = slowGetData(key);
+    return cur_;
+  }
+
+  void flush() override {}
+};
+
+class LRUCache final : public IBBCache {
+  std::size_t size_;
+  std::list<std::pair<Addr, CachedBlock>> cache_{};
+
+  using ListIt = typename std::list<std::pair<Addr, CachedBlock>>::iterator;
+  std::unordered_map<Addr, ListIt> hash_{};
+
+public:
+  explicit LRUCache(std::size_t size) : size_(size) {}
+
+  [[nodiscard]] bool isFull() const { return (cache_.size() == size_); }
+
+  const CachedBlock &
+  lookupUpdate(Addr key,
+               std::function<CachedBlock(Addr)> slowGetData) override {
+    auto hit = hash_.find(key);
+    if (hit == hash_.end()) {
+      if (isFull()) {
+        hash_.erase(cache_.back().first);
+        cache_.pop_back();
+      }
+      cache_.emplace_front(key, slowGetData(key));
+      hash_.emplace(key, cache_.begin());
+    } else if (auto eltit = hit->second; eltit != cache_.begin())
+      cache_.splice(cache_.begin(), cache_, eltit, std::next(eltit));
+
+    return cache_.front().second;
+  }
+
+  void flush() override {
+    hash_.clear();
+    cache_.clear();
+  }
+};
+
+/* Unbounded cache if size is negative, no caching if it is zero */
+std::unique_ptr<IBBCache> makeBBCache(std::int64_t size);
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_BB_CACHE_HH__
@@ -0,0 +1,40 @@
+#ifndef __INCLUDE_HART_BBV_HH__
+#define __INCLUDE_HART_BBV_HH__
+
+#include <ostream>
+#include <vector>
+
+#include "common/common.hh"
+#include "hart/hart.hh"
+
+namespace sim {
+
+/**
+ * @brief Basic block vectors for SimPoint
+ * @details
+ * Hart is run interval by interval w/ block statistics enabled. At the end
+ * of each interval the per block instruction counters are compared w/ the
+ * values at its start, which gives the sparse vector of the interval. It is
+ * written as a line of SimPoint .bb format:
+ *   T:<block id>:<instructions> :<block id>:<instructions> ...
+ * Block stopped at interval boundary is continued as a separate block.
+ */
+class BBVRecorder final {
+public:
+  BBVRecorder(Hart &hart, std::uint64_t interval);
+
+  /* Run till completion writing vector of every interval */
+  void record(std::ostream &ost);
+
+private:
+  void writeInterval(std::ostream &ost);
+
+  Hart &hart_;
+  std::uint64_t interval_{};
+  // Instruction counters at the start of interval indexed by block id
+  std::vector<std::uint64_t> lastInstrs_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_BBV_HH__
@@ -0,0 +1,78 @@
+#ifndef __INCLUDE_HART_BISECT_HH__
+#define __INCLUDE_HART_BISECT_HH__
+
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "common/common.hh"
+#include "hart/hart.hh"
+
+namespace sim {
+
+namespace fs = std::filesystem;
+
+/* Hash of the state before instruction number instrNum */
+struct StateHash final {
+  std::uint64_t instrNum{};
+  DWord hash{};
+
+  bool operator==(const StateHash &) const = default;
+};
+
+/*
+  Hash stream file is text:
+    INTERVAL=<number of instructions between hashes>
+    NUM=<instruction number> HASH=<hex hash>
+    ...
+*/
+struct HashStream final {
+  std::uint64_t interval{};
+  std::vector<StateHash> hashes{};
+};
+
+HashStream loadHashStream(const fs::path &file);
+
+/**
+ * @brief Co-simulation against a reference stream of state hashes
+ * @details
+ * Hart runs w/o tracing & hashes its state every interval instructions.
+ * The last matched point is kept as an in-memory snapshot, which is updated
+ * incrementally. On mismatch hart is rolled back to the snapshot & the only
+ * diverged interval is run again writing binary trace.
+ */
+class HashCosim final {
+public:
+  /* Diverged interval: [from, to) instructions */
+  struct Mismatch {
+    std::size_t index{};
+    std::uint64_t from{};
+    std::uint64_t to{};
+  };
+
+  HashCosim(Hart &hart, std::uint64_t interval);
+
+  /* Run till completion writing hash stream */
+  void record(std::ostream &ost);
+  /**
+   * @brief Run till completion or the first mismatch w/ reference
+   *
+   * @param[in] reference hash stream of the reference run
+   * @param[in] traceFile binary trace of the diverged interval
+   * @return diverged interval, nullopt if all hashes have matched
+   */
+  std::optional<Mismatch> check(const HashStream &reference,
+                                const fs::path &traceFile);
+
+private:
+  /* @return true if program has completed */
+  bool runInterval(StateHash &hash);
+
+  Hart &hart_;
+  std::uint64_t interval_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_BISECT_HH__
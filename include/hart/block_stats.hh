@@ -0,0 +1,72 @@
+#ifndef __INCLUDE_HART_BLOCK_STATS_HH__
+#define __INCLUDE_HART_BLOCK_STATS_HH__
+
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common.hh"
+#include "common/inst.hh"
+#include "elfloader/elfloader.hh"
+
+namespace sim {
+
+/* Execution counters of the basic block at some entry address */
+struct BlockCounters final {
+  std::uint64_t numExecs{};
+  // Dynamic instruction count, blocks may be executed partially
+  std::uint64_t numInstrs{};
+  // Number of times block was decoded, i.e. basic block cache misses
+  std::uint64_t numMisses{};
+
+  void onExec(std::size_t executed) {
+    ++numExecs;
+    numInstrs += executed;
+  }
+};
+
+/**
+ * @brief Per basic block execution statistics
+ * @details
+ * Counters outlive cached blocks, so evicted & re-decoded blocks keep
+ * accumulating into the same counters. Blocks are told apart by entry
+ * address only.
+ */
+class BlockStats final {
+public:
+  struct Block final {
+    // Blocks are numbered from 1 in order of the first decoding
+    std::size_t id{};
+    Addr entry{};
+    // Instructions of the last decoded version
+    BasicBlock bb{};
+    BlockCounters counters{};
+  };
+
+  /**
+   * @brief Account decoding of block at entry
+   *
+   * @return counters of the block, valid till destruction
+   */
+  BlockCounters &onDecode(Addr entry, const BasicBlock &bb);
+
+  [[nodiscard]] const std::unordered_map<Addr, Block> &getBlocks() const {
+    return blocks_;
+  }
+
+  /* Blocks ordered by dynamic instruction count, the hottest go first */
+  [[nodiscard]] std::vector<const Block *> getHottest() const;
+
+  /* Print numBlocks hottest blocks w/ disassembly & cache statistics */
+  void print(std::ostream &ost, std::size_t numBlocks,
+             const SymbolTable &symbols) const;
+  /* Write all blocks in JSON */
+  void writeJSON(std::ostream &ost, const SymbolTable &symbols) const;
+
+private:
+  std::unordered_map<Addr, Block> blocks_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_BLOCK_STATS_HH__
@@ -2,46 +2,251 @@
 #define __INCLUDE_HART_HART_HH__
 
 #include <array>
+#include <atomic>
 #include <filesystem>
+#include <limits>
 #include <memory>
+#include <ostream>
 #include <unordered_map>
 
 #include "common/common.hh"
+#include "common/host_perf.hh"
 #include "common/inst.hh"
 #include "common/state.hh"
+#include "common/stats.hh"
 #include "decoder/decoder.hh"
 #include "executor/executor.hh"
+#include "executor/instr_mix.hh"
+#include "hart/bb_cache.hh"
+#include "hart/block_stats.hh"
+#include "hart/hart_task.hh"
+#include "hart/lockstep.hh"
+#include "hart/profiler.hh"
+#include "hart/program_image.hh"
 #include "memory/memory.hh"
 
 namespace sim {
 
 namespace fs = std::filesystem;
 
-class IBBCache {
-public:
-  virtual ~IBBCache() = default;
-  virtual const BasicBlock &
-  lookupUpdate(Addr key, std::function<BasicBlock(Addr)> slowGetData) = 0;
+/* Settings applied to every hart */
+struct HartConfig final {
+  std::int64_t bbCacheSize{-1};
+  std::size_t tlbSize{kTLBSize};
+  std::size_t tlbWays{kTLBWays};
 };
 
 class Hart final {
+public:
+  /* Decoder activity, i.e. basic block cache misses */
+  struct DecodeStats {
+    // Block sizes 1..kNumSizeBuckets-1, the last bucket holds larger ones
+    static constexpr std::size_t kNumSizeBuckets = 16;
+
+    std::uint64_t numBlocks{};
+    std::uint64_t numInstrs{};
+    std::array<std::uint64_t, kNumSizeBuckets> blockSizes{};
+    // Misses served by blocks decoded by other harts of ProgramImage
+    std::uint64_t numSharedBlocks{};
+  };
+
 private:
   State state_{};
   Executor exec_{};
   Decoder decoder_{};
   std::unique_ptr<IBBCache> bbc_{};
+  // Null if hart has loaded executable by itself
+  std::shared_ptr<const ProgramImage> image_{};
+  // Blocks are cached by virtual address: track translation changes
+  std::uint64_t translationEpoch_{};
+  UART *console_{};
+  int exitCode_{};
+  std::unique_ptr<Tracer> tracer_{};
+  std::unique_ptr<Lockstep> lockstep_{};
+  std::unique_ptr<Profiler> profiler_{};
+  std::unique_ptr<BlockStats> blockStats_{};
+  std::unique_ptr<InstrMix> instrMix_{};
+  DecodeStats decodeStats_{};
+  HostPerf *hostPerf_{};
+  std::atomic<bool> isStopRequested_{false};
 
   Memory &getMem() { return state_.mem; };
   Addr &getPC() { return state_.pc; };
 
-  BasicBlock createBB(Addr entry);
+  CachedBlock createBB(Addr entry);
+  BasicBlock decodeBB(Addr entry);
+  /* Run at most numBlocks basic blocks, see run */
+  bool runBlocks(std::uint64_t stopAt, std::uint64_t numBlocks);
+  /* Instrumentation after execution of numExecuted instructions of block */
+  void onBlockExecuted(const CachedBlock &cached, Addr entry,
+                       std::size_t numExecuted);
 
 public:
+  /* Architectural state & memory contents to return the hart to */
+  struct Snapshot {
+    Addr pc{};
+    RegFile regs{};
+    CSRegFile csregs{};
+    std::uint64_t instrCount{};
+    PhysMemory::Snapshot mem{};
+  };
+
+  static constexpr std::uint64_t kNoStop =
+      std::numeric_limits<std::uint64_t>::max();
+
   Hart(const fs::path &executable, std::int64_t bbCacheSize);
-  void run();
+  /**
+   * @brief Hart sharing physical memory w/ other harts
+   * @details Executable is loaded into memory by hart 0 only, the others
+   * just start at its entry point
+   *
+   * @param[in] hartId value of mhartid CSR
+   */
+  Hart(const fs::path &executable, std::int64_t bbCacheSize,
+       std::shared_ptr<PhysMemory> physMem, Word hartId);
+  /**
+   * @brief Hart running already loaded executable
+   * @details Memory is mapped from the image copy-on-write & basic blocks
+   * decoded by other harts of the image are reused
+   */
+  Hart(std::shared_ptr<const ProgramImage> image, std::int64_t bbCacheSize);
+  Hart(const Hart &) = delete;
+  Hart(Hart &&) = delete;
+  Hart &operator=(const Hart &) = delete;
+  Hart &operator=(Hart &&) = delete;
+  ~Hart() = default;
+  /**
+   * @brief Run program till completion or till instruction number stopAt
+   *
+   * @return true if program has completed
+   */
+  bool run(std::uint64_t stopAt = kNoStop);
+  /**
+   * @brief Run program as coroutine suspending every sliceBlocks basic blocks
+   * @details Task finishes when program completes or stop is requested
+   * @note Hart must outlive the task
+   */
+  [[nodiscard]] HartTask runTask(std::uint64_t sliceBlocks);
+  /**
+   * @brief Make run return false at the next basic block boundary
+   * @note Safe to call from any thread, e.g. to stop harts sharing memory
+   * when one of them has failed
+   */
+  void requestStop() {
+    isStopRequested_.store(true, std::memory_order_relaxed);
+  }
+  void configureTLB(std::size_t numEntries, std::size_t numWays) {
+    getMem().configureTLB(numEntries, numWays);
+  }
+
+  /**
+   * @brief Map UART console, CLINT & test finisher at standard addresses
+   *
+   * @param[in] console host stream for UART output
+   */
+  void attachDevices(std::ostream &console);
+  /**
+   * @brief Start writing binary trace from the next instruction
+   *
+   * @param[in] file trace file, overwritten if exists
+   */
+  void startTrace(const fs::path &file);
+  /* Stop tracing & write out trace file */
+  void stopTrace();
+  [[nodiscard]] bool isTracing() const { return tracer_ != nullptr; }
+
+  /**
+   * @brief Run golden interpreter on a shadow state alongside & compare
+   * states at every basic block boundary
+   * @details Stops with Lockstep::DivergenceError on the first mismatch
+   * @note Devices are not supported: golden model would repeat their side
+   * effects
+   */
+  void enableLockstep();
+
+  /**
+   * @brief Start sampling pc & shadow call stack every period instructions
+   *
+   * @param[in] symbols function symbols of the executable for stacks
+   */
+  void enableProfiler(std::vector<ELFLoader::Symbol> symbols,
+                      std::uint64_t period);
+  /* Write collapsed stacks sampled so far */
+  void writeProfile(std::ostream &ost) const;
+
+  /* Start counting executions of every basic block */
+  void enableBlockStats();
+  /* Null if block statistics are disabled */
+  [[nodiscard]] const BlockStats *getBlockStats() const {
+    return blockStats_.get();
+  }
+
+  /* Start counting dynamic instruction mix */
+  void enableInstrMix();
+  /* Null if instruction mix is not counted */
+  [[nodiscard]] const InstrMix *getInstrMix() const { return instrMix_.get(); }
+
+  /**
+   * @brief Register statistics of executor, instruction mix, TLB, memory,
+   * basic block cache & decoder
+   * @details Block statistics & instruction mix are enabled if their groups
+   * are. TLB group is only registered if TLB statistics are collected.
+   */
+  void registerStats(StatsRegistry &registry);
+  [[nodiscard]] const DecodeStats &getDecodeStats() const {
+    return decodeStats_;
+  }
+
+  /**
+   * @brief Measure decoding & count executed blocks w/ host counters
+   * @note Run phase is measured by the caller
+   */
+  void setHostPerf(HostPerf *hostPerf) { hostPerf_ = hostPerf; }
+
+  /* Status passed to test finisher (0 if simulation ended w/ ECALL) */
+  [[nodiscard]] int getExitCode() const { return exitCode_; }
+
+  /**
+   * @brief Take a snapshot & start tracking dirty pages from this point
+   */
+  [[nodiscard]] Snapshot takeSnapshot();
+  /**
+   * @brief Fast reset: restore registers & only the pages dirtied since the
+   * snapshot was taken (or restored last time)
+   */
+  void restoreSnapshot(const Snapshot &snapshot);
+  /**
+   * @brief Move snapshot to the current state copying only the pages
+   * dirtied since it was taken (or updated/restored last time)
+   */
+  void updateSnapshot(Snapshot &snapshot);
+
+  /**
+   * @brief Hash pc, registers & contents of the pages stored to since the
+   * previous call
+   * @note Dirty tracking for hashes is independent from snapshot one
+   */
+  [[nodiscard]] DWord hashState();
+
+  /**
+   * @brief Save architectural state, all the memory & statistics to file
+   * @details
+   * File is page-aligned: header, CSRs & page index go first, followed by
+   * raw contents of the physical pages.
+   */
+  void saveCheckpoint(const fs::path &file);
+  /**
+   * @brief Replace current state w/ checkpoint
+   * @details
+   * Checkpoint file is mapped copy-on-write, so only the pages touched
+   * after restore are read from disk & copied.
+   */
+  void restoreCheckpoint(const fs::path &file);
+
   [[nodiscard]] std::uint64_t getInstrCount() const {
     return exec_.getInstrCount();
   }
+  [[nodiscard]] const Memory &getMemory() const { return state_.mem; }
 };
 
 } // namespace sim
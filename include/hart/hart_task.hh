@@ -0,0 +1,69 @@
+#ifndef __INCLUDE_HART_HART_TASK_HH__
+#define __INCLUDE_HART_HART_TASK_HH__
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace sim {
+
+/**
+ * @brief Run of a hart as coroutine, resumed for one time slice at a time
+ * @details
+ * Task is created suspended & suspends at basic block boundaries only, so it
+ * can be resumed by any host thread. Exception thrown by the hart finishes
+ * the task & is rethrown by resume.
+ */
+class HartTask final {
+public:
+  struct promise_type {
+    std::exception_ptr error{};
+
+    HartTask get_return_object() {
+      return HartTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+  };
+
+  HartTask(HartTask &&other) noexcept
+      : handle_{std::exchange(other.handle_, {})} {}
+  HartTask &operator=(HartTask &&other) noexcept {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+  HartTask(const HartTask &) = delete;
+  HartTask &operator=(const HartTask &) = delete;
+  ~HartTask() {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  /**
+   * @brief Run till the end of time slice or till completion
+   *
+   * @return true if task has finished
+   */
+  bool resume() {
+    if (!handle_.done())
+      handle_.resume();
+    if (auto error = std::exchange(handle_.promise().error, {}))
+      std::rethrow_exception(error);
+    return handle_.done();
+  }
+  [[nodiscard]] bool isDone() const { return handle_.done(); }
+
+private:
+  friend promise_type;
+
+  explicit HartTask(std::coroutine_handle<promise_type> handle)
+      : handle_{handle} {}
+
+  std::coroutine_handle<promise_type> handle_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_HART_TASK_HH__
@@ -0,0 +1,66 @@
+#ifndef __INCLUDE_HART_LOCKSTEP_HH__
+#define __INCLUDE_HART_LOCKSTEP_HH__
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common.hh"
+#include "common/state.hh"
+#include "executor/executor.hh"
+
+namespace sim {
+
+/**
+ * @brief Golden interpreter running in lockstep w/ hart
+ * @details
+ * Golden model is deliberately simple: it fetches, decodes & executes
+ * instructions one by one on a shadow state w/o basic block cache. Hart
+ * calls check() at every basic block boundary: golden model catches up &
+ * registers, pc & the stores made since the previous check are compared.
+ */
+class Lockstep final {
+public:
+  class DivergenceError : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  /**
+   * @brief Copy hart state & memory contents to the shadow state
+   *
+   * @param[in] state hart state, its stores are logged till destruction
+   * @param[in] instrCount number of the next instruction
+   */
+  Lockstep(State &state, std::uint64_t instrCount);
+  Lockstep(const Lockstep &) = delete;
+  Lockstep(Lockstep &&) = delete;
+  Lockstep &operator=(const Lockstep &) = delete;
+  Lockstep &operator=(Lockstep &&) = delete;
+  ~Lockstep();
+
+  /**
+   * @brief Run golden model up to instruction number instrCount & compare
+   *
+   * @throw DivergenceError w/ both states dumped on the first mismatch
+   */
+  void check(std::uint64_t instrCount);
+
+private:
+  using StoreLog = std::vector<std::pair<Addr, Word>>;
+
+  void step();
+  [[nodiscard]] std::string dump(const std::string &reason) const;
+
+  State &state_;
+  State shadow_{};
+  Executor exec_{};
+  std::uint64_t instrCount_{};
+  StoreLog stores_{};
+  StoreLog shadowStores_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_LOCKSTEP_HH__
@@ -0,0 +1,65 @@
+#ifndef __INCLUDE_HART_MULTI_HART_HH__
+#define __INCLUDE_HART_MULTI_HART_HH__
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "common/common.hh"
+#include "hart/hart.hh"
+#include "hart/scheduler.hh"
+#include "memory/memory.hh"
+
+namespace sim {
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Harts sharing physical memory, each one run by its own host thread
+ * @details
+ * Every hart has its own registers, CSRs, TLBs & basic block cache, harts
+ * are told apart by mhartid (0..N-1). Executable is loaded once & all the
+ * harts start at its entry point. Harts synchronize through the shared
+ * memory only, there are no devices. Harts are multiplexed over host threads
+ * by HartScheduler, so there may be many more harts than threads.
+ */
+class MultiHart final {
+public:
+  MultiHart(const fs::path &executable, std::size_t numHarts,
+            const HartConfig &config);
+
+  /* Run every hart till completion on its own thread */
+  void run() { run(harts_.size()); }
+  /**
+   * @brief Run every hart till completion
+   * @details Failure of a hart stops the rest & is rethrown
+   *
+   * @param[in] numThreads number of host threads running harts
+   * @param[in] sliceBlocks number of basic blocks hart runs before yielding
+   * the thread to another hart
+   */
+  HartScheduler::Stats
+  run(std::size_t numThreads,
+      std::uint64_t sliceBlocks = HartScheduler::kDefaultSliceBlocks);
+  /* Harts w/ higher priority are run more often, all are equal by default */
+  void setPriority(std::size_t hartId, int priority) {
+    priorities_.at(hartId) = priority;
+  }
+
+  [[nodiscard]] std::size_t getNumHarts() const { return harts_.size(); }
+  [[nodiscard]] Hart &getHart(std::size_t hartId) {
+    return *harts_.at(hartId);
+  }
+  /* Number of instructions executed by all the harts */
+  [[nodiscard]] std::uint64_t getNumInstrs() const;
+  [[nodiscard]] const PhysMemory &getPhysMemory() const { return *physMem_; }
+
+private:
+  std::shared_ptr<PhysMemory> physMem_{std::make_shared<PhysMemory>()};
+  std::vector<std::unique_ptr<Hart>> harts_{};
+  std::vector<int> priorities_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_MULTI_HART_HH__
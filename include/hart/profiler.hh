@@ -0,0 +1,90 @@
+#ifndef __INCLUDE_HART_PROFILER_HH__
+#define __INCLUDE_HART_PROFILER_HH__
+
+#include <map>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common/common.hh"
+#include "common/inst.hh"
+#include "elfloader/elfloader.hh"
+
+namespace sim {
+
+/**
+ * @brief Sampling profiler of guest code
+ * @details
+ * Hart reports every executed basic block. Each period instructions the
+ * block is sampled together w/ the shadow call stack, which is maintained
+ * on JAL/JALR following the RISC-V calling convention hints: a jump linking
+ * to ra/t0 is a call, a jump through ra/t0 w/o link is a return. Samples are
+ * written in collapsed stack format accepted by flamegraph tools.
+ */
+class Profiler final {
+public:
+  // Prime, so sampling does not get in step w/ loops
+  static constexpr std::uint64_t kDefaultPeriod = 1009;
+
+  /**
+   * @param[in] symbols function symbols sorted by address
+   * @param[in] period number of instructions between samples
+   * @param[in] pc address of the next instruction, the root of call stack
+   * @param[in] instrCount number of the next instruction
+   */
+  Profiler(std::vector<ELFLoader::Symbol> symbols, std::uint64_t period,
+           Addr pc, std::uint64_t instrCount);
+
+  /**
+   * @brief Account executed part of basic block
+   *
+   * @param[in] entry address of the first executed instruction
+   * @param[in] executed executed instructions
+   * @param[in] pc address of the next instruction
+   * @param[in] instrCount number of the next instruction
+   */
+  void onBlock(Addr entry, std::span<const Instruction> executed, Addr pc,
+               std::uint64_t instrCount) {
+    if (executed.empty())
+      return;
+
+    auto last = entry + static_cast<Addr>((executed.size() - 1) * kXLENInBytes);
+    if (instrCount >= nextSample_) [[unlikely]] {
+      sample(last);
+      nextSample_ = instrCount + period_;
+    }
+
+    const auto &inst = executed.back();
+    if (inst.type == OpType::JAL || inst.type == OpType::JALR)
+      onJump(inst, last, pc);
+  }
+
+  /* Write samples as collapsed stacks: "root;...;leaf count" lines */
+  void write(std::ostream &ost) const;
+
+  [[nodiscard]] std::uint64_t getNumSamples() const { return numSamples_; }
+
+private:
+  struct Frame final {
+    Addr callee{};
+    Addr ret{};
+  };
+
+  void sample(Addr addr);
+  void onJump(const Instruction &inst, Addr addr, Addr target);
+  /* Start of the function containing addr or addr itself if unknown */
+  [[nodiscard]] Addr getFunction(Addr addr) const;
+
+  SymbolTable symbols_;
+  std::uint64_t period_;
+  std::uint64_t nextSample_;
+  std::vector<Frame> callStack_{};
+  // Function start addresses from root to leaf
+  std::map<std::vector<Addr>, std::uint64_t> samples_{};
+  std::uint64_t numSamples_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_PROFILER_HH__
@@ -0,0 +1,72 @@
+#ifndef __INCLUDE_HART_PROGRAM_IMAGE_HH__
+#define __INCLUDE_HART_PROGRAM_IMAGE_HH__
+
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/common.hh"
+#include "common/inst.hh"
+#include "elfloader/elfloader.hh"
+#include "memory/memory.hh"
+
+namespace sim {
+
+/* Store loadable segments of executable into memory, bss is zeroed */
+void loadSegments(const ELFLoader &loader, Memory &mem);
+
+/**
+ * @brief Loaded executable shared by harts running it, e.g. batch jobs
+ * @details
+ * Executable is parsed & loaded once: its pages are kept in anonymous memory
+ * file mapped copy-on-write by every hart, so the pages nobody stores to are
+ * shared. Basic blocks of read-only segments are decoded once as well: the
+ * first hart decoding a block publishes it for the others.
+ * @note Programs must not modify their read-only segments
+ */
+class ProgramImage final {
+public:
+  explicit ProgramImage(const ELFLoader &loader);
+  ProgramImage(const ProgramImage &) = delete;
+  ProgramImage(ProgramImage &&) = delete;
+  ProgramImage &operator=(const ProgramImage &) = delete;
+  ProgramImage &operator=(ProgramImage &&) = delete;
+  ~ProgramImage();
+
+  [[nodiscard]] Addr getEntryPoint() const { return entryPoint_; }
+  [[nodiscard]] std::size_t getNumPages() const { return ppns_.size(); }
+
+  /* Replace memory contents w/ copy-on-write mapping of the image */
+  void mapInto(Memory &mem) const;
+
+  /**
+   * @brief Find shared block by entry address, thread-safe
+   * @return block or nullptr, blocks are never removed
+   */
+  [[nodiscard]] const BasicBlock *findBlock(Addr entry) const;
+  /**
+   * @brief Share block decoded at entry, thread-safe
+   * @details Blocks reaching out of read-only segments are ignored
+   */
+  void addBlock(Addr entry, const BasicBlock &bb) const;
+
+private:
+  [[nodiscard]] bool isReadOnly(Addr begin, Addr end) const;
+
+  Addr entryPoint_{};
+  // Memory file holding pages in order of their numbers in ppns_
+  int fd_{-1};
+  std::vector<std::uint32_t> ppns_{};
+  // Address ranges [begin, end) of read-only segments
+  std::vector<std::pair<Addr, Addr>> readOnly_{};
+
+  // Decoded blocks only cache contents of the image
+  mutable std::shared_mutex blocksMutex_{};
+  mutable std::unordered_map<Addr, BasicBlock> blocks_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_PROGRAM_IMAGE_HH__
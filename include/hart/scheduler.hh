@@ -0,0 +1,87 @@
+#ifndef __INCLUDE_HART_SCHEDULER_HH__
+#define __INCLUDE_HART_SCHEDULER_HH__
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "hart/hart.hh"
+#include "hart/hart_task.hh"
+
+namespace sim {
+
+/**
+ * @brief Cooperative scheduler multiplexing harts over a few host threads
+ * @details
+ * Every hart runs as HartTask resumed for a slice of basic blocks at a time.
+ * Each host thread has its own run queue ordered by virtual deadlines: task
+ * is queued kAgingSlices slices ahead per priority level, so tasks of higher
+ * priority run more often, but lower ones still get their turns (e.g. hart
+ * holding a lock others spin on). Tasks of equal priority take turns
+ * (round-robin). Thread w/ empty queue steals tasks from the others & waits
+ * for new ones when there is nothing to steal.
+ */
+class HartScheduler final {
+public:
+  static constexpr std::uint64_t kDefaultSliceBlocks = 1024;
+  // Slices task runs per slice of task w/ one level lower priority
+  static constexpr std::int64_t kAgingSlices = 4;
+
+  struct Stats {
+    std::uint64_t numSlices{};
+    std::uint64_t numSteals{};
+  };
+
+  HartScheduler(std::size_t numThreads, std::uint64_t sliceBlocks);
+
+  /* Queue hart to be run, harts are spread over threads evenly */
+  void add(Hart &hart, int priority = 0);
+  /**
+   * @brief Run all the queued harts till completion
+   * @details Failure of a hart stops the rest & is rethrown
+   */
+  Stats run();
+
+private:
+  struct Entry {
+    HartTask task;
+    int priority{};
+    // Order of queuing & position in queue w/ priority taken into account
+    std::uint64_t seq{};
+    std::int64_t deadline{};
+  };
+
+  struct Queue {
+    std::mutex mutex{};
+    std::vector<Entry> heap{};
+    std::uint64_t nextSeq{};
+  };
+
+  void push(Queue &queue, Entry entry);
+  std::optional<Entry> pop(Queue &queue);
+  /* Take task from own queue or steal one from another thread */
+  std::optional<Entry> pick(std::size_t threadIdx);
+  void work(std::size_t threadIdx);
+  void fail(std::exception_ptr error);
+
+  std::uint64_t sliceBlocks_{};
+  std::vector<Hart *> harts_{};
+  // Queues hold mutexes, so they are not movable
+  std::vector<std::unique_ptr<Queue>> queues_{};
+  std::atomic<std::size_t> numLive_{};
+  // Bumped when task is queued or the last one is done, idle threads wait
+  // for it to change
+  std::atomic<std::uint64_t> epoch_{};
+  std::atomic<std::uint64_t> numSlices_{};
+  std::atomic<std::uint64_t> numSteals_{};
+  std::mutex errorMutex_{};
+  std::exception_ptr error_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_SCHEDULER_HH__
@@ -0,0 +1,97 @@
+#ifndef __INCLUDE_HART_SERVER_HH__
+#define __INCLUDE_HART_SERVER_HH__
+
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "common/common.hh"
+#include "hart/batch.hh"
+#include "hart/hart.hh"
+
+namespace sim {
+
+namespace fs = std::filesystem;
+
+/*
+  Protocol over UNIX stream socket, client may send many requests one by one:
+    request:  line of jobs file w/o console, executable path is absolute
+    response: <status> <exit code> <instructions> <time us> <decoded blocks>
+              <shared blocks> <console size> <error size> line followed by
+              console output & error message of the given sizes
+*/
+
+/**
+ * @brief Simulator daemon running jobs submitted through UNIX socket
+ * @details
+ * Worker threads wait for connections & run jobs of their clients w/
+ * BatchRunner, so loaded executables & decoded blocks stay warm between
+ * requests. Job is stopped if its client hangs up or the server is stopped.
+ */
+class JobServer final {
+public:
+  /**
+   * @brief Listen on socket, stale socket file is replaced
+   * @throws std::runtime_error if another server listens on socket already
+   */
+  JobServer(fs::path socket, HartConfig config, std::size_t numThreads);
+  JobServer(const JobServer &) = delete;
+  JobServer(JobServer &&) = delete;
+  JobServer &operator=(const JobServer &) = delete;
+  JobServer &operator=(JobServer &&) = delete;
+  ~JobServer();
+
+  /**
+   * @brief Serve clients till stop is called
+   * @throws std::system_error if accepting connections fails
+   */
+  void run();
+  /**
+   * @brief Stop running jobs & make run return
+   * @details Clients of stopped jobs get their results w/ STOPPED status
+   * @note Safe to call from any thread, e.g. signal handling one
+   */
+  void stop();
+
+  /* Number of jobs run so far */
+  [[nodiscard]] std::uint64_t getNumJobs() const {
+    return numJobs_.load(std::memory_order_relaxed);
+  }
+  /* Number of jobs being run now */
+  [[nodiscard]] std::size_t getNumRunningJobs() const;
+
+private:
+  void work();
+  /* Run jobs of connected client till it disconnects */
+  void serve(int conn);
+  /* Hart running job of connection, nullptr between jobs */
+  void setHart(int conn, Hart *hart);
+  void fail(std::exception_ptr error);
+
+  fs::path socket_;
+  std::size_t numThreads_{};
+  BatchRunner runner_;
+  int listenFd_{-1};
+  std::atomic<std::uint64_t> numJobs_{};
+
+  // Connections of clients are shut down & their harts stopped on stop
+  mutable std::mutex connsMutex_{};
+  std::unordered_map<int, Hart *> conns_{};
+  bool isStopped_{false};
+  std::exception_ptr error_{};
+};
+
+/**
+ * @brief Run job on JobServer & wait for its result
+ *
+ * @param[out] console UART output of the job
+ */
+BatchResult submitJob(const fs::path &socket, const BatchJob &job,
+                      std::string &console);
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_SERVER_HH__
@@ -0,0 +1,87 @@
+#ifndef __INCLUDE_HART_SIMPOINT_HH__
+#define __INCLUDE_HART_SIMPOINT_HH__
+
+#include <filesystem>
+#include <ostream>
+#include <vector>
+
+#include "common/common.hh"
+#include "hart/hart.hh"
+#include "memory/memory.hh"
+
+namespace sim {
+
+namespace fs = std::filesystem;
+
+/* Representative interval & its weight in the whole run */
+struct SimPoint final {
+  std::uint64_t interval{};
+  double weight{};
+};
+
+/*
+  SimPoint output files are text:
+    .simpoints: <interval index> <simpoint id>
+    .weights:   <weight> <simpoint id>
+*/
+std::vector<SimPoint> loadSimPoints(const fs::path &simpoints,
+                                    const fs::path &weights);
+
+struct IntervalResult final {
+  SimPoint point{};
+  std::uint64_t numInstrs{};
+  // Estimated w/ Counters::getThroughput
+  std::uint64_t numCycles{};
+  std::uint64_t timeMcs{};
+  TLB::TLBStats instrTLBStats{};
+  TLB::TLBStats dataTLBStats{};
+  double bbCacheHitRate{};
+
+  [[nodiscard]] double getCPI() const {
+    return numInstrs ? static_cast<double>(numCycles) /
+                           static_cast<double>(numInstrs)
+                     : 0.0;
+  }
+};
+
+/**
+ * @brief Detailed simulation of representative intervals only
+ * @details
+ * One fast-forward pass saves a checkpoint before every interval. Then
+ * intervals are simulated in parallel, each one by its own hart restored
+ * from the checkpoint w/ block statistics enabled. Checkpoints are mapped
+ * copy-on-write, so workers share the unmodified pages.
+ */
+class IntervalSampler final {
+public:
+  IntervalSampler(fs::path executable, HartConfig config,
+                  std::uint64_t intervalSize);
+
+  /**
+   * @brief Simulate intervals
+   *
+   * @param[in] checkpointDir directory for the checkpoints, they are
+   * removed afterwards
+   * @return results of intervals in order of points, intervals after
+   * program completion are dropped
+   */
+  std::vector<IntervalResult> run(const std::vector<SimPoint> &points,
+                                  std::size_t numThreads,
+                                  const fs::path &checkpointDir) const;
+
+  /* Print every interval & weighted totals */
+  static void print(std::ostream &ost,
+                    const std::vector<IntervalResult> &results);
+
+private:
+  IntervalResult runInterval(const SimPoint &point,
+                             const fs::path &checkpoint) const;
+
+  fs::path executable_;
+  HartConfig config_;
+  std::uint64_t intervalSize_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_HART_SIMPOINT_HH__
@@ -1,48 +1,171 @@
 #ifndef __INCLUDE_MEMORY_MEMORY_HH__
 #define __INCLUDE_MEMORY_MEMORY_HH__
 
-#include "common/common.hh"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <concepts>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/common.hh"
+#include "common/timer.hh"
+#include "memory/mmio.hh"
+#include "memory/mmu.hh"
+#include "trace/trace.hh"
 
 namespace sim {
 
-struct Page {
-  Page() : wordStorage(kPageSize / sizeof(Word)) {}
+/*
+  Page contents either live in the page itself or in external memory
+  (e.g. copy-on-write mapping of checkpoint file). Copy assignment copies
+  the contents into existing storage, so TLB entries pointing to the page
+  stay valid.
+*/
+class Page final {
+public:
+  static constexpr std::size_t kWords = kPageSize / sizeof(Word);
+  using Storage = std::span<Word, kWords>;
+
+  Page() : owned_(std::make_unique<Word[]>(kWords)), words_(owned_.get()) {}
+  explicit Page(Word *external) : words_(external) {}
+
+  Page(const Page &other) : Page() { copyFrom(other); }
+  Page &operator=(const Page &other) {
+    if (this != &other)
+      copyFrom(other);
+    return *this;
+  }
+  Page(Page &&) = default;
+  Page &operator=(Page &&) = default;
+  ~Page() = default;
 
-  std::vector<Word> wordStorage{};
+  [[nodiscard]] Storage words() const { return Storage{words_, kWords}; }
+
+private:
+  void copyFrom(const Page &other) {
+    std::copy_n(other.words_, kWords, words_);
+  }
+
+  std::unique_ptr<Word[]> owned_{};
+  Word *words_{};
 };
 
+/* Copies of pages by physical page number */
 using PT = std::unordered_map<uint32_t, Page>;
 using PagePtr = Page *;
 
 /*
-  We use pointers on std::unordered_map::value because
-  (§23.2.5/13) The insert and emplace members shall not affect the validity
-  of references to container elements, but may invalidate all iterators
-  to the container.
-  The erase members shall invalidate only iterators and references
-  to the erased elements.
+  Physical pages by page number, may be shared by harts running on their own
+  threads. Two-level radix table: lookup is lock-free (two acquire loads),
+  missing leaves & pages are installed w/ compare-and-swap, so harts storing
+  to a fresh page at the same time end up w/ the same one. Pages never move,
+  so pointers to them (e.g. TLB entries) stay valid till they are erased.
+  Erasing & clearing are not thread-safe: nobody else may use the table.
 */
+class PageTable final {
+  static constexpr std::uint32_t kLeafBits = 10;
+  static constexpr std::uint32_t kLeafSize = std::uint32_t{1} << kLeafBits;
+
+public:
+  static constexpr std::uint32_t kNumPages = std::uint32_t{1}
+                                             << (sizeofBits<Addr>() -
+                                                 kOffsetBits);
+
+  /* Present pages in order of page numbers */
+  class Iterator final {
+  public:
+    using value_type = std::pair<std::uint32_t, const Page &>;
+
+    Iterator(const PageTable &table, std::uint32_t ppn)
+        : table_(&table), ppn_(table.findNext(ppn)) {}
+
+    value_type operator*() const { return {ppn_, *table_->find(ppn_)}; }
+    Iterator &operator++() {
+      ppn_ = table_->findNext(ppn_ + 1);
+      return *this;
+    }
+    bool operator==(const Iterator &other) const { return ppn_ == other.ppn_; }
+
+  private:
+    const PageTable *table_{};
+    std::uint32_t ppn_{};
+  };
+
+  PageTable() = default;
+  PageTable(const PageTable &) = delete;
+  PageTable(PageTable &&) = delete;
+  PageTable &operator=(const PageTable &) = delete;
+  PageTable &operator=(PageTable &&) = delete;
+  ~PageTable();
+
+  /* Page or nullptr if there is none, lock-free */
+  [[nodiscard]] PagePtr find(std::uint32_t ppn) const {
+    const auto *leaf = dir_[ppn >> kLeafBits].load(std::memory_order_acquire);
+    if (!leaf)
+      return nullptr;
+    return (*leaf)[ppn & (kLeafSize - 1)].load(std::memory_order_acquire);
+  }
+  /* Insert page if there is none, lock-free. Returns page in the table */
+  PagePtr insert(std::uint32_t ppn, Page page);
+  void erase(std::uint32_t ppn);
+  void clear();
+
+  [[nodiscard]] std::size_t size() const {
+    return size_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] Iterator begin() const { return Iterator{*this, 0}; }
+  [[nodiscard]] Iterator end() const { return Iterator{*this, kNumPages}; }
+
+private:
+  using Leaf = std::array<std::atomic<PagePtr>, kLeafSize>;
+  static constexpr std::uint32_t kDirSize = kNumPages / kLeafSize;
+
+  /* Slot of page in leaf, leaf is installed if missing */
+  std::atomic<PagePtr> &getSlot(std::uint32_t ppn);
+  /* The first present page number not less than ppn or kNumPages */
+  [[nodiscard]] std::uint32_t findNext(std::uint32_t ppn) const;
+
+  std::array<std::atomic<Leaf *>, kDirSize> dir_{};
+  std::atomic<std::size_t> size_{};
+};
 
 class TLB final {
 public:
+#ifdef TLB_STATS
+  static constexpr bool kCollectStats = true;
+#else
+  static constexpr bool kCollectStats = false;
+#endif
+
   using TLBIndex = uint16_t;
+  using Generation = uint32_t;
+  using ASID = MMU::ASID;
   struct TLBEntry {
+    // Page number in upper bits, ASID in page offset bits
     Addr virtualAddress{0};
+    // Which bits of virtualAddress have to match (ASID is skipped for global)
+    Addr tagMask{0};
     PagePtr physPage{nullptr};
-    bool valid{false};
+    // Entry is valid only if it was filled during the current generation
+    Generation generation{0};
+    std::uint8_t perms{0};
     TLBEntry() = default;
-    TLBEntry(Addr addr, PagePtr page, bool vld)
-        : virtualAddress(addr), physPage(page), valid(vld) {}
+    TLBEntry(Addr addr, Addr mask, PagePtr page, Generation gen,
+             std::uint8_t prm)
+        : virtualAddress(addr), tagMask(mask), physPage(page),
+          generation(gen), perms(prm) {}
+
+    [[nodiscard]] bool isGlobal() const { return tagMask == kTLBMask; }
+    [[nodiscard]] bool matches(Addr key, Generation gen) const {
+      return ((virtualAddress ^ key) & tagMask) == 0 && generation == gen;
+    }
   };
 
   struct TLBStats {
@@ -51,17 +174,56 @@ public:
     std::size_t TLBRequests{};
 
     TLBStats() = default;
+    [[nodiscard]] double hitRate() const {
+      return TLBRequests ? static_cast<double>(TLBHits) /
+                               static_cast<double>(TLBRequests) * 100.0
+                         : 0.0;
+    }
   };
 
-  TLB() : tlb(kTLBSize) {}
-  PagePtr tlbLookup(Addr addr);
-  void tlbUpdate(Addr addr, PagePtr page);
-  TLBIndex getTLBIndex(Addr addr);
+  /**
+   * @brief Construct N-way set-associative TLB
+   *
+   * @param numEntries total number of entries (power of 2)
+   * @param numWays associativity, must divide numEntries (1 - direct-mapped)
+   */
+  explicit TLB(std::size_t numEntries = kTLBSize,
+               std::size_t numWays = kTLBWays);
+  /**
+   * @brief Find page for virtual address
+   *
+   * @param[in] addr virtual address
+   * @param[in] asid current address space id
+   * @param[in] access permission bits required by access (sv32::R/W/X)
+   * @return PagePtr cached page or nullptr on miss
+   */
+  PagePtr tlbLookup(Addr addr, ASID asid = 0, std::uint8_t access = 0);
+  void tlbUpdate(Addr addr, PagePtr page, ASID asid = 0,
+                 std::uint8_t perms = sv32::kPermMask, bool global = true);
+  [[nodiscard]] TLBIndex getTLBIndex(Addr addr) const;
   [[nodiscard]] const TLBStats &getTLBStats() const;
+  void setTLBStats(const TLBStats &newStats) { stats = newStats; }
+  [[nodiscard]] std::size_t getNumWays() const { return numWays_; }
+  [[nodiscard]] std::size_t getNumSets() const { return setMask_ + 1; }
   void tlbFlush();
+  /**
+   * @brief Selective flush (SFENCE.VMA semantics)
+   *
+   * @param[in] addr flush only entries for this page if present
+   * @param[in] asid flush only non-global entries of this ASID if present
+   */
+  void tlbFlush(std::optional<Addr> addr, std::optional<ASID> asid);
 
 private:
+  static Addr makeKey(Addr addr, ASID asid) { return (addr & kTLBMask) | asid; }
+
+  TLBEntry *getSet(Addr addr) { return &tlb[getTLBIndex(addr) * numWays_]; }
+
+  std::size_t numWays_{};
+  std::size_t setMask_{};
+  // Entries are stored set by set, the most recently used way goes first
   std::vector<TLBEntry> tlb{};
+  Generation generation_{1};
   TLBStats stats{};
 };
 
@@ -69,6 +231,14 @@ template <typename T>
 concept isSimType =
     std::same_as<T, Word> || std::same_as<T, Byte> || std::same_as<T, Half>;
 
+/**
+ * @brief Physical memory: RAM pages, devices & dirty page tracking
+ * @details
+ * Memory may be shared by harts running on their own threads: page lookups,
+ * allocation of pages on first store & marking pages dirty are thread-safe.
+ * Snapshots, mapping pages, clearing dirty trackers & adding devices are
+ * not, nobody else may use memory meanwhile.
+ */
 class PhysMemory final {
 public:
   struct AddrSections {
@@ -98,22 +268,115 @@ public:
         : std::runtime_error(msg) {}
   };
 
-  enum struct MemoryOp { STORE = 0, LOAD = 1 };
+  enum struct MemoryOp { STORE = 0, LOAD = 1, FETCH = 2 };
 
   PhysMemory() = default;
 
   template <MemoryOp op> PagePtr pageTableLookup(const AddrSections &sect);
 
-  template <isSimType T, PhysMemory::MemoryOp op> T *getEntity(Addr addr);
   uint16_t getOffset(Addr addr);
 
-  [[nodiscard]] const TLB::TLBStats getTLBStats() { return tlb.getTLBStats(); }
+  /**
+   * @brief Access word by physical address bypassing translation & TLBs
+   * @note Used by page table walker, caller is responsible for markDirty
+   */
+  Word &getPhysWord(Addr paddr);
+
+  /* Copy of all the pages, baseline for fast resets */
+  struct Snapshot {
+    PT pages{};
+  };
+
+  /*
+    Independent dirty page trackers: store marks page in all of them, each
+    one is cleared separately
+  */
+  enum DirtyTracker : std::uint8_t {
+    SNAPSHOT, /* Pages changed since snapshot taken/updated/restored */
+    HASH,     /* Pages changed since state hashed */
+    kNumDirtyTrackers,
+  };
+
+  void markDirty(Addr paddr) {
+    auto ppn = paddr >> kOffsetBits;
+    auto bit = DWord{1} << (ppn % kBitsInDirtyWord);
+    for (auto &dirtyMap : dirtyMaps) {
+      auto &bits = dirtyMap[ppn / kBitsInDirtyWord];
+      // Pages shared by harts are usually dirty already: skip the write
+      if (!(bits.load(std::memory_order_relaxed) & bit))
+        bits.fetch_or(bit, std::memory_order_relaxed);
+    }
+  }
+  [[nodiscard]] bool isDirty(Addr paddr,
+                             DirtyTracker tracker = SNAPSHOT) const {
+    auto ppn = paddr >> kOffsetBits;
+    const auto &bits = dirtyMaps[tracker][ppn / kBitsInDirtyWord];
+    return (bits.load(std::memory_order_relaxed) >> (ppn % kBitsInDirtyWord)) &
+           1;
+  }
+  /* Physical page numbers of pages stored to since the last clear */
+  [[nodiscard]] std::vector<std::uint32_t>
+  getDirtyPages(DirtyTracker tracker = SNAPSHOT) const;
+  /**
+   * @brief Start new dirty tracking epoch
+   * @note Data TLBs caching pages of memory have to be flushed
+   */
+  void clearDirty(DirtyTracker tracker = SNAPSHOT);
+
+  [[nodiscard]] Snapshot takeSnapshot();
+  /* Copy only pages dirtied since the last checkpoint into snapshot */
+  void updateSnapshot(Snapshot &snapshot);
+  /**
+   * @brief Bring back snapshot contents of the pages dirtied since checkpoint
+   *
+   * @return true if pages absent from snapshot were removed, so TLBs have to
+   * be flushed
+   */
+  bool restoreSnapshot(const Snapshot &snapshot);
+
+  /**
+   * @brief Map device to physical address range
+   *
+   * @param[in] base page aligned physical base address
+   * @param[in] device device to map
+   * @return raw pointer to the device owned by memory
+   */
+  MMIODevice *addDevice(Addr base, std::unique_ptr<MMIODevice> device);
+  [[nodiscard]] MMIOBus &getBus() { return bus; }
+
+  [[nodiscard]] const PageTable &getPages() const { return pageTable; }
+  /**
+   * @brief Replace memory contents w/ pages stored outside of PhysMemory
+   *
+   * @param[in] pages physical page number & its storage pairs
+   * @param[in] owner keeps storage alive while pages are in use
+   */
+  void mapPages(const std::vector<std::pair<std::uint32_t, Word *>> &pages,
+                std::shared_ptr<void> owner);
 
 private:
-  PT pageTable{};
-  TLB tlb{};
+  static constexpr std::size_t kBitsInDirtyWord = sizeofBits<DWord>();
+  static constexpr std::size_t kDirtyMapSize =
+      PageTable::kNumPages / kBitsInDirtyWord;
+
+  PageTable pageTable{};
+  MMIOBus bus{};
+  // One bit per physical page for each tracker
+  std::array<std::vector<std::atomic<DWord>>, kNumDirtyTrackers> dirtyMaps{
+      std::vector<std::atomic<DWord>>(kDirtyMapSize),
+      std::vector<std::atomic<DWord>>(kDirtyMapSize)};
+  // External page storage (mapped checkpoints)
+  std::vector<std::shared_ptr<void>> storageOwners{};
 };
 
+/**
+ * @brief Hart's view of physical memory
+ * @details
+ * Address translation, TLBs & statistics belong to the hart, physical
+ * memory may be shared w/ other harts. Operations replacing memory contents
+ * or clearing dirty trackers flush TLBs of this view only: other harts
+ * sharing memory must not run meanwhile.
+ */
 class Memory final {
 public:
   struct MemoryStats {
@@ -125,11 +388,72 @@ public:
 private:
   MemoryStats stats{};
 
-  PhysMemory physMem{};
+  std::shared_ptr<PhysMemory> physMem{};
+  MMU mmu{};
+  TLB instrTLB{};
+  TLB dataTLB{};
+  std::uint64_t translationEpoch{};
   bool isProgramStored{false};
+  Tracer *tracer_{};
+  std::vector<std::pair<Addr, Word>> *storeLog_{};
+  // Address & value loaded by the last LR
+  std::optional<std::pair<Addr, Word>> reservation_{};
+
+  template <PhysMemory::MemoryOp op> TLB &getTLB() {
+    if constexpr (op == PhysMemory::MemoryOp::FETCH)
+      return instrTLB;
+    else
+      return dataTLB;
+  }
+
+  template <PhysMemory::MemoryOp op>
+  static constexpr sv32::PTEFlags getAccessPerm() {
+    if constexpr (op == PhysMemory::MemoryOp::FETCH)
+      return sv32::X;
+    else if constexpr (op == PhysMemory::MemoryOp::STORE)
+      return sv32::W;
+    else
+      return sv32::R;
+  }
+
+  template <isSimType T> static void checkAlignment(Addr addr) {
+    if (addr % sizeof(T) ||
+        ((getBits<kOffsetBits - 1, 0>(addr) + sizeof(T)) > kPageSize))
+      throw PhysMemory::MisAlignedAddrException(
+          "Misaligned memory access is not supported!");
+  }
+
+  template <isSimType T> static T *getEntityPtr(PagePtr page, Addr addr) {
+    auto offset = getBits<kOffsetBits - 1, 0>(addr);
+    Word *word = &page->words()[offset / sizeof(Word)];
+    Byte *byte = reinterpret_cast<Byte *>(word) + (offset % sizeof(Word));
+    return reinterpret_cast<T *>(byte);
+  }
+
+  template <isSimType T, PhysMemory::MemoryOp op> T *getEntity(Addr addr);
+  /* Data accesses which may go to devices */
+  template <isSimType T> T load(Addr addr);
+  template <isSimType T> void store(Addr addr, T entity);
+
+  /**
+   * @brief Translate address & cache the page in TLB
+   *
+   * @param[in] addr virtual address
+   * @param[out] physAddr physical address
+   * @return PagePtr RAM page or nullptr for device page
+   */
+  template <PhysMemory::MemoryOp op>
+  PagePtr tlbRefill(Addr addr, Addr &physAddr);
+
+  void flushTLB();
+  /* Trace & log value written to memory */
+  template <isSimType T> void onStore(Addr addr, T entity);
 
 public:
-  Memory() = default;
+  Memory() : Memory(std::make_shared<PhysMemory>()) {}
+  /* View of physical memory shared w/ other harts */
+  explicit Memory(std::shared_ptr<PhysMemory> physMemory)
+      : physMem(std::move(physMemory)) {}
   Memory(const Memory &) = delete;
   Memory(Memory &&) = delete;
   Memory &operator=(const Memory &) = delete;
@@ -138,60 +462,214 @@ public:
 
   template <isSimType Type> Type loadEntity(Addr addr);
   template <isSimType Type> void storeEntity(Addr addr, Type entity);
+  Word fetchInstr(Addr addr);
+
+  /**
+   * @brief Atomic read-modify-write of word (AMO)
+   * @details Word is accessed in place through std::atomic_ref, so harts
+   * sharing memory are not serialized. Device memory is not supported.
+   *
+   * @param[in] op performs operation on std::atomic_ref<Word> & returns
+   * old & new values of the word
+   * @return old value
+   */
+  template <std::invocable<std::atomic_ref<Word>> Op>
+  Word amoEntity(Addr addr, Op op);
+  /**
+   * @brief Load word & reserve it for storeConditional (LR)
+   * @details Reservation remembers the loaded value, not ownership of the
+   * address: no other hart has to be notified on stores.
+   */
+  Word loadReserved(Addr addr);
+  /**
+   * @brief Store word if it still holds the value seen by loadReserved (SC)
+   * @details Compare-and-swap w/ the reserved value, so a store of the same
+   * value by another hart goes unnoticed. Reservation is cleared anyway.
+   *
+   * @return true if word has been stored
+   */
+  bool storeConditional(Addr addr, Word val);
 
   void setProgramStoredFlag() { isProgramStored = true; }
+  void setTracer(Tracer *tracer) { tracer_ = tracer; }
+  /* Append address & value of every store to log (nullptr to stop) */
+  void setStoreLog(std::vector<std::pair<Addr, Word>> *storeLog) {
+    storeLog_ = storeLog;
+  }
 
   void printMemStats(std::ostream &ost) const;
+  void printTLBStats(std::ostream &ost) const;
   [[nodiscard]] const MemoryStats &getMemStats() const;
+  void setMemStats(const MemoryStats &newStats) { stats = newStats; }
 
   template <std::forward_iterator It>
   void storeRange(Addr start, It begin, It end);
 
-  [[nodiscard]] TLB::TLBStats getTLBStats() { return physMem.getTLBStats(); }
+  [[nodiscard]] const TLB::TLBStats &getInstrTLBStats() const {
+    return instrTLB.getTLBStats();
+  }
+  [[nodiscard]] const TLB::TLBStats &getDataTLBStats() const {
+    return dataTLB.getTLBStats();
+  }
+
+  void configureTLB(std::size_t numEntries, std::size_t numWays);
+  void setTLBStats(const TLB::TLBStats &instr, const TLB::TLBStats &data) {
+    instrTLB.setTLBStats(instr);
+    dataTLB.setTLBStats(data);
+  }
+
+  MMIODevice *addDevice(Addr base, std::unique_ptr<MMIODevice> device);
+
+  [[nodiscard]] const std::shared_ptr<PhysMemory> &getPhysMemory() const {
+    return physMem;
+  }
+  [[nodiscard]] const PageTable &getPages() const {
+    return physMem->getPages();
+  }
+  void mapPages(const std::vector<std::pair<std::uint32_t, Word *>> &pages,
+                std::shared_ptr<void> owner);
+
+  void setSatp(RegVal satp);
+  void sfenceVMA(std::optional<Addr> addr, std::optional<MMU::ASID> asid);
+  [[nodiscard]] const MMU &getMMU() const { return mmu; }
+  /* Changes every time virtual to physical mapping may have been changed */
+  [[nodiscard]] std::uint64_t getTranslationEpoch() const {
+    return translationEpoch;
+  }
+
+  [[nodiscard]] std::vector<std::uint32_t> getDirtyPages(
+      PhysMemory::DirtyTracker tracker = PhysMemory::SNAPSHOT) const {
+    return physMem->getDirtyPages(tracker);
+  }
+  void clearDirty(PhysMemory::DirtyTracker tracker = PhysMemory::SNAPSHOT);
+  [[nodiscard]] PhysMemory::Snapshot takeSnapshot();
+  void updateSnapshot(PhysMemory::Snapshot &snapshot);
+  void restoreSnapshot(const PhysMemory::Snapshot &snapshot);
 };
 
-//~~~~~PhysMemory class templated functions~~~~~
-template <isSimType T, PhysMemory::MemoryOp op>
-inline T *PhysMemory::getEntity(Addr addr) {
-  if (addr % sizeof(T) || ((getOffset(addr) + sizeof(T)) > (1 << kOffsetBits)))
-    throw PhysMemory::MisAlignedAddrException(
-        "Misaligned memory access is not supported!");
-  AddrSections sections(addr);
-  auto offset = sections.offset;
-
-  auto isInTLB = tlb.tlbLookup(addr);
-  PagePtr page{};
-
-  if (isInTLB) {
-    page = isInTLB;
-  } else {
-    page = PhysMemory::pageTableLookup<op>(sections);
-    tlb.tlbUpdate(addr, page);
-  }
-  Word *word = &page->wordStorage.at(offset / sizeof(Word));
-  Byte *byte = reinterpret_cast<Byte *>(word) + (offset % sizeof(Word));
-  return reinterpret_cast<T *>(byte);
+//~~~~~TLB class inline functions~~~~~
+
+inline TLB::TLBIndex TLB::getTLBIndex(Addr addr) const {
+  return static_cast<TLBIndex>((addr >> kOffsetBits) & setMask_);
 }
 
+inline PagePtr TLB::tlbLookup(Addr addr, ASID asid, std::uint8_t access) {
+  if constexpr (kCollectStats)
+    stats.TLBRequests++;
+
+  auto *set = getSet(addr);
+  auto key = makeKey(addr, asid);
+  for (std::size_t way = 0; way < numWays_; ++way) {
+    auto &entry = set[way];
+    if (!entry.matches(key, generation_) || (entry.perms & access) != access)
+      continue;
+
+    // Move to front: keeps ways in LRU order & makes next hit cheaper
+    if (way != 0)
+      std::rotate(set, set + way, set + way + 1);
+    if constexpr (kCollectStats)
+      stats.TLBHits++;
+    return set->physPage;
+  }
+
+  if constexpr (kCollectStats)
+    stats.TLBMisses++;
+  return nullptr;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//~~~~~PhysMemory class templated functions~~~~~
 template <PhysMemory::MemoryOp op>
 PagePtr PhysMemory::pageTableLookup(const AddrSections &sect) {
+  timer::ScopedTimer scopedTimer{timer::Section::PAGE_TABLE};
 
   using MemOp = PhysMemory::MemoryOp;
-  auto index = sect.indexPt;
-  auto it_PT = pageTable.find(index);
-  if (it_PT == pageTable.end()) {
-    if constexpr (op == MemOp::LOAD)
+  auto page = pageTable.find(sect.indexPt);
+  if (!page) {
+    if constexpr (op != MemOp::STORE)
       throw PhysMemory::PageFaultException(
           "Load on unmapped region in physical mem");
-    else {
-      pageTable[index] = Page();
-    }
+    else
+      page = pageTable.insert(sect.indexPt, Page());
   }
-  return &pageTable.at(index);
+  return page;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 //~~~~~Memory class templated functions~~~~~
+template <isSimType T, PhysMemory::MemoryOp op>
+inline T *Memory::getEntity(Addr addr) {
+  checkAlignment<T>(addr);
+
+  auto page = getTLB<op>().tlbLookup(addr, mmu.getASID(), getAccessPerm<op>());
+  if (!page) [[unlikely]] {
+    Addr physAddr{};
+    page = tlbRefill<op>(addr, physAddr);
+    if (!page)
+      throw PhysMemory::PageFaultException(
+          "Direct access to device memory is not supported");
+  }
+
+  return getEntityPtr<T>(page, addr);
+}
+
+template <isSimType T> inline T Memory::load(Addr addr) {
+  checkAlignment<T>(addr);
+
+  auto page = dataTLB.tlbLookup(addr, mmu.getASID(), sv32::R);
+  if (!page) [[unlikely]] {
+    Addr physAddr{};
+    page = tlbRefill<PhysMemory::MemoryOp::LOAD>(addr, physAddr);
+    if (!page)
+      return static_cast<T>(physMem->getBus().read(physAddr, sizeof(T)));
+  }
+
+  return *getEntityPtr<T>(page, addr);
+}
+
+template <isSimType T> inline void Memory::store(Addr addr, T entity) {
+  checkAlignment<T>(addr);
+
+  auto page = dataTLB.tlbLookup(addr, mmu.getASID(), sv32::W);
+  if (!page) [[unlikely]] {
+    Addr physAddr{};
+    page = tlbRefill<PhysMemory::MemoryOp::STORE>(addr, physAddr);
+    if (!page)
+      return physMem->getBus().write(physAddr, entity, sizeof(T));
+  }
+
+  *getEntityPtr<T>(page, addr) = entity;
+}
+
+template <PhysMemory::MemoryOp op>
+PagePtr Memory::tlbRefill(Addr addr, Addr &physAddr) {
+  using MemOp = PhysMemory::MemoryOp;
+  // Identity mapping w/ all permissions when paging is off
+  MMU::Translation trans{addr, sv32::kPermMask, true};
+  if (mmu.isPagingOn())
+    trans = mmu.translate(addr, getAccessPerm<op>(), *physMem);
+  physAddr = trans.physAddr;
+
+  // Device pages are not cached, every access goes to the bus
+  const auto &bus = physMem->getBus();
+  if (!bus.empty() && bus.isDevicePage(trans.physAddr))
+    return nullptr;
+
+  auto page =
+      physMem->pageTableLookup<op>(PhysMemory::AddrSections(trans.physAddr));
+  // Data TLB entry is writable only if page is already dirty in current
+  // epoch of every tracker: the first store to a page always comes here and
+  // marks it.
+  if constexpr (op == MemOp::STORE)
+    physMem->markDirty(trans.physAddr);
+  else if (!physMem->isDirty(trans.physAddr, PhysMemory::SNAPSHOT) ||
+           !physMem->isDirty(trans.physAddr, PhysMemory::HASH))
+    trans.perms &= static_cast<std::uint8_t>(~sv32::W);
+
+  getTLB<op>().tlbUpdate(addr, page, mmu.getASID(), trans.perms, trans.global);
+  return page;
+}
+
 
 template <std::forward_iterator It>
 inline void Memory::storeRange(Addr start, It begin, It end) {
@@ -204,14 +682,34 @@ inline void Memory::storeRange(Addr start, It begin, It end) {
 
 template <isSimType Type> Type Memory::loadEntity(Addr addr) {
   stats.numLoads++;
-  Type loadedEntity =
-      *physMem.getEntity<Type, PhysMemory::MemoryOp::LOAD>(addr);
-  return loadedEntity;
+  return load<Type>(addr);
+}
+
+inline Word Memory::fetchInstr(Addr addr) {
+  return *getEntity<Word, PhysMemory::MemoryOp::FETCH>(addr);
 }
 
 template <isSimType Type> void Memory::storeEntity(Addr addr, Type entity) {
   stats.numStores++;
-  *physMem.getEntity<Type, PhysMemory::MemoryOp::STORE>(addr) = entity;
+  store<Type>(addr, entity);
+  onStore(addr, entity);
+}
+
+template <std::invocable<std::atomic_ref<Word>> Op>
+Word Memory::amoEntity(Addr addr, Op op) {
+  stats.numLoads++;
+  stats.numStores++;
+  auto *word = getEntity<Word, PhysMemory::MemoryOp::STORE>(addr);
+  auto [old, res] = op(std::atomic_ref<Word>{*word});
+  onStore(addr, res);
+  return old;
+}
+
+template <isSimType T> void Memory::onStore(Addr addr, T entity) {
+  if (tracer_) [[unlikely]]
+    tracer_->memWrite(addr, entity);
+  if (storeLog_) [[unlikely]]
+    storeLog_->emplace_back(addr, entity);
 #ifdef SPDLOG
   if (isProgramStored) {
     cosimLog("M[0x{:08x}]=0x{:08x}", addr, entity);
@@ -0,0 +1,160 @@
+#ifndef __INCLUDE_MEMORY_MMIO_HH__
+#define __INCLUDE_MEMORY_MMIO_HH__
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/common.hh"
+
+namespace sim {
+
+/* Memory map of the standard devices (same as in QEMU virt machine) */
+constexpr Addr kFinisherBase = 0x00100000;
+constexpr Addr kCLINTBase = 0x02000000;
+constexpr Addr kUARTBase = 0x10000000;
+
+class MMIODevice {
+public:
+  virtual ~MMIODevice() = default;
+
+  /* Size of device address range in bytes */
+  [[nodiscard]] virtual Addr getSize() const = 0;
+  /**
+   * @brief Register read
+   *
+   * @param[in] offset offset from the device base address
+   * @param[in] size access size in bytes
+   */
+  virtual Word read(Addr offset, std::size_t size) = 0;
+  virtual void write(Addr offset, Word value, std::size_t size) = 0;
+};
+
+/**
+ * @brief Console (subset of 16550 UART): transmit only
+ * @details
+ * Output is accumulated in a buffer & written to the host stream in bulk:
+ * when buffer is full, on flush() and on destruction.
+ */
+class UART final : public MMIODevice {
+public:
+  enum Registers : Addr {
+    THR = 0, /* Transmitter holding register */
+    LSR = 5, /* Line status register */
+  };
+  /* Transmitter is always empty & idle */
+  static constexpr Word kLSRTxIdle = 0x60;
+
+  explicit UART(std::ostream &out, std::size_t bufferSize = kPageSize);
+  UART(const UART &) = delete;
+  UART &operator=(const UART &) = delete;
+  ~UART() override;
+
+  [[nodiscard]] Addr getSize() const override { return kPageSize; }
+  Word read(Addr offset, std::size_t size) override;
+  void write(Addr offset, Word value, std::size_t size) override;
+  void flush();
+
+private:
+  std::ostream &out_;
+  std::size_t bufferSize_{};
+  std::string buffer_{};
+};
+
+/**
+ * @brief Core local interruptor: machine timer & software interrupt
+ * registers of a single hart
+ * @note Interrupts are not delivered, registers are just readable/writable
+ */
+class CLINT final : public MMIODevice {
+public:
+  using TimeSource = std::function<DWord()>;
+
+  enum Registers : Addr {
+    MSIP = 0x0,
+    MTIMECMP = 0x4000,
+    MTIME = 0xBFF8,
+  };
+
+  explicit CLINT(TimeSource getTime) : getTime_(std::move(getTime)) {}
+
+  [[nodiscard]] Addr getSize() const override { return 0x10000; }
+  Word read(Addr offset, std::size_t size) override;
+  void write(Addr offset, Word value, std::size_t size) override;
+
+private:
+  TimeSource getTime_{};
+  Word msip_{};
+  DWord mtimecmp_{};
+};
+
+/**
+ * @brief Test finisher (SiFive test device): guest writes status to stop
+ * simulation
+ * @note Simulation stops at the end of current basic block
+ */
+class TestFinisher final : public MMIODevice {
+public:
+  using ExitHandler = std::function<void(int)>;
+
+  enum Status : Word {
+    FAIL = 0x3333, /* exit code is in upper half */
+    PASS = 0x5555,
+  };
+
+  explicit TestFinisher(ExitHandler onExit) : onExit_(std::move(onExit)) {}
+
+  [[nodiscard]] Addr getSize() const override { return kPageSize; }
+  Word read(Addr, std::size_t) override { return 0; }
+  void write(Addr offset, Word value, std::size_t size) override;
+
+private:
+  ExitHandler onExit_{};
+};
+
+/**
+ * @brief Physical address space of devices
+ * @details
+ * Devices occupy whole pages: bus keeps a page number to device table which
+ * is consulted by PhysMemory on TLB refill only. Device pages never get
+ * into TLBs, so RAM accesses do not pay for devices.
+ */
+class MMIOBus final {
+public:
+  /**
+   * @brief Map device to physical address range
+   *
+   * @param[in] base page aligned physical base address
+   * @param[in] device device to map
+   * @return raw pointer to the device owned by bus
+   */
+  MMIODevice *addDevice(Addr base, std::unique_ptr<MMIODevice> device);
+
+  [[nodiscard]] bool empty() const { return pages_.empty(); }
+  [[nodiscard]] bool isDevicePage(Addr paddr) const {
+    return pages_.contains(paddr >> kOffsetBits);
+  }
+
+  Word read(Addr paddr, std::size_t size);
+  void write(Addr paddr, Word value, std::size_t size);
+
+private:
+  struct Mapping {
+    Addr base{};
+    std::unique_ptr<MMIODevice> device{};
+  };
+
+  Mapping &getMapping(Addr paddr);
+
+  std::vector<Mapping> devices_{};
+  // Page number -> index in devices_
+  std::unordered_map<std::uint32_t, std::size_t> pages_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_MEMORY_MMIO_HH__
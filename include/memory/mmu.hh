@@ -0,0 +1,116 @@
+#ifndef __INCLUDE_MEMORY_MMU_HH__
+#define __INCLUDE_MEMORY_MMU_HH__
+
+#include <array>
+
+#include "common/common.hh"
+
+namespace sim {
+
+class PhysMemory;
+
+namespace sv32 {
+
+constexpr std::uint8_t kLevels = 2;
+constexpr std::uint8_t kPTESize = sizeof(Word);
+constexpr std::uint8_t kVPNBits = 10;
+constexpr std::uint8_t kASIDBits = 9;
+constexpr std::uint8_t kPPNBits = 22;
+
+/* satp register layout for Sv32 */
+constexpr Word kSatpModeBit = 31;
+constexpr Word kSatpASIDShift = 22;
+constexpr Word kSatpASIDMask = (1U << kASIDBits) - 1;
+constexpr Word kSatpPPNMask = (1U << kPPNBits) - 1;
+
+/* page table entry flags */
+enum PTEFlags : std::uint8_t {
+  V = 1 << 0, /* Valid */
+  R = 1 << 1, /* Readable */
+  W = 1 << 2, /* Writable */
+  X = 1 << 3, /* Executable */
+  U = 1 << 4, /* User accessible */
+  G = 1 << 5, /* Global mapping */
+  A = 1 << 6, /* Accessed */
+  D = 1 << 7, /* Dirty */
+};
+
+constexpr std::uint8_t kPermMask = R | W | X;
+
+constexpr Word getVPN1(Addr vaddr) { return getBits<31, 22>(vaddr); }
+constexpr Word getVPN0(Addr vaddr) { return getBits<21, 12>(vaddr); }
+constexpr Word getPTEPPN(Word pte) { return getBits<31, 10>(pte); }
+constexpr Word getPTEPPN0(Word pte) { return getBits<19, 10>(pte); }
+
+} // namespace sv32
+
+/**
+ * @brief Sv32 address translation unit
+ * @details
+ * Holds translation context from satp and walks two-level page tables
+ * stored in guest physical memory. Upper level (non-leaf) entries are kept
+ * in a small ASID-tagged page walk cache, so TLB refill usually takes a
+ * single memory access. When paging is off translation is identity.
+ */
+class MMU final {
+public:
+  using ASID = std::uint16_t;
+
+  enum struct Mode : std::uint8_t { BARE = 0, SV32 = 1 };
+
+  struct Translation {
+    Addr physAddr{};
+    std::uint8_t perms{}; // PTE R/W/X bits allowed for the mapping
+    bool global{};
+  };
+
+  [[nodiscard]] bool isPagingOn() const { return mode_ == Mode::SV32; }
+  [[nodiscard]] Mode getMode() const { return mode_; }
+  [[nodiscard]] ASID getASID() const { return asid_; }
+
+  /**
+   * @brief Update translation context
+   *
+   * @param[in] satp new satp value
+   * @return true if translation mode was changed
+   */
+  bool setSatp(RegVal satp);
+
+  /**
+   * @brief Translate virtual address
+   *
+   * @param[in] vaddr virtual address
+   * @param[in] access PTE permission bit required by access (R, W or X)
+   * @param[in] mem physical memory w/ page tables
+   * @return Translation physical address w/ permissions of the mapping
+   */
+  Translation translate(Addr vaddr, sv32::PTEFlags access, PhysMemory &mem);
+
+  void flushWalkCache();
+
+private:
+  static constexpr std::size_t kWalkCacheSize = 16;
+
+  struct WalkCacheEntry {
+    Word tag{};
+    Word pte{};
+    std::uint32_t generation{0};
+  };
+
+  [[nodiscard]] Word getWalkCacheTag(Addr vaddr) const {
+    return (static_cast<Word>(asid_) << sv32::kVPNBits) | sv32::getVPN1(vaddr);
+  }
+
+  Word loadRootPTE(Addr vaddr, PhysMemory &mem);
+
+  Mode mode_{Mode::BARE};
+  ASID asid_{};
+  Addr rootTable_{};
+
+  std::array<WalkCacheEntry, kWalkCacheSize> walkCache_{};
+  std::uint32_t walkCacheGen_{1};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_MEMORY_MMU_HH__
@@ -0,0 +1,91 @@
+#ifndef __INCLUDE_TRACE_CURSOR_HH__
+#define __INCLUDE_TRACE_CURSOR_HH__
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common.hh"
+
+namespace sim {
+
+namespace fs = std::filesystem;
+
+/* Effects of a single instruction as recorded in trace */
+struct InstrEffects final {
+  std::uint64_t num{};
+  // Address of the instruction, if trace allows to get it
+  std::optional<Addr> addr{};
+  // Address of the next instruction
+  Addr pc{};
+  // trace::InsnFlags, text traces have no flags
+  Byte flags{};
+  std::vector<std::pair<RegId, RegVal>> regs{};
+  std::vector<std::pair<Addr, Word>> mems{};
+
+  void clear();
+  /* Instruction in cosim text format */
+  [[nodiscard]] std::string str() const;
+};
+
+class TraceCursor {
+public:
+  virtual ~TraceCursor() = default;
+
+  /* Move to the first instruction with number not less than num */
+  virtual void seek(std::uint64_t num) = 0;
+  /**
+   * @brief Decode next instruction
+   *
+   * @param[out] effects decoded instruction
+   * @return false at the end of trace
+   */
+  virtual bool next(InstrEffects &effects) = 0;
+};
+
+/**
+ * @brief Memory mapped trace either in cosim text or in binary format
+ * @details
+ * Cursors are independent & share the mapping, so different parts of trace
+ * can be decoded in parallel.
+ */
+class TraceFile final {
+public:
+  enum class Format { TEXT, BINARY };
+
+  explicit TraceFile(const fs::path &file);
+  /* Data has to outlive trace */
+  explicit TraceFile(std::span<const Byte> data);
+
+  [[nodiscard]] Format getFormat() const { return format_; }
+
+  /**
+   * @brief Split trace into parts of about the same size
+   *
+   * @param[in] numParts desired number of parts
+   * @return ascending numbers of the first instructions of all parts but the
+   * first one
+   */
+  [[nodiscard]] std::vector<std::uint64_t>
+  getSplitPoints(std::size_t numParts) const;
+
+  /* Cursor must not outlive trace */
+  [[nodiscard]] std::unique_ptr<TraceCursor> makeCursor() const;
+
+private:
+  void init();
+
+  std::shared_ptr<const void> mapping_{};
+  std::span<const Byte> data_{};
+  Format format_{};
+  // Binary format: frame offsets & numbers of instructions at frame starts
+  std::vector<std::pair<std::size_t, std::uint64_t>> frames_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_TRACE_CURSOR_HH__
@@ -0,0 +1,87 @@
+#ifndef __INCLUDE_TRACE_RING_BUFFER_HH__
+#define __INCLUDE_TRACE_RING_BUFFER_HH__
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace sim {
+
+/**
+ * @brief Lock-free single producer single consumer ring of slots
+ * @details
+ * Slots are preallocated & filled in place: producer takes a free slot,
+ * fills it & publishes, consumer takes a published slot, processes it &
+ * releases. Both sides may block waiting for the other one, so stop has
+ * to be signalled in-band (e.g. with a marked slot).
+ */
+template <typename T> class SPSCRingBuffer final {
+public:
+  explicit SPSCRingBuffer(std::size_t capacity)
+      : slots_(capacity), mask_(capacity - 1) {
+    if (!std::has_single_bit(capacity))
+      throw std::invalid_argument{"Ring buffer capacity must be a power of 2"};
+  }
+
+  [[nodiscard]] std::size_t capacity() const { return slots_.size(); }
+
+  /* Producer side */
+  [[nodiscard]] T *tryAcquire() {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == capacity())
+      return nullptr;
+    return &slots_[tail & mask_];
+  }
+
+  T &acquire() {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      auto head = head_.load(std::memory_order_acquire);
+      if (tail - head != capacity())
+        return slots_[tail & mask_];
+      head_.wait(head, std::memory_order_acquire);
+    }
+  }
+
+  void publish() {
+    tail_.fetch_add(1, std::memory_order_release);
+    tail_.notify_one();
+  }
+
+  /* Consumer side */
+  [[nodiscard]] T *tryPeek() {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+      return nullptr;
+    return &slots_[head & mask_];
+  }
+
+  T &peek() {
+    for (;;) {
+      if (auto *slot = tryPeek())
+        return *slot;
+      tail_.wait(head_.load(std::memory_order_relaxed),
+                 std::memory_order_acquire);
+    }
+  }
+
+  void release() {
+    head_.fetch_add(1, std::memory_order_release);
+    head_.notify_one();
+  }
+
+private:
+  static constexpr std::size_t kCacheLine = 64;
+
+  std::vector<T> slots_;
+  std::size_t mask_{};
+  // Monotonic counters, slot index is counter & mask_
+  alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+  alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_TRACE_RING_BUFFER_HH__
@@ -0,0 +1,242 @@
+#ifndef __INCLUDE_TRACE_TRACE_HH__
+#define __INCLUDE_TRACE_TRACE_HH__
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "common/common.hh"
+#include "trace/ring_buffer.hh"
+
+namespace sim {
+
+namespace fs = std::filesystem;
+
+namespace trace {
+
+/*
+  Binary trace layout:
+    header: magic & version
+    frames: 32-bit payload size followed by records
+
+  Record is a tag byte followed by LEB128 varints. Tag holds record type in
+  lower bits & type specific argument in upper ones. Values are delta
+  encoded against the previous record of the same kind, signed deltas are
+  zigzag encoded.
+    SYNC        instruction number, pc of the next instruction
+    INSN(flags) delta of pc after instruction from pc + 4
+    INSN_SEQ    (flags) pc after instruction is pc + 4
+    REG(regnum) delta from the previous value of the register
+    MEM         address delta, raw value
+  REG & MEM records describe the instruction finished by the next INSN.
+
+  SYNC resets all the delta bases. Every frame starts with SYNC, so frames
+  can be decoded independently.
+*/
+constexpr std::array<char, 8> kMagic{'S', 'I', 'M', 'T', 'R', 'A', 'C', 'E'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = kMagic.size() + sizeof(kVersion);
+using FrameSize = std::uint32_t;
+
+enum RecordType : Byte { SYNC = 0, INSN = 1, INSN_SEQ = 2, REG = 3, MEM = 4 };
+constexpr Byte kTypeBits = 3;
+constexpr Byte kTypeMask = (1 << kTypeBits) - 1;
+
+/* INSN flags: instruction results which may legally differ between runs */
+enum InsnFlags : Byte { CSR_ACCESS = 1 << 0 };
+
+constexpr std::size_t kMaxVarintSize = 10;
+constexpr std::size_t kMaxRecordSize = 1 + 2 * kMaxVarintSize;
+
+constexpr Byte makeTag(RecordType type, Byte arg) {
+  return static_cast<Byte>(type | (arg << kTypeBits));
+}
+
+constexpr DWord zigzagEncode(std::int64_t val) {
+  return (static_cast<DWord>(val) << 1) ^ static_cast<DWord>(val >> 63);
+}
+
+constexpr std::int64_t zigzagDecode(DWord val) {
+  return static_cast<std::int64_t>(val >> 1) ^
+         -static_cast<std::int64_t>(val & 1);
+}
+
+/* Signed distance between 32-bit values */
+constexpr std::int64_t wordDelta(Word to, Word from) {
+  return static_cast<std::int32_t>(to - from);
+}
+
+/* Read-only mapping of the whole file, size is set to file size */
+std::shared_ptr<const void> mapFile(const fs::path &file, std::size_t &size);
+
+} // namespace trace
+
+/**
+ * @brief Binary trace writer
+ * @details
+ * Records are encoded by the hart into chunks of a lock-free SPSC ring
+ * buffer & written to file by a separate writer thread.
+ */
+class Tracer final {
+public:
+  static constexpr std::size_t kDefaultChunkSize = 1 << 16;
+  static constexpr std::size_t kDefaultNumChunks = 64;
+
+  explicit Tracer(const fs::path &file,
+                  std::size_t chunkSize = kDefaultChunkSize,
+                  std::size_t numChunks = kDefaultNumChunks);
+  Tracer(const Tracer &) = delete;
+  Tracer(Tracer &&) = delete;
+  Tracer &operator=(const Tracer &) = delete;
+  Tracer &operator=(Tracer &&) = delete;
+  ~Tracer();
+
+  /**
+   * @brief Start trace (or a new segment of it after jump in time)
+   *
+   * @param[in] instrNum number of the next instruction
+   * @param[in] pc address of the next instruction
+   */
+  void sync(std::uint64_t instrNum, Addr pc);
+
+  void regWrite(RegId reg, RegVal val) {
+    ensureSpace();
+    putByte(trace::makeTag(trace::REG, reg));
+    putVarint(trace::zigzagEncode(trace::wordDelta(val, lastRegs_[reg])));
+    lastRegs_[reg] = val;
+  }
+
+  void memWrite(Addr addr, Word val) {
+    ensureSpace();
+    putByte(trace::makeTag(trace::MEM, 0));
+    putVarint(trace::zigzagEncode(trace::wordDelta(addr, lastMemAddr_)));
+    putVarint(val);
+    lastMemAddr_ = addr;
+  }
+
+  /**
+   * @brief Finish instruction
+   *
+   * @param[in] pc address of the next instruction
+   * @param[in] flags trace::InsnFlags
+   */
+  void instrEnd(Addr pc, Byte flags) {
+    ensureSpace();
+    ++instrNum_;
+    auto expected = lastPC_ + kXLENInBytes;
+    if (pc == expected)
+      putByte(trace::makeTag(trace::INSN_SEQ, flags));
+    else {
+      putByte(trace::makeTag(trace::INSN, flags));
+      putVarint(trace::zigzagEncode(trace::wordDelta(pc, expected)));
+    }
+    lastPC_ = pc;
+  }
+
+  /* Write out everything & stop writer thread */
+  void close();
+
+private:
+  struct Chunk {
+    std::vector<Byte> data{};
+    std::size_t size{};
+    bool isLast{};
+  };
+
+  void putSync();
+  void ensureSpace() {
+    if (static_cast<std::size_t>(end_ - cur_) < trace::kMaxRecordSize)
+        [[unlikely]]
+      nextChunk(false);
+  }
+  void putByte(Byte byte) { *cur_++ = byte; }
+  void putVarint(DWord val) {
+    for (; val >= 0x80; val >>= 7)
+      putByte(static_cast<Byte>(val | 0x80));
+    putByte(static_cast<Byte>(val));
+  }
+
+  void nextChunk(bool isLast);
+  void writerLoop();
+
+  std::ofstream out_;
+  std::size_t chunkSize_{};
+  SPSCRingBuffer<Chunk> ring_;
+  Chunk *chunk_{};
+  Byte *cur_{};
+  Byte *end_{};
+
+  std::array<RegVal, kRegNum> lastRegs_{};
+  std::uint64_t instrNum_{};
+  Addr lastPC_{};
+  Addr lastMemAddr_{};
+
+  std::atomic<bool> writeFailed_{false};
+  bool isClosed_{false};
+  std::thread writer_{};
+};
+
+struct TraceRecord final {
+  trace::RecordType type{};
+  // Number of instruction the record belongs to
+  std::uint64_t instrNum{};
+  // INSN: pc after instruction, SYNC: pc of the next instruction
+  Addr pc{};
+  Byte flags{};
+  RegId reg{};
+  Addr addr{};
+  Word value{};
+};
+
+/**
+ * @brief Binary trace decoder
+ * @note INSN_SEQ records are reported as INSN
+ */
+class TraceReader final {
+public:
+  /* Map trace file to memory */
+  explicit TraceReader(const fs::path &file);
+  /* Decode trace from memory, data has to outlive reader */
+  explicit TraceReader(std::span<const Byte> data);
+
+  /**
+   * @brief Decode next record
+   *
+   * @param[out] rec decoded record
+   * @return false at the end of trace
+   */
+  bool next(TraceRecord &rec);
+
+  /* Offset of the next record in trace data */
+  [[nodiscard]] std::size_t getOffset() const { return offset_; }
+
+  /* Offsets of all frames in trace data */
+  [[nodiscard]] std::vector<std::size_t> getFrameOffsets() const;
+  /* Continue decoding from the frame at offset */
+  void seekFrame(std::size_t offset);
+
+private:
+  void parseHeader();
+  [[nodiscard]] trace::FrameSize getFrameSize(std::size_t offset) const;
+  Byte getByte();
+  DWord getVarint();
+
+  std::shared_ptr<const void> mapping_{};
+  std::span<const Byte> data_{};
+  std::size_t offset_{};
+  std::size_t frameEnd_{};
+
+  std::array<RegVal, kRegNum> lastRegs_{};
+  std::uint64_t instrNum_{};
+  Addr lastPC_{};
+  Addr lastMemAddr_{};
+};
+
+} // namespace sim
+
+#endif // __INCLUDE_TRACE_TRACE_HH__
@@ -0,0 +1,339 @@
+#include <fstream>
+#include <stdexcept>
+
+#include <elfio/elfio.hpp>
+#include <fmt/format.h>
+
+#include "assembler/assembler.hh"
+#include "decoder/encoder.hh"
+
+namespace sim {
+
+namespace {
+
+/* Upper part of value for lui, so that addi w/ the lower part restores it */
+constexpr Word getHi20(Word val) {
+  return (val + (Word{1} << 11)) & ~((Word{1} << 12) - 1);
+}
+
+constexpr Word getLo12(Word val) { return signExtend<12>(val); }
+
+/* True if offset is even & fits signed immediate of numBits */
+template <std::size_t numBits> constexpr bool isJumpOffset(Word offset) {
+  return getBits<0, 0>(offset) == 0 && signExtend<numBits>(offset) == offset;
+}
+
+ELFIO::section *addSection(ELFIO::elfio &writer, const std::string &name,
+                           ELFIO::Elf_Xword flags, Addr addr,
+                           std::span<const Word> words) {
+  auto *section = writer.sections.add(name);
+  section->set_type(ELFIO::SHT_PROGBITS);
+  section->set_flags(flags);
+  section->set_addr_align(kXLENInBytes);
+  section->set_address(addr);
+  section->set_data(reinterpret_cast<const char *>(words.data()),
+                    static_cast<ELFIO::Elf_Word>(words.size_bytes()));
+  return section;
+}
+
+ELFIO::segment *addSegment(ELFIO::elfio &writer, ELFIO::Elf_Word flags,
+                           Addr addr) {
+  constexpr ELFIO::Elf_Xword kSegmentAlign = 0x1000;
+
+  auto *segment = writer.segments.add();
+  segment->set_type(ELFIO::PT_LOAD);
+  segment->set_virtual_address(addr);
+  segment->set_physical_address(addr);
+  segment->set_flags(flags);
+  segment->set_align(kSegmentAlign);
+  return segment;
+}
+
+} // namespace
+
+//~~~~~Assembler class functions~~~~~
+
+Assembler::Assembler(Addr textBase, Addr dataBase)
+    : textBase_(textBase), dataBase_(dataBase) {
+  if (textBase_ % kXLENInBytes != 0 || dataBase_ % kXLENInBytes != 0)
+    throw std::invalid_argument{"Segment bases have to be word aligned"};
+}
+
+Assembler::Label Assembler::newLabel() {
+  return newLabel(Segment::UNBOUND, 0);
+}
+
+Assembler::Label Assembler::newLabel(Segment segment, std::size_t offset) {
+  labels_.push_back({segment, offset});
+  return Label{labels_.size() - 1};
+}
+
+void Assembler::bind(Label label) {
+  auto &pos = labels_.at(label.id);
+  if (pos.segment != Segment::UNBOUND)
+    throw std::logic_error{"Label is already bound"};
+  pos = {Segment::TEXT, text_.size()};
+}
+
+Addr Assembler::getAddr(Label label) const {
+  const auto &pos = labels_.at(label.id);
+  switch (pos.segment) {
+  case Segment::TEXT:
+    return textBase_ + static_cast<Addr>(pos.offset * kXLENInBytes);
+  case Segment::DATA:
+    return dataBase_ + static_cast<Addr>(pos.offset);
+  case Segment::BSS:
+    return getBSSBase() + static_cast<Addr>(pos.offset);
+  case Segment::UNBOUND:
+  default:
+    throw std::logic_error{"Reference to unbound label"};
+  }
+}
+
+void Assembler::beginFunction(const std::string &name) {
+  if (isInFunction_)
+    throw std::logic_error{"Function " + symbols_.back().name +
+                           " is not ended"};
+  symbols_.push_back({name, text_.size(), text_.size()});
+  isInFunction_ = true;
+}
+
+void Assembler::endFunction() {
+  if (!isInFunction_)
+    throw std::logic_error{"No function to end"};
+  symbols_.back().end = text_.size();
+  isInFunction_ = false;
+}
+
+void Assembler::emit(const Instruction &inst) { text_.push_back(inst); }
+
+void Assembler::rType(OpType type, RegId rd, RegId rs1, RegId rs2) {
+  Instruction inst{};
+  inst.type = type;
+  inst.rd = rd;
+  inst.rs1 = rs1;
+  inst.rs2 = rs2;
+  emit(inst);
+}
+
+void Assembler::iType(OpType type, RegId rd, RegId rs1, Word imm) {
+  Instruction inst{};
+  inst.type = type;
+  inst.rd = rd;
+  inst.rs1 = rs1;
+  inst.imm = imm;
+  emit(inst);
+}
+
+void Assembler::store(OpType type, RegId src, RegId base, Word offset) {
+  Instruction inst{};
+  inst.type = type;
+  inst.rs1 = base;
+  inst.rs2 = src;
+  inst.imm = offset;
+  emit(inst);
+}
+
+void Assembler::branch(OpType type, RegId rs1, RegId rs2, Label target) {
+  textRefs_.push_back({text_.size(), target, Fixup::BRANCH});
+  Instruction inst{};
+  inst.type = type;
+  inst.rs1 = rs1;
+  inst.rs2 = rs2;
+  emit(inst);
+}
+
+void Assembler::lui(RegId rd, Word imm) {
+  Instruction inst{};
+  inst.type = OpType::LUI;
+  inst.rd = rd;
+  inst.imm = imm;
+  emit(inst);
+}
+
+void Assembler::jal(RegId rd, Label target) {
+  textRefs_.push_back({text_.size(), target, Fixup::JAL});
+  Instruction inst{};
+  inst.type = OpType::JAL;
+  inst.rd = rd;
+  emit(inst);
+}
+
+void Assembler::jalr(RegId rd, RegId rs1, Word offset) {
+  iType(OpType::JALR, rd, rs1, offset);
+}
+
+void Assembler::ecall() {
+  Instruction inst{};
+  inst.type = OpType::ECALL;
+  emit(inst);
+}
+
+void Assembler::li(RegId rd, Word val) {
+  auto lo = getLo12(val);
+  if (lo == val) {
+    iType(OpType::ADDI, rd, reg::ZERO, val);
+    return;
+  }
+
+  lui(rd, getHi20(val));
+  if (lo != 0)
+    iType(OpType::ADDI, rd, rd, lo);
+}
+
+void Assembler::la(RegId rd, Label label) {
+  textRefs_.push_back({text_.size(), label, Fixup::HI20});
+  lui(rd, 0);
+  textRefs_.push_back({text_.size(), label, Fixup::LO12});
+  iType(OpType::ADDI, rd, rd, 0);
+}
+
+Assembler::Label Assembler::dataWords(std::span<const Word> words) {
+  auto label = newLabel(Segment::DATA, data_.size() * kXLENInBytes);
+  data_.insert(data_.end(), words.begin(), words.end());
+  return label;
+}
+
+Assembler::Label Assembler::dataAddrs(std::span<const Label> labels) {
+  auto label = newLabel(Segment::DATA, data_.size() * kXLENInBytes);
+  for (auto target : labels) {
+    dataRefs_.push_back({data_.size(), target});
+    data_.push_back(0);
+  }
+  return label;
+}
+
+Assembler::Label Assembler::bss(std::size_t size) {
+  auto label = newLabel(Segment::BSS, bssSize_);
+  bssSize_ += (size + kXLENInBytes - 1) / kXLENInBytes * kXLENInBytes;
+  return label;
+}
+
+std::vector<Word> Assembler::assemble() const {
+  auto textEnd = static_cast<std::uint64_t>(textBase_) +
+                 text_.size() * std::uint64_t{kXLENInBytes};
+  if (textBase_ < dataBase_ && textEnd > dataBase_)
+    throw std::runtime_error{
+        fmt::format("Text [{:#x}, {:#x}) overlaps data at {:#x}", textBase_,
+                    textEnd, dataBase_)};
+
+  auto text = text_;
+  for (const auto &ref : textRefs_) {
+    auto &inst = text[ref.index];
+    auto pc = textBase_ + static_cast<Addr>(ref.index * kXLENInBytes);
+    auto addr = getAddr(ref.label);
+    auto offset = addr - pc;
+
+    switch (ref.fixup) {
+    case Fixup::BRANCH:
+      if (!isJumpOffset<13>(offset))
+        throw std::runtime_error{fmt::format(
+            "Branch at {:#x} can not reach {:#x}", pc, addr)};
+      inst.imm = offset;
+      break;
+    case Fixup::JAL:
+      if (!isJumpOffset<21>(offset))
+        throw std::runtime_error{
+            fmt::format("Jump at {:#x} can not reach {:#x}", pc, addr)};
+      inst.imm = offset;
+      break;
+    case Fixup::HI20:
+      inst.imm = getHi20(addr);
+      break;
+    case Fixup::LO12:
+      inst.imm = getLo12(addr);
+      break;
+    default:
+      break;
+    }
+  }
+
+  std::vector<Word> res{};
+  res.reserve(text.size());
+  for (const auto &inst : text)
+    res.push_back(Encoder::encode(inst));
+  return res;
+}
+
+std::vector<Word> Assembler::resolveData() const {
+  auto data = data_;
+  for (const auto &ref : dataRefs_)
+    data[ref.index] = getAddr(ref.label);
+  return data;
+}
+
+void Assembler::write(std::ostream &ost) const {
+  if (isInFunction_)
+    throw std::logic_error{"Function " + symbols_.back().name +
+                           " is not ended"};
+
+  auto text = assemble();
+  auto data = resolveData();
+
+  ELFIO::elfio writer{};
+  writer.create(ELFIO::ELFCLASS32, ELFIO::ELFDATA2LSB);
+  writer.set_os_abi(ELFIO::ELFOSABI_NONE);
+  writer.set_type(ELFIO::ET_EXEC);
+  writer.set_machine(ELFIO::EM_RISCV);
+  writer.set_entry(entry_ ? getAddr(*entry_) : textBase_);
+
+  auto *textSec = addSection(writer, ".text",
+                             ELFIO::SHF_ALLOC | ELFIO::SHF_EXECINSTR,
+                             textBase_, text);
+  auto *textSeg = addSegment(writer, ELFIO::PF_R | ELFIO::PF_X, textBase_);
+  textSeg->add_section(textSec, textSec->get_addr_align());
+
+  if (!data.empty() || bssSize_ != 0) {
+    auto *dataSeg = addSegment(writer, ELFIO::PF_R | ELFIO::PF_W, dataBase_);
+    if (!data.empty()) {
+      auto *dataSec = addSection(writer, ".data",
+                                 ELFIO::SHF_ALLOC | ELFIO::SHF_WRITE,
+                                 dataBase_, data);
+      dataSeg->add_section(dataSec, dataSec->get_addr_align());
+    }
+    if (bssSize_ != 0) {
+      auto *bssSec = writer.sections.add(".bss");
+      bssSec->set_type(ELFIO::SHT_NOBITS);
+      bssSec->set_flags(ELFIO::SHF_ALLOC | ELFIO::SHF_WRITE);
+      bssSec->set_addr_align(kXLENInBytes);
+      bssSec->set_address(getBSSBase());
+      bssSec->set_size(bssSize_);
+      dataSeg->add_section(bssSec, bssSec->get_addr_align());
+    }
+  }
+
+  if (!symbols_.empty()) {
+    auto *strSec = writer.sections.add(".strtab");
+    strSec->set_type(ELFIO::SHT_STRTAB);
+    ELFIO::string_section_accessor strings{strSec};
+
+    auto *symSec = writer.sections.add(".symtab");
+    symSec->set_type(ELFIO::SHT_SYMTAB);
+    symSec->set_info(1);
+    symSec->set_addr_align(kXLENInBytes);
+    symSec->set_entry_size(writer.get_default_entry_size(ELFIO::SHT_SYMTAB));
+    symSec->set_link(strSec->get_index());
+
+    ELFIO::symbol_section_accessor symbols{writer, symSec};
+    for (const auto &sym : symbols_)
+      symbols.add_symbol(
+          strings, sym.name.c_str(),
+          textBase_ + static_cast<Addr>(sym.begin * kXLENInBytes),
+          static_cast<Addr>((sym.end - sym.begin) * kXLENInBytes),
+          ELFIO::STB_GLOBAL, ELFIO::STT_FUNC, 0, textSec->get_index());
+  }
+
+  if (!writer.save(ost))
+    throw std::runtime_error{"Failed to write executable"};
+}
+
+void Assembler::write(const fs::path &file) const {
+  std::ofstream ost{file, std::ios::binary};
+  if (!ost)
+    throw std::runtime_error{"Failed to open " + file.string()};
+  write(ost);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
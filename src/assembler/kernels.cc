@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "assembler/kernels.hh"
+
+namespace sim {
+
+namespace {
+
+using Label = Assembler::Label;
+
+constexpr Word kMinusOne = ~Word{};
+/* Reach of conditional branches backwards */
+constexpr Addr kBranchReach = Addr{1} << 12;
+/* Stack frame of call chain functions, keeps sp 16-byte aligned */
+constexpr Word kFrameSize = 16;
+
+bool canBranchBack(const Assembler &as, Label target) {
+  return as.getPC() - as.getAddr(target) <= kBranchReach;
+}
+
+/* Decrement counter & branch back to head while it is non-zero */
+void loopBack(Assembler &as, RegId counter, Label head) {
+  as.iType(OpType::ADDI, counter, counter, kMinusOne);
+  if (canBranchBack(as, head)) {
+    as.branch(OpType::BNE, counter, reg::ZERO, head);
+    return;
+  }
+
+  auto exit = as.newLabel();
+  as.branch(OpType::BEQ, counter, reg::ZERO, exit);
+  as.j(head);
+  as.bind(exit);
+}
+
+/* Jump to already bound label if counter is zero */
+void exitIfZero(Assembler &as, RegId counter, Label done) {
+  if (canBranchBack(as, done)) {
+    as.branch(OpType::BEQ, counter, reg::ZERO, done);
+    return;
+  }
+
+  auto next = as.newLabel();
+  as.branch(OpType::BNE, counter, reg::ZERO, next);
+  as.j(done);
+  as.bind(next);
+}
+
+Instruction makeALU(OpType type, RegId rd, RegId rs1, RegId rs2, Word imm) {
+  Instruction inst{};
+  inst.type = type;
+  inst.rd = rd;
+  inst.rs1 = rs1;
+  inst.rs2 = rs2;
+  inst.imm = imm;
+  return inst;
+}
+
+void genStraightLine(Assembler &as, const KernelParams &params) {
+  using namespace reg;
+  // Mix of register-register & register-immediate operations
+  static const std::array kOps{
+      makeALU(OpType::ADD, T0, T0, T1, 0),
+      makeALU(OpType::XOR, T1, T1, T2, 0),
+      makeALU(OpType::ADDI, T2, T2, 0, 3),
+      makeALU(OpType::SUB, T3, T3, T0, 0),
+      makeALU(OpType::ORI, T4, T3, 0, 0x55),
+      makeALU(OpType::SLLI, T5, T4, 0, 1),
+      makeALU(OpType::ANDI, T6, T5, 0, 0x7f),
+      makeALU(OpType::SRLI, T0, T0, 0, 1),
+      makeALU(OpType::SLTI, T1, T6, 0, 9),
+      makeALU(OpType::XORI, T2, T2, 0, 5),
+  };
+
+  as.li(S0, params.iterations);
+  auto head = as.here();
+  for (std::uint32_t i = 0; i < params.size; ++i)
+    as.emit(kOps[i % kOps.size()]);
+  as.iType(OpType::ADDI, A0, A0, 1);
+  loopBack(as, S0, head);
+  as.ecall();
+}
+
+void genLoop(Assembler &as, const KernelParams &params) {
+  using namespace reg;
+  as.li(S0, params.iterations);
+  auto outer = as.here();
+  as.li(T0, params.size);
+  auto inner = as.here();
+  as.iType(OpType::ADDI, A0, A0, 1);
+  loopBack(as, T0, inner);
+  loopBack(as, S0, outer);
+  as.ecall();
+}
+
+void genCallChain(Assembler &as, const KernelParams &params) {
+  using namespace reg;
+  std::vector<Label> funcs{};
+  for (std::uint32_t i = 0; i < params.size; ++i)
+    funcs.push_back(as.newLabel());
+  auto stackSize = (params.size + 1) * kFrameSize;
+  auto stack = as.bss(stackSize);
+
+  as.beginFunction("main");
+  as.la(SP, stack);
+  as.li(T0, stackSize);
+  as.rType(OpType::ADD, SP, SP, T0);
+  as.li(S0, params.iterations);
+  auto head = as.here();
+  as.call(funcs.front());
+  loopBack(as, S0, head);
+  as.ecall();
+  as.endFunction();
+
+  for (std::size_t i = 0; i < funcs.size(); ++i) {
+    as.bind(funcs[i]);
+    as.beginFunction(fmt::format("func{}", i));
+    as.iType(OpType::ADDI, A0, A0, 1);
+    if (i + 1 < funcs.size()) {
+      as.iType(OpType::ADDI, SP, SP, Word{0} - kFrameSize);
+      as.store(OpType::SW, RA, SP, kFrameSize - kXLENInBytes);
+      as.call(funcs[i + 1]);
+      as.load(OpType::LW, RA, SP, kFrameSize - kXLENInBytes);
+      as.iType(OpType::ADDI, SP, SP, kFrameSize);
+    }
+    as.ret();
+    as.endFunction();
+  }
+}
+
+void genIndirectMaze(Assembler &as, const KernelParams &params) {
+  using namespace reg;
+  constexpr Word kSeed = 0x12345678;
+
+  std::vector<Label> blocks{};
+  for (std::uint32_t i = 0; i < params.size; ++i)
+    blocks.push_back(as.newLabel());
+  // Power of 2 entries to index table by upper bits of random state
+  auto numEntries = std::max(std::bit_ceil(blocks.size()), std::size_t{2});
+  auto indexShift = static_cast<Word>(sizeofBits<Word>()) -
+                    static_cast<Word>(std::countr_zero(numEntries));
+  std::vector<Label> entries{};
+  for (std::size_t i = 0; i < numEntries; ++i)
+    entries.push_back(blocks[i % blocks.size()]);
+  auto table = as.dataAddrs(entries);
+
+  as.li(S0, params.iterations);
+  as.li(S1, kSeed);
+  as.la(S2, table);
+  as.j(blocks.front());
+  auto done = as.here();
+  as.ecall();
+
+  for (auto block : blocks) {
+    as.bind(block);
+    as.iType(OpType::ADDI, A0, A0, 1);
+    // xorshift32 state in s1
+    for (auto [shiftType, shift] : {std::pair{OpType::SLLI, 13},
+                                    std::pair{OpType::SRLI, 17},
+                                    std::pair{OpType::SLLI, 5}}) {
+      as.iType(shiftType, T0, S1, static_cast<Word>(shift));
+      as.rType(OpType::XOR, S1, S1, T0);
+    }
+    as.iType(OpType::SRLI, T0, S1, indexShift);
+    as.iType(OpType::SLLI, T0, T0, 2);
+    as.rType(OpType::ADD, T0, T0, S2);
+    as.load(OpType::LW, T0, T0, 0);
+    as.iType(OpType::ADDI, S0, S0, kMinusOne);
+    exitIfZero(as, S0, done);
+    as.jalr(ZERO, T0, 0);
+  }
+}
+
+void genMemStride(Assembler &as, const KernelParams &params) {
+  using namespace reg;
+  constexpr std::uint64_t kMaxArraySize = std::uint64_t{1} << 30;
+
+  if (params.stride == 0 || params.stride % kXLENInBytes != 0)
+    throw std::invalid_argument{
+        fmt::format("Stride {} is not a multiple of word", params.stride)};
+  auto arraySize = std::uint64_t{params.size} * params.stride;
+  if (arraySize > kMaxArraySize)
+    throw std::invalid_argument{
+        fmt::format("Array of {} bytes is too large", arraySize)};
+  auto array = as.bss(arraySize);
+
+  as.la(S1, array);
+  as.li(S2, params.stride);
+  as.li(S0, params.iterations);
+  auto outer = as.here();
+  as.mv(T0, S1);
+  as.li(T1, params.size);
+  auto inner = as.here();
+  as.load(OpType::LW, T2, T0, 0);
+  as.iType(OpType::ADDI, T2, T2, 1);
+  as.store(OpType::SW, T2, T0, 0);
+  as.rType(OpType::ADD, T0, T0, S2);
+  as.iType(OpType::ADDI, A0, A0, 1);
+  loopBack(as, T1, inner);
+  loopBack(as, S0, outer);
+  as.ecall();
+}
+
+} // namespace
+
+void generateKernel(Assembler &as, Kernel kernel, const KernelParams &params) {
+  if (params.iterations == 0 || params.size == 0)
+    throw std::invalid_argument{"Kernel iterations & size must be non-zero"};
+
+  switch (kernel) {
+  case Kernel::STRAIGHT_LINE:
+    genStraightLine(as, params);
+    break;
+  case Kernel::LOOP:
+    genLoop(as, params);
+    break;
+  case Kernel::CALL_CHAIN:
+    genCallChain(as, params);
+    break;
+  case Kernel::INDIRECT_MAZE:
+    genIndirectMaze(as, params);
+    break;
+  case Kernel::MEM_STRIDE:
+    genMemStride(as, params);
+    break;
+  default:
+    throw std::invalid_argument{"Unknown kernel"};
+  }
+}
+
+} // namespace sim
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/host_perf.hh"
+
+namespace sim {
+
+namespace {
+
+struct EventConfig final {
+  std::uint32_t type{};
+  std::uint64_t config{};
+  const char *name{};
+};
+
+constexpr std::array<EventConfig, HostPerf::kNumEvents> kEvents{{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch-misses"},
+    {PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+     "L1D-misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "LLC-misses"},
+}};
+
+int openEvent(const EventConfig &event) {
+  perf_event_attr attr{};
+  attr.type = event.type;
+  attr.size = sizeof(attr);
+  attr.config = event.config;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // Allowed w/ default perf_event_paranoid
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1,
+                                  PERF_FLAG_FD_CLOEXEC));
+}
+
+std::string formatRatio(std::uint64_t num, std::uint64_t denom) {
+  if (denom == 0)
+    return "n/a";
+  return fmt::format("{:.3f}",
+                     static_cast<double>(num) / static_cast<double>(denom));
+}
+
+} // namespace
+
+//~~~~~HostPerf class functions~~~~~
+
+HostPerf::HostPerf() {
+  for (std::size_t i = 0; i < kNumEvents; ++i) {
+    fds_[i] = openEvent(kEvents[i]);
+    if (fds_[i] < 0 && error_.empty())
+      error_ = fmt::format("{}: {}", kEvents[i].name, std::strerror(errno));
+  }
+}
+
+HostPerf::~HostPerf() {
+  for (auto fd : fds_)
+    if (fd >= 0)
+      close(fd);
+}
+
+bool HostPerf::isAvailable() const {
+  for (std::size_t i = 0; i < kNumEvents; ++i)
+    if (isAvailable(static_cast<Event>(i)))
+      return true;
+  return false;
+}
+
+HostPerf::Values HostPerf::read() const {
+  Values res{};
+  for (std::size_t i = 0; i < kNumEvents; ++i) {
+    if (fds_[i] < 0)
+      continue;
+    // value, time enabled, time running
+    std::array<std::uint64_t, 3> buf{};
+    if (::read(fds_[i], buf.data(), sizeof(buf)) !=
+        static_cast<ssize_t>(sizeof(buf)))
+      continue;
+    auto [value, enabled, running] = buf;
+    // Counter shared the PMU w/ others for part of the time
+    if (running != 0 && running < enabled)
+      value = static_cast<std::uint64_t>(static_cast<double>(value) *
+                                         static_cast<double>(enabled) /
+                                         static_cast<double>(running));
+    res[i] = value;
+  }
+  return res;
+}
+
+void HostPerf::print(std::ostream &ost, std::uint64_t numGuestInstrs) const {
+  if (!isAvailable()) {
+    ost << "Host counters are unavailable (" << error_ << ")\n";
+    return;
+  }
+
+  const auto &run = totals_[RUN];
+  const auto &decode = totals_[DECODE];
+  ost << fmt::format("{:<16}{:>16}{:>16}{:>16}{:>16}\n", "Host counters",
+                     "load", "run", "decode", "execute");
+  for (std::size_t i = 0; i < kNumEvents; ++i) {
+    if (fds_[i] < 0) {
+      ost << fmt::format("  {:<14}{:>16}{:>16}{:>16}{:>16}\n", kEvents[i].name,
+                         "n/a", "n/a", "n/a", "n/a");
+      continue;
+    }
+    ost << fmt::format("  {:<14}{:>16}{:>16}{:>16}{:>16}\n", kEvents[i].name,
+                       totals_[LOAD][i], run[i], decode[i],
+                       run[i] - std::min(run[i], decode[i]));
+  }
+
+  if (isAvailable(CYCLES))
+    ost << "Host cycles per guest instruction: "
+        << formatRatio(run[CYCLES], numGuestInstrs) << '\n';
+  if (isAvailable(BRANCH_MISSES))
+    ost << "Host branch misses per guest block: "
+        << formatRatio(run[BRANCH_MISSES], numBlocks_) << '\n';
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "common/stats.hh"
+
+namespace sim {
+
+//~~~~~StatsRegistry class functions~~~~~
+
+bool StatsRegistry::isEnabled(std::string_view group) const {
+  return enabledGroups_.empty() ||
+         std::find(enabledGroups_.begin(), enabledGroups_.end(), group) !=
+             enabledGroups_.end();
+}
+
+void StatsRegistry::addCounter(std::string_view group, std::string_view name,
+                               std::function<std::uint64_t()> get) {
+  if (!isEnabled(group))
+    return;
+  stats_.push_back({fmt::format("{}.{}", group, name), 0,
+                    [get = std::move(get)](std::span<std::uint64_t> out) {
+                      out[0] = get();
+                    }});
+}
+
+void StatsRegistry::addHistogram(
+    std::string_view group, std::string_view name, std::size_t numBuckets,
+    std::function<std::vector<std::uint64_t>()> get) {
+  if (!isEnabled(group))
+    return;
+  if (numBuckets == 0)
+    throw std::invalid_argument{"Histogram has to have buckets"};
+
+  stats_.push_back({fmt::format("{}.{}", group, name), numBuckets,
+                    [get = std::move(get)](std::span<std::uint64_t> out) {
+                      auto values = get();
+                      if (values.size() != out.size())
+                        throw std::logic_error{"Bad histogram size"};
+                      std::copy(values.begin(), values.end(), out.begin());
+                    }});
+}
+
+//~~~~~StatsWriter class functions~~~~~
+
+StatsWriter::StatsWriter(const StatsRegistry &registry, std::ostream &ost,
+                         Format format)
+    : registry_(registry), ost_(ost), format_(format) {
+  if (format_ == Format::JSON) {
+    ost_ << "[";
+    return;
+  }
+
+  ost_ << "instructions";
+  for (const auto &stat : registry_.getStats()) {
+    if (stat.numBuckets == 0) {
+      ost_ << ',' << stat.name;
+      continue;
+    }
+    for (std::size_t i = 0; i < stat.numBuckets; ++i)
+      ost_ << ',' << stat.name << '[' << i << ']';
+  }
+  ost_ << '\n';
+}
+
+void StatsWriter::dump(std::uint64_t numInstrs) {
+  const auto &stats = registry_.getStats();
+  if (format_ == Format::CSV) {
+    ost_ << numInstrs;
+    for (const auto &stat : stats) {
+      values_.resize(std::max<std::size_t>(stat.numBuckets, 1));
+      stat.read(values_);
+      for (auto val : values_)
+        ost_ << ',' << val;
+    }
+    ost_ << '\n';
+    ++numDumps_;
+    return;
+  }
+
+  ost_ << (numDumps_ ? ",\n" : "\n") << "  {\"instructions\": " << numInstrs;
+  for (const auto &stat : stats) {
+    values_.resize(std::max<std::size_t>(stat.numBuckets, 1));
+    stat.read(values_);
+    ost_ << ", \"" << stat.name << "\": ";
+    if (stat.numBuckets == 0) {
+      ost_ << values_[0];
+      continue;
+    }
+    ost_ << fmt::format("[{}]", fmt::join(values_, ", "));
+  }
+  ost_ << '}';
+  ++numDumps_;
+}
+
+void StatsWriter::finish() {
+  if (format_ == Format::JSON)
+    ost_ << "\n]\n";
+  ost_.flush();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,58 @@
+#include <fmt/format.h>
+
+#include "common/timer.hh"
+
+namespace timer {
+
+namespace {
+
+/* Reference point to convert ticks to time */
+const auto kStartTime = std::chrono::steady_clock::now();
+const auto kStartTicks = readTSC();
+
+double getTicksPerMcs() {
+  auto ticks = readTSC() - kStartTicks;
+  auto mcs = std::chrono::duration<double, std::micro>(
+                 std::chrono::steady_clock::now() - kStartTime)
+                 .count();
+  return mcs > 0.0 ? static_cast<double>(ticks) / mcs : 0.0;
+}
+
+} // namespace
+
+SectionTimes getSectionTimes() {
+  SectionTimes res{};
+  {
+    std::lock_guard lock{detail::finishedMutex};
+    res = detail::finishedTimes;
+  }
+  res += detail::threadTimes.times;
+  return res;
+}
+
+void printSectionTimes(std::ostream &ost) {
+  constexpr std::array<const char *, kNumSections> kNames{
+      "decode", "bb cache", "execute", "page table"};
+
+  auto times = getSectionTimes();
+  std::uint64_t totalTicks{};
+  for (auto ticks : times.ticks)
+    totalTicks += ticks;
+  auto ticksPerMcs = getTicksPerMcs();
+
+  ost << fmt::format("{:<14}{:>14}{:>16}{:>12}{:>9}\n", "Self-profile",
+                     "calls", "ticks", "ms", "share");
+  for (std::size_t i = 0; i < kNumSections; ++i) {
+    auto ticks = times.ticks[i];
+    auto ms = ticksPerMcs > 0.0 ? static_cast<double>(ticks) / ticksPerMcs /
+                                      1000.0
+                                : 0.0;
+    auto share = totalTicks ? 100.0 * static_cast<double>(ticks) /
+                                  static_cast<double>(totalTicks)
+                            : 0.0;
+    ost << fmt::format("  {:<12}{:>14}{:>16}{:>12.3f}{:>8.2f}%\n", kNames[i],
+                       times.counts[i], ticks, ms, share);
+  }
+}
+
+} // namespace timer
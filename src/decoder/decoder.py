@@ -1,4 +1,4 @@
-"""This module generates enum w/ opcodes & decoder function."""
+"""This module generates enum w/ opcodes, decoder & encoder functions."""
 
 import argparse
 import sys
@@ -53,6 +53,34 @@ FUNC_HEADER = textwrap.dedent(
 
 FUNC_FOOTER = END_NAMESPACE
 
+ENC_INCLUDES = textwrap.dedent(
+    """
+    #include <stdexcept>
+
+    #include "decoder/encoder.hh"
+
+    """
+)
+
+ENC_FUNC_HEADER = textwrap.dedent(
+    """
+    Word Encoder::encode(const Instruction &inst) {
+        Word res{};
+        switch (inst.type) {
+    """
+)
+
+ENC_FUNC_FOOTER = textwrap.dedent(
+    """
+        case OpType::UNKNOWN:
+        default:
+            break;
+        }
+        throw std::runtime_error{"Unable to encode instruction of unknown type"};
+    }
+    """
+)
+
 BitDict = dict[str, bool | int]
 InstDict = dict[str, list[str] | str]
 RiscVDict = dict[str, InstDict]
@@ -88,6 +116,16 @@ def gen_getbits(bit_dict: BitDict, arg: str):
     return to_ret
 
 
+def gen_putbits(bit_dict: BitDict, arg: str):
+    """Helper function to generate inverse of gen_getbits(): bits of the value
+    are placed to their position in instruction"""
+
+    return (
+        f"getBits<{bit_dict['from']}, {bit_dict['lshift']}>({arg}) "
+        f"<< Word({bit_dict['lsb']})"
+    )
+
+
 BRANCH_MNEMONICS = (
     "beq",
     "bne",
@@ -98,6 +136,8 @@ BRANCH_MNEMONICS = (
     "jal",
     "jalr",
     "ecall",
+    "sret",
+    "sfence_vma",
 )
 
 REG_DICT = {
@@ -292,6 +332,50 @@ def gen_maps(yaml_dict: RiscVDict) -> str:
     return "\n".join(maps_defs.values()) + map_finds
 
 
+def gen_encode_inst(
+    dec_data: InstDict, inst_name: str, inst_var_name: str = "inst"
+) -> str:
+    """Generate instruction's fields encoding"""
+    matched = dec_data["match"]
+    assert isinstance(matched, str)
+
+    to_ret = f"case OpType::{inst_name.upper()}:\n"
+    to_ret += f"res = 0b{int(matched, 0):032b};\n"
+
+    for field_name in dec_data["variable_fields"]:
+        if field_name in REG_DICT:
+            reg = f"Word({inst_var_name}.{field_name})"
+            to_ret += f"res |= {gen_putbits(REG_DICT[field_name], reg)};\n"
+
+        elif field_name in IMM_DICT:
+            for bits_dict in IMM_DICT[field_name]:
+                to_ret += (
+                    f"res |= {gen_putbits(bits_dict, f'{inst_var_name}.imm')};\n"
+                )
+
+        else:
+            raise ValueError(f"Unrecognized field name {field_name}")
+
+    to_ret += "return res;\n"
+    return to_ret
+
+
+def gen_encoder(filename: Path, yaml_dict: RiscVDict) -> None:
+    """Function to generate encoder function c++ file"""
+
+    to_write = COMMENT
+    to_write += ENC_INCLUDES
+    to_write += START_NAMESPACE
+    to_write += ENC_FUNC_HEADER
+    for inst_name, dec_data in yaml_dict.items():
+        to_write += gen_encode_inst(dec_data, inst_name)
+    to_write += ENC_FUNC_FOOTER
+    to_write += END_NAMESPACE
+
+    with open(filename, "w", encoding="utf-8") as fout:
+        fout.write(to_write)
+
+
 GenFunc = Callable[[RiscVDict], str]
 
 
@@ -393,6 +477,13 @@ def main() -> None:
         help="Output .ii file for OpType map definition",
     )
 
+    parser.add_argument(
+        "-n",
+        "--encoder-file",
+        type=Path,
+        help="Output .cc file for encoder function",
+    )
+
     parser.add_argument(
         "-g",
         "--generator",
@@ -414,6 +505,9 @@ def main() -> None:
     # generate enum & decoder files
     gen_cc(args.decoder_file, yaml_data, GENERATORS[args.generator])
     gen_enum(args.enum_file, args.map_file, yaml_data)
+    if args.encoder_file is not None:
+        args.encoder_file.parent.mkdir(parents=True, exist_ok=True)
+        gen_encoder(args.encoder_file, yaml_data)
 
 
 if "__main__" == __name__:
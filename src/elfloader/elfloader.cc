@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <stdexcept>
 
+#include <fmt/format.h>
+
 #include "common/common.hh"
 #include "elfloader/elfloader.hh"
 
@@ -54,10 +57,47 @@ Addr ELFLoader::getSegmentAddr(IndexT index) const {
   return static_cast<Addr>(segment->get_virtual_address());
 }
 
+bool ELFLoader::isSegmentWritable(IndexT index) const {
+  auto *segment = getSegmentPtr(index);
+  return (segment->get_flags() & ELFIO::PF_W) != 0;
+}
+
 bool ELFLoader::hasSegment(IndexT index) const {
   return elfFile_.segments[index] != nullptr;
 }
 
+std::vector<ELFLoader::Symbol> ELFLoader::getFunctionSymbols() const {
+  std::vector<Symbol> res{};
+  for (auto &&section : elfFile_.sections) {
+    if (section->get_type() != ELFIO::SHT_SYMTAB)
+      continue;
+
+    ELFIO::const_symbol_section_accessor symbols{elfFile_, &*section};
+    for (ELFIO::Elf_Xword i = 0; i < symbols.get_symbols_num(); ++i) {
+      Symbol sym{};
+      ELFIO::Elf64_Addr value{};
+      ELFIO::Elf_Xword size{};
+      unsigned char bind{};
+      unsigned char type{};
+      ELFIO::Elf_Half sectionIdx{};
+      unsigned char other{};
+      symbols.get_symbol(i, sym.name, value, size, bind, type, sectionIdx,
+                         other);
+      if (type != ELFIO::STT_FUNC || sym.name.empty())
+        continue;
+
+      sym.addr = static_cast<Addr>(value);
+      sym.size = static_cast<Addr>(size);
+      res.push_back(std::move(sym));
+    }
+  }
+
+  std::sort(res.begin(), res.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.addr < rhs.addr;
+  });
+  return res;
+}
+
 void ELFLoader::check() const {
   if (auto diagnosis = elfFile_.validate(); !diagnosis.empty())
     throw std::runtime_error{diagnosis};
@@ -95,4 +135,26 @@ const ELFIO::segment *ELFLoader::getSegmentPtr(IndexT index) const {
   return segment;
 }
 
+const ELFLoader::Symbol *SymbolTable::find(Addr addr) const {
+  auto next = std::upper_bound(
+      symbols_.begin(), symbols_.end(), addr,
+      [](Addr val, const auto &sym) { return val < sym.addr; });
+  if (next == symbols_.begin())
+    return nullptr;
+
+  const auto &sym = *std::prev(next);
+  if (sym.size != 0 && addr - sym.addr >= sym.size)
+    return nullptr;
+  return &sym;
+}
+
+std::string SymbolTable::str(Addr addr) const {
+  const auto *sym = find(addr);
+  if (sym == nullptr)
+    return fmt::format("0x{:08x}", addr);
+  if (sym->addr == addr)
+    return sym->name;
+  return fmt::format("{}+0x{:x}", sym->name, addr - sym->addr);
+}
+
 } // namespace sim
@@ -1,4 +1,7 @@
 #include <algorithm>
+#include <atomic>
+#include <optional>
+#include <utility>
 
 #include "executor/executor.hh"
 
@@ -41,6 +44,38 @@ void executeCondBranch(const Instruction &inst, State &state, Func op) {
   }
 }
 
+static void writeCSR(State &state, CSRegId csr, RegVal val) {
+  state.csregs.set(csr, val);
+  if (csr == CSRegFile::SATP)
+    state.mem.setSatp(val);
+}
+
+/*
+  AMOs & LR/SC work on words in place, aq/rl bits are ignored: all of them
+  are sequentially consistent
+*/
+template <typename Op>
+void executeAMO(const Instruction &inst, State &state, Op op) {
+  auto rs1 = state.regs.get(inst.rs1);
+  auto rs2 = state.regs.get(inst.rs2);
+  auto old = state.mem.amoEntity(rs1, [&op, rs2](std::atomic_ref<Word> word) {
+    return op(word, rs2);
+  });
+  state.regs.set(inst.rd, old);
+}
+
+/* CAS loop storing the word or val, whichever is picked */
+template <std::predicate<Word, Word> Pred>
+std::pair<Word, Word> pickAMO(std::atomic_ref<Word> word, Word val,
+                              Pred isPicked) {
+  auto old = word.load();
+  Word res{};
+  do
+    res = isPicked(val, old) ? val : old;
+  while (!word.compare_exchange_weak(old, res));
+  return {old, res};
+}
+
 void executeADD(const Instruction &inst, State &state) {
   executeRegisterRegisterOp(inst, state, std::plus<RegVal>());
 }
@@ -73,6 +108,40 @@ void executeSW(const Instruction &inst, State &state) {
   state.mem.storeEntity<Word>(rs1 + inst.imm, rs2);
 }
 
+void executeLB(const Instruction &inst, State &state) {
+  auto rs1 = state.regs.get(inst.rs1);
+  auto byte = state.mem.loadEntity<Byte>(rs1 + inst.imm);
+  state.regs.set(inst.rd, signExtend<sizeofBits<Byte>()>(byte));
+}
+
+void executeLBU(const Instruction &inst, State &state) {
+  auto rs1 = state.regs.get(inst.rs1);
+  state.regs.set(inst.rd, state.mem.loadEntity<Byte>(rs1 + inst.imm));
+}
+
+void executeLH(const Instruction &inst, State &state) {
+  auto rs1 = state.regs.get(inst.rs1);
+  auto half = state.mem.loadEntity<Half>(rs1 + inst.imm);
+  state.regs.set(inst.rd, signExtend<sizeofBits<Half>()>(half));
+}
+
+void executeLHU(const Instruction &inst, State &state) {
+  auto rs1 = state.regs.get(inst.rs1);
+  state.regs.set(inst.rd, state.mem.loadEntity<Half>(rs1 + inst.imm));
+}
+
+void executeSB(const Instruction &inst, State &state) {
+  auto rs1 = state.regs.get(inst.rs1);
+  auto rs2 = state.regs.get(inst.rs2);
+  state.mem.storeEntity<Byte>(rs1 + inst.imm, static_cast<Byte>(rs2));
+}
+
+void executeSH(const Instruction &inst, State &state) {
+  auto rs1 = state.regs.get(inst.rs1);
+  auto rs2 = state.regs.get(inst.rs2);
+  state.mem.storeEntity<Half>(rs1 + inst.imm, static_cast<Half>(rs2));
+}
+
 void executeJAL(const Instruction &inst, State &state) {
   state.branchIsTaken = true;
   state.regs.set(inst.rd, state.pc + kXLENInBytes);
@@ -118,12 +187,13 @@ void executeSLTIU(const Instruction &inst, State &state) {
   state.regs.set(inst.rd, executeSLT(rs1, inst.imm));
 }
 
+/* Decoder places U-type immediate to upper 20 bits already */
 void executeLUI(const Instruction &inst, State &state) {
-  state.regs.set(inst.rd, inst.imm << 12);
+  state.regs.set(inst.rd, inst.imm);
 }
 
 void executeAUIPC(const Instruction &inst, State &state) {
-  state.regs.set(inst.rd, state.pc + (inst.imm << 12));
+  state.regs.set(inst.rd, state.pc + inst.imm);
 }
 
 void executeSLLI(const Instruction &inst, State &state) {
@@ -197,21 +267,21 @@ void executeXOR(const Instruction &inst, State &state) {
 void executeCSRRW(const Instruction &inst, State &state) {
   auto rs1 = state.regs.get(inst.rs1);
   auto csr = state.csregs.get(inst.csr);
-  state.csregs.set(inst.csr, rs1);
+  writeCSR(state, inst.csr, rs1);
   state.regs.set(inst.rd, csr);
 }
 
 void executeCSRRS(const Instruction &inst, State &state) {
   auto rs1 = state.regs.get(inst.rs1);
   auto csr = state.csregs.get(inst.csr);
-  state.csregs.set(inst.csr, rs1 | csr);
+  writeCSR(state, inst.csr, rs1 | csr);
   state.regs.set(inst.rd, csr);
 }
 
 void executeCSRRC(const Instruction &inst, State &state) {
   auto rs1 = state.regs.get(inst.rs1);
   auto csr = state.csregs.get(inst.csr);
-  state.csregs.set(inst.csr, rs1 & (~csr));
+  writeCSR(state, inst.csr, rs1 & (~csr));
   state.regs.set(inst.rd, csr);
 }
 
@@ -219,21 +289,37 @@ void executeCSRRWI(const Instruction &inst, State &state) {
   auto rs1 = inst.rs1;
   auto csr = state.csregs.get(inst.csr);
   state.regs.set(inst.rd, csr);
-  state.csregs.set(inst.csr, getBits<4, 0>(rs1));
+  writeCSR(state, inst.csr, getBits<4, 0>(rs1));
 }
 
 void executeCSRRSI(const Instruction &inst, State &state) {
   auto rs1 = inst.rs1;
   auto csr = state.csregs.get(inst.csr);
   state.regs.set(inst.rd, csr);
-  state.csregs.set(inst.csr, csr | getBits<4, 0>(rs1));
+  writeCSR(state, inst.csr, csr | getBits<4, 0>(rs1));
 }
 
 void executeCSRRCI(const Instruction &inst, State &state) {
   auto rs1 = inst.rs1;
   auto csr = state.csregs.get(inst.csr);
   state.regs.set(inst.rd, csr);
-  state.csregs.set(inst.csr, csr & (~getBits<4, 0>(rs1)));
+  writeCSR(state, inst.csr, csr & (~getBits<4, 0>(rs1)));
+}
+
+void executeSFENCE_VMA(const Instruction &inst, State &state) {
+  std::optional<Addr> addr{};
+  std::optional<MMU::ASID> asid{};
+  // x0 in rs1/rs2 means "all addresses"/"all address spaces"
+  if (inst.rs1)
+    addr = state.regs.get(inst.rs1);
+  if (inst.rs2)
+    asid = static_cast<MMU::ASID>(state.regs.get(inst.rs2));
+  state.mem.sfenceVMA(addr, asid);
+}
+
+void executeSRET(const Instruction &, State &state) {
+  state.branchIsTaken = true;
+  state.npc = state.csregs.get(CSRegFile::SEPC);
 }
 
 [[noreturn]] void executeAND(const Instruction &, State &) {
@@ -340,10 +426,6 @@ void executeCSRRCI(const Instruction &inst, State &state) {
   throw std::runtime_error{"Not implemented yet"};
 }
 
-[[noreturn]] void executeFENCE(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
 [[noreturn]] void executeFLD(const Instruction &, State &) {
   throw std::runtime_error{"Not implemented yet"};
 }
@@ -360,70 +442,6 @@ void executeCSRRCI(const Instruction &inst, State &state) {
   throw std::runtime_error{"Not implemented yet"};
 }
 
-[[noreturn]] void executeLB(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeLBU(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeLH(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeLHU(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeSB(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeSH(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOADD_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOAND_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOMAX_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOMAXU_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOMIN_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOMINU_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOOR_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOSWAP_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeAMOXOR_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
-[[noreturn]] void executeSC_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
-}
-
 [[noreturn]] void executeEBREAK(const Instruction &, State &) {
   throw std::runtime_error{"Not implemented yet"};
 }
@@ -556,8 +574,83 @@ void executeCSRRCI(const Instruction &inst, State &state) {
   throw std::runtime_error{"Not implemented yet"};
 }
 
-[[noreturn]] void executeLR_W(const Instruction &, State &) {
-  throw std::runtime_error{"Not implemented yet"};
+void executeFENCE(const Instruction &, State &) {
+  // Harts may run on different host threads
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void executeAMOADD_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    auto old = word.fetch_add(val);
+    return std::pair{old, old + val};
+  });
+}
+
+void executeAMOAND_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    auto old = word.fetch_and(val);
+    return std::pair{old, old & val};
+  });
+}
+
+void executeAMOOR_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    auto old = word.fetch_or(val);
+    return std::pair{old, old | val};
+  });
+}
+
+void executeAMOXOR_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    auto old = word.fetch_xor(val);
+    return std::pair{old, old ^ val};
+  });
+}
+
+void executeAMOSWAP_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    return std::pair{word.exchange(val), val};
+  });
+}
+
+void executeAMOMAX_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    return pickAMO(word, val, [](Word lhs, Word rhs) {
+      return signCast(lhs) > signCast(rhs);
+    });
+  });
+}
+
+void executeAMOMAXU_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    return pickAMO(word, val, std::greater<Word>{});
+  });
+}
+
+void executeAMOMIN_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    return pickAMO(word, val, [](Word lhs, Word rhs) {
+      return signCast(lhs) < signCast(rhs);
+    });
+  });
+}
+
+void executeAMOMINU_W(const Instruction &inst, State &state) {
+  executeAMO(inst, state, [](std::atomic_ref<Word> word, Word val) {
+    return pickAMO(word, val, std::less<Word>{});
+  });
+}
+
+void executeLR_W(const Instruction &inst, State &state) {
+  auto rs1 = state.regs.get(inst.rs1);
+  state.regs.set(inst.rd, state.mem.loadReserved(rs1));
+}
+
+void executeSC_W(const Instruction &inst, State &state) {
+  auto rs1 = state.regs.get(inst.rs1);
+  auto rs2 = state.regs.get(inst.rs2);
+  // Zero on success
+  state.regs.set(inst.rd, state.mem.storeConditional(rs1, rs2) ? 0 : 1);
 }
 
 } // namespace sim
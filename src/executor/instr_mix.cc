@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "executor/instr_mix.hh"
+
+namespace sim {
+
+namespace {
+
+double getPercent(std::uint64_t part, std::uint64_t total) {
+  return total == 0 ? 0.0
+                    : 100.0 * static_cast<double>(part) /
+                          static_cast<double>(total);
+}
+
+} // namespace
+
+InstrHistogram makeHistogram(std::span<const Instruction> instrs) {
+  InstrHistogram histogram{};
+  for (const auto &inst : instrs) {
+    auto entry = std::find_if(
+        histogram.begin(), histogram.end(),
+        [&inst](const auto &cur) { return cur.first == inst.type; });
+    if (entry == histogram.end())
+      histogram.emplace_back(inst.type, 1);
+    else
+      ++entry->second;
+  }
+  return histogram;
+}
+
+//~~~~~InstrMix class functions~~~~~
+
+InstrMix::Category InstrMix::getCategory(OpType type) {
+  static const std::unordered_map<OpType, Category> categories = {
+      {OpType::ADD, ALU},        {OpType::ADDI, ALU},
+      {OpType::SUB, ALU},        {OpType::AND, ALU},
+      {OpType::ANDI, ALU},       {OpType::OR, ALU},
+      {OpType::ORI, ALU},        {OpType::XOR, ALU},
+      {OpType::XORI, ALU},       {OpType::SLL, ALU},
+      {OpType::SLLI, ALU},       {OpType::SRL, ALU},
+      {OpType::SRLI, ALU},       {OpType::SRA, ALU},
+      {OpType::SRAI, ALU},       {OpType::SLT, ALU},
+      {OpType::SLTI, ALU},       {OpType::SLTU, ALU},
+      {OpType::SLTIU, ALU},      {OpType::LUI, ALU},
+      {OpType::AUIPC, ALU},      {OpType::MUL, ALU},
+      {OpType::MULH, ALU},       {OpType::MULHSU, ALU},
+      {OpType::MULHU, ALU},      {OpType::DIV, ALU},
+      {OpType::DIVU, ALU},       {OpType::REM, ALU},
+      {OpType::REMU, ALU},       {OpType::BEQ, BRANCH},
+      {OpType::BNE, BRANCH},     {OpType::BLT, BRANCH},
+      {OpType::BGE, BRANCH},     {OpType::BLTU, BRANCH},
+      {OpType::BGEU, BRANCH},    {OpType::JAL, JUMP},
+      {OpType::JALR, JUMP},      {OpType::LB, LOAD},
+      {OpType::LBU, LOAD},       {OpType::LH, LOAD},
+      {OpType::LHU, LOAD},       {OpType::LW, LOAD},
+      {OpType::SB, STORE},       {OpType::SH, STORE},
+      {OpType::SW, STORE},       {OpType::CSRRW, CSR},
+      {OpType::CSRRS, CSR},      {OpType::CSRRC, CSR},
+      {OpType::CSRRWI, CSR},     {OpType::CSRRSI, CSR},
+      {OpType::CSRRCI, CSR},     {OpType::ECALL, SYSTEM},
+      {OpType::EBREAK, SYSTEM},  {OpType::FENCE, SYSTEM},
+      {OpType::SRET, SYSTEM},    {OpType::SFENCE_VMA, SYSTEM},
+  };
+  auto iter = categories.find(type);
+  return iter == categories.end() ? OTHER : iter->second;
+}
+
+InstrMix::InstrMix() : counts_(opTypeToString.size() + 1) {}
+
+std::uint64_t InstrMix::getCount(Category category) const {
+  std::uint64_t res{};
+  for (std::size_t i = 0; i < counts_.size(); ++i)
+    if (getCategory(static_cast<OpType>(i)) == category)
+      res += counts_[i];
+  return res;
+}
+
+std::string_view InstrMix::getCategoryName(Category category) {
+  constexpr std::array<std::string_view, kNumCategories> kNames{
+      "alu", "branch", "jump", "load", "store", "csr", "system", "other"};
+  return kNames.at(category);
+}
+
+std::vector<std::pair<std::string_view, std::uint64_t>>
+InstrMix::getCategoryCounts() const {
+  std::array<std::uint64_t, kNumCategories> counts{};
+  for (std::size_t i = 0; i < counts_.size(); ++i)
+    counts[getCategory(static_cast<OpType>(i))] += counts_[i];
+
+  std::vector<std::pair<std::string_view, std::uint64_t>> res{};
+  for (std::size_t i = 0; i < kNumCategories; ++i) {
+    if (i != BRANCH) {
+      res.emplace_back(getCategoryName(static_cast<Category>(i)), counts[i]);
+      continue;
+    }
+    auto numTaken = std::min(numTakenBranches_, counts[i]);
+    res.emplace_back("branch_taken", numTaken);
+    res.emplace_back("branch_not_taken", counts[i] - numTaken);
+  }
+  return res;
+}
+
+std::vector<std::pair<OpType, std::uint64_t>> InstrMix::getTypeCounts() const {
+  std::vector<std::pair<OpType, std::uint64_t>> res{};
+  for (std::size_t i = 0; i < counts_.size(); ++i)
+    if (counts_[i] != 0)
+      res.emplace_back(static_cast<OpType>(i), counts_[i]);
+
+  std::stable_sort(res.begin(), res.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     return lhs.second > rhs.second;
+                   });
+  return res;
+}
+
+void InstrMix::print(std::ostream &ost) const {
+  std::uint64_t total{};
+  for (auto count : counts_)
+    total += count;
+
+  ost << "Instruction mix:\n";
+  for (auto [name, count] : getCategoryCounts())
+    ost << fmt::format("  {:<17}{:>14} {:>6.2f}%\n", name, count,
+                       getPercent(count, total));
+  ost << "Instruction types:\n";
+  for (auto [type, count] : getTypeCounts())
+    ost << fmt::format("  {:<17}{:>14} {:>6.2f}%\n", opTypeToString.at(type),
+                       count, getPercent(count, total));
+}
+
+void InstrMix::writeJSON(std::ostream &ost) const {
+  std::uint64_t total{};
+  for (auto count : counts_)
+    total += count;
+
+  ost << "{\"instructions\": " << total << ",\n \"categories\": {";
+  bool isFirst = true;
+  for (auto [name, count] : getCategoryCounts()) {
+    ost << (isFirst ? "" : ", ") << '"' << name << "\": " << count;
+    isFirst = false;
+  }
+  ost << "},\n \"types\": {";
+  isFirst = true;
+  for (auto [type, count] : getTypeCounts()) {
+    ost << (isFirst ? "" : ", ") << '"' << opTypeToString.at(type)
+        << "\": " << count;
+    isFirst = false;
+  }
+  ost << "}}\n";
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "common/hash.hh"
+#include "common/timer.hh"
+#include "elfloader/elfloader.hh"
+#include "hart/batch.hh"
+
+namespace sim {
+
+namespace {
+
+constexpr std::array kStatusNames{"completed", "limit", "failed", "stopped"};
+
+/* Exposes hart to JobHooks::setHart while hart is alive */
+class HartRegistration final {
+public:
+  HartRegistration(Hart &hart, const JobHooks &hooks) : hooks_(hooks) {
+    if (hooks_.setHart)
+      hooks_.setHart(&hart);
+  }
+  HartRegistration(const HartRegistration &) = delete;
+  HartRegistration(HartRegistration &&) = delete;
+  HartRegistration &operator=(const HartRegistration &) = delete;
+  HartRegistration &operator=(HartRegistration &&) = delete;
+  ~HartRegistration() {
+    if (hooks_.setHart)
+      hooks_.setHart(nullptr);
+  }
+
+private:
+  const JobHooks &hooks_;
+};
+
+/* Run hart till stopAt checking for cancellation in between */
+bool runHart(Hart &hart, std::uint64_t stopAt, const JobHooks &hooks) {
+  if (!hooks.isCancelled)
+    return hart.run(stopAt);
+
+  for (;;) {
+    auto left = stopAt - hart.getInstrCount();
+    auto sliceEnd = left > JobHooks::kCheckInstrs
+                        ? hart.getInstrCount() + JobHooks::kCheckInstrs
+                        : stopAt;
+    if (hart.run(sliceEnd))
+      return true;
+    // Slice is cut short if hart was stopped
+    if (sliceEnd == stopAt || hart.getInstrCount() != sliceEnd ||
+        hooks.isCancelled())
+      return false;
+  }
+}
+
+} // namespace
+
+std::vector<BatchJob> loadBatchJobs(const fs::path &file) {
+  std::ifstream ist{file};
+  if (!ist)
+    throw std::runtime_error{"Failed to open " + file.string()};
+
+  std::vector<BatchJob> res{};
+  std::string line{};
+  for (std::size_t lineNum = 1; std::getline(ist, line); ++lineNum) {
+    try {
+      if (auto job = parseBatchJob(line))
+        res.push_back(std::move(*job));
+    } catch (const std::runtime_error &e) {
+      throw std::runtime_error{
+          fmt::format("{}:{}: {}", file.string(), lineNum, e.what())};
+    }
+  }
+  return res;
+}
+
+std::optional<BatchJob> parseBatchJob(const std::string &line) {
+  std::istringstream words{line.substr(0, line.find('#'))};
+  std::string executable{};
+  if (!(words >> executable))
+    return std::nullopt;
+
+  BatchJob job{};
+  job.executable = executable;
+  for (std::string option{}; words >> option;) {
+    auto eq = option.find('=');
+    auto key = option.substr(0, eq);
+    auto val = eq == std::string::npos ? std::string{} : option.substr(eq + 1);
+    if (key == "max-instrs") {
+      const auto *valEnd = val.data() + val.size();
+      auto [ptr, ec] = std::from_chars(val.data(), valEnd, job.maxInstrs);
+      if (ec == std::errc{} && ptr == valEnd)
+        continue;
+    } else if (key == "console" && !val.empty()) {
+      job.console = val;
+      continue;
+    }
+    throw std::runtime_error{"Bad job option '" + option + "'"};
+  }
+  return job;
+}
+
+const char *BatchResult::getStatusName(Status status) {
+  return kStatusNames.at(status);
+}
+
+//~~~~~BatchRunner class functions~~~~~
+
+std::vector<BatchResult> BatchRunner::run(const std::vector<BatchJob> &jobs,
+                                          std::size_t numThreads) {
+  std::vector<BatchResult> results(jobs.size());
+  std::atomic<std::size_t> next{};
+  {
+    std::vector<std::jthread> workers{};
+    for (std::size_t i = 0; i < std::max<std::size_t>(numThreads, 1); ++i)
+      workers.emplace_back([&] {
+        for (auto idx = next++; idx < jobs.size(); idx = next++)
+          results[idx] = runJob(jobs[idx]);
+      });
+  }
+  return results;
+}
+
+std::size_t BatchRunner::getNumImages() const {
+  std::lock_guard lock{imagesMutex_};
+  return images_.size();
+}
+
+BatchResult BatchRunner::runJob(const BatchJob &job) {
+  // Output is dropped if stream is not open
+  std::ofstream console{};
+  if (!job.console.empty()) {
+    console.open(job.console);
+    if (!console) {
+      BatchResult res{};
+      res.error = "Failed to create " + job.console.string();
+      return res;
+    }
+  }
+  return runJob(job, console);
+}
+
+BatchResult BatchRunner::runJob(const BatchJob &job, std::ostream &console,
+                                const JobHooks &hooks) {
+  BatchResult res{};
+  try {
+    Hart hart{getImage(job.executable), config_.bbCacheSize};
+    hart.configureTLB(config_.tlbSize, config_.tlbWays);
+    hart.attachDevices(console);
+    HartRegistration registration{hart, hooks};
+
+    // Instructions are numbered from 1
+    auto stopAt =
+        job.maxInstrs == Hart::kNoStop ? Hart::kNoStop : job.maxInstrs + 1;
+    timer::Timer timer;
+    if (runHart(hart, stopAt, hooks))
+      res.status = BatchResult::COMPLETED;
+    else if (hart.getInstrCount() == stopAt)
+      res.status = BatchResult::LIMIT;
+    else {
+      res.status = BatchResult::STOPPED;
+      res.error = "Job has been stopped";
+    }
+    res.timeMcs = static_cast<std::uint64_t>(timer.elapsedMcs());
+
+    res.exitCode = hart.getExitCode();
+    res.numInstrs = hart.getInstrCount() - 1;
+    res.numDecodedBlocks = hart.getDecodeStats().numBlocks;
+    res.numSharedBlocks = hart.getDecodeStats().numSharedBlocks;
+  } catch (const std::exception &e) {
+    res.status = BatchResult::FAILED;
+    res.error = e.what();
+  }
+  return res;
+}
+
+BatchRunner::ImageDigest::ImageDigest(std::string_view contents)
+    : size{contents.size()}, strHash{std::hash<std::string_view>{}(contents)} {
+  StateHasher hasher{};
+  std::size_t pos = 0;
+  for (; pos + sizeof(DWord) <= contents.size(); pos += sizeof(DWord)) {
+    DWord chunk{};
+    std::memcpy(&chunk, contents.data() + pos, sizeof(chunk));
+    hasher.add(chunk);
+  }
+  DWord tail{};
+  std::memcpy(&tail, contents.data() + pos, contents.size() - pos);
+  hasher.add(tail);
+  hash = hasher.get();
+}
+
+std::shared_ptr<const ProgramImage>
+BatchRunner::getImage(const fs::path &executable) {
+  std::ifstream ist{executable, std::ios::binary};
+  if (!ist)
+    throw std::runtime_error{"Failed to open " + executable.string()};
+  std::string contents{std::istreambuf_iterator<char>{ist}, {}};
+  ImageDigest digest{contents};
+
+  auto lookup = [&]() -> std::shared_ptr<const ProgramImage> {
+    auto found = imagesMap_.find(digest);
+    if (found == imagesMap_.end())
+      return nullptr;
+    if (auto it = found->second; it != images_.begin())
+      images_.splice(images_.begin(), images_, it, std::next(it));
+    return images_.front().second;
+  };
+
+  {
+    std::lock_guard lock{imagesMutex_};
+    if (auto image = lookup())
+      return image;
+  }
+
+  // Other executables may be loaded meanwhile
+  std::istringstream elf{contents};
+  auto image = std::make_shared<const ProgramImage>(ELFLoader{elf});
+  std::lock_guard lock{imagesMutex_};
+  // The first one loaded wins if another thread was loading the same file
+  if (auto found = lookup())
+    return found;
+  // Running jobs keep their images alive
+  if (images_.size() >= kMaxImages) {
+    imagesMap_.erase(images_.back().first);
+    images_.pop_back();
+  }
+  images_.emplace_front(digest, std::move(image));
+  imagesMap_.emplace(digest, images_.begin());
+  return images_.front().second;
+}
+
+void BatchRunner::print(std::ostream &ost, const std::vector<BatchJob> &jobs,
+                        const std::vector<BatchResult> &results) {
+  ost << fmt::format("{:>6} {:>9} {:>5} {:>14} {:>10} {:>8} {:>8} {}\n", "Job",
+                     "Status", "Exit", "Instructions", "Time(us)", "Decoded",
+                     "Shared", "Executable");
+
+  std::size_t numPassed{};
+  std::uint64_t numInstrs{};
+  std::uint64_t timeMcs{};
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const auto &res = results[i];
+    ost << fmt::format("{:>6} {:>9} {:>5} {:>14} {:>10} {:>8} {:>8} {}", i,
+                       BatchResult::getStatusName(res.status), res.exitCode,
+                       res.numInstrs, res.timeMcs, res.numDecodedBlocks,
+                       res.numSharedBlocks, jobs[i].executable.string());
+    if (!res.error.empty())
+      ost << ": " << res.error;
+    ost << '\n';
+
+    numPassed += res.isPassed();
+    numInstrs += res.numInstrs;
+    timeMcs += res.timeMcs;
+  }
+  ost << fmt::format("Passed {} of {} jobs, {} instructions in {} us\n",
+                     numPassed, results.size(), numInstrs, timeMcs);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,13 @@
+#include "hart/bb_cache.hh"
+
+namespace sim {
+
+std::unique_ptr<IBBCache> makeBBCache(std::int64_t size) {
+  if (size < 0)
+    return std::make_unique<InfCache>();
+  if (size == 0)
+    return std::make_unique<NoCache>();
+  return std::make_unique<LRUCache>(static_cast<std::size_t>(size));
+}
+
+} // namespace sim
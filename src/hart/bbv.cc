@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "hart/bbv.hh"
+
+namespace sim {
+
+//~~~~~BBVRecorder class functions~~~~~
+
+BBVRecorder::BBVRecorder(Hart &hart, std::uint64_t interval)
+    : hart_(hart), interval_(interval) {
+  if (!interval_)
+    throw std::invalid_argument{"BBV interval has to be positive"};
+  if (!hart_.getBlockStats())
+    hart_.enableBlockStats();
+}
+
+void BBVRecorder::record(std::ostream &ost) {
+  for (bool isDone = false; !isDone;) {
+    // Same boundaries as IntervalSampler: interval k is [k*N+1, (k+1)*N+1)
+    auto stopAt =
+        ((hart_.getInstrCount() - 1) / interval_ + 1) * interval_ + 1;
+    isDone = hart_.run(stopAt);
+    writeInterval(ost);
+  }
+}
+
+void BBVRecorder::writeInterval(std::ostream &ost) {
+  const auto &blocks = hart_.getBlockStats()->getBlocks();
+  lastInstrs_.resize(blocks.size() + 1);
+
+  std::vector<std::pair<std::size_t, std::uint64_t>> vector{};
+  for (const auto &[entry, block] : blocks) {
+    auto &last = lastInstrs_[block.id];
+    if (auto count = block.counters.numInstrs - last; count != 0)
+      vector.emplace_back(block.id, count);
+    last = block.counters.numInstrs;
+  }
+  if (vector.empty())
+    return;
+
+  std::sort(vector.begin(), vector.end());
+  fmt::memory_buffer buf{};
+  auto out = std::back_inserter(buf);
+  fmt::format_to(out, "T");
+  for (auto [id, count] : vector)
+    fmt::format_to(out, ":{}:{} ", id, count);
+  buf.push_back('\n');
+  ost.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
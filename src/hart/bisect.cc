@@ -0,0 +1,117 @@
+#include <charconv>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "hart/bisect.hh"
+
+namespace sim {
+
+namespace {
+
+constexpr std::string_view kIntervalPrefix = "INTERVAL=";
+constexpr std::string_view kNumPrefix = "NUM=";
+constexpr std::string_view kHashPrefix = " HASH=";
+
+template <std::unsigned_integral T>
+T parseValue(std::string_view line, std::string_view prefix, int base = 10) {
+  if (!line.starts_with(prefix))
+    throw std::runtime_error{"Bad hash stream line: " + std::string{line}};
+
+  line.remove_prefix(prefix.size());
+  T val{};
+  const auto *end = line.data() + line.size();
+  auto [ptr, ec] = std::from_chars(line.data(), end, val, base);
+  if (ec != std::errc{} || ptr != end || line.empty())
+    throw std::runtime_error{"Bad hash stream line: " + std::string{line}};
+  return val;
+}
+
+} // namespace
+
+HashStream loadHashStream(const fs::path &file) {
+  std::ifstream ist{file};
+  if (!ist)
+    throw std::runtime_error{"Failed to open hash stream: " + file.string()};
+
+  HashStream stream{};
+  std::string line{};
+  if (std::getline(ist, line))
+    stream.interval = parseValue<std::uint64_t>(line, kIntervalPrefix);
+  if (!stream.interval)
+    throw std::runtime_error{"Bad hash stream interval: " + file.string()};
+
+  while (std::getline(ist, line)) {
+    auto hashPos = line.find(kHashPrefix);
+    if (hashPos == std::string::npos)
+      throw std::runtime_error{"Bad hash stream line: " + line};
+
+    std::string_view view{line};
+    stream.hashes.push_back(
+        {parseValue<std::uint64_t>(view.substr(0, hashPos), kNumPrefix),
+         parseValue<DWord>(view.substr(hashPos), kHashPrefix, 16)});
+  }
+  return stream;
+}
+
+//~~~~~HashCosim class functions~~~~~
+
+HashCosim::HashCosim(Hart &hart, std::uint64_t interval)
+    : hart_(hart), interval_(interval) {
+  if (!interval_)
+    throw std::invalid_argument{"Hash interval has to be positive"};
+}
+
+bool HashCosim::runInterval(StateHash &hash) {
+  // Instructions are numbered from 1: interval k is [k*N+1, (k+1)*N+1)
+  auto stopAt = ((hart_.getInstrCount() - 1) / interval_ + 1) * interval_ + 1;
+  auto isDone = hart_.run(stopAt);
+  hash = {hart_.getInstrCount(), hart_.hashState()};
+  return isDone;
+}
+
+void HashCosim::record(std::ostream &ost) {
+  ost << kIntervalPrefix << interval_ << '\n';
+  for (bool isDone = false; !isDone;) {
+    StateHash hash{};
+    isDone = runInterval(hash);
+    ost << fmt::format("{}{}{}{:016x}\n", kNumPrefix, hash.instrNum,
+                       kHashPrefix, hash.hash);
+  }
+  if (!ost.flush())
+    throw std::runtime_error{"Failed to write hash stream"};
+}
+
+std::optional<HashCosim::Mismatch>
+HashCosim::check(const HashStream &reference, const fs::path &traceFile) {
+  if (reference.interval != interval_)
+    throw std::invalid_argument{"Hash intervals of runs differ"};
+
+  const auto &hashes = reference.hashes;
+  auto checkpoint = hart_.takeSnapshot();
+  for (std::size_t i = 0;; ++i) {
+    StateHash hash{};
+    auto isDone = runInterval(hash);
+    // Both runs have to complete at the same point
+    auto isLast = i + 1 == hashes.size();
+    if (i < hashes.size() && hashes[i] == hash && isDone == isLast) {
+      if (isDone)
+        return std::nullopt;
+      hart_.updateSnapshot(checkpoint);
+      continue;
+    }
+
+    Mismatch mismatch{i, checkpoint.instrCount, hash.instrNum};
+    hart_.restoreSnapshot(checkpoint);
+    hart_.startTrace(traceFile);
+    hart_.run(mismatch.to);
+    hart_.stopTrace();
+    return mismatch;
+  }
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "hart/block_stats.hh"
+
+namespace sim {
+
+namespace {
+
+double getPercent(std::uint64_t part, std::uint64_t total) {
+  return total == 0 ? 0.0
+                    : 100.0 * static_cast<double>(part) /
+                          static_cast<double>(total);
+}
+
+std::string escapeJSON(std::string_view str) {
+  std::string res{};
+  for (auto c : str) {
+    if (c == '"' || c == '\\')
+      res += '\\';
+    res += c;
+  }
+  return res;
+}
+
+} // namespace
+
+//~~~~~BlockStats class functions~~~~~
+
+BlockCounters &BlockStats::onDecode(Addr entry, const BasicBlock &bb) {
+  auto [it, isNew] = blocks_.try_emplace(entry);
+  auto &block = it->second;
+  if (isNew)
+    block.id = blocks_.size();
+  block.entry = entry;
+  block.bb = bb;
+  ++block.counters.numMisses;
+  return block.counters;
+}
+
+std::vector<const BlockStats::Block *> BlockStats::getHottest() const {
+  std::vector<const Block *> res{};
+  res.reserve(blocks_.size());
+  for (const auto &[entry, block] : blocks_)
+    res.push_back(&block);
+
+  std::sort(res.begin(), res.end(), [](const auto *lhs, const auto *rhs) {
+    if (lhs->counters.numInstrs != rhs->counters.numInstrs)
+      return lhs->counters.numInstrs > rhs->counters.numInstrs;
+    return lhs->entry < rhs->entry;
+  });
+  return res;
+}
+
+void BlockStats::print(std::ostream &ost, std::size_t numBlocks,
+                       const SymbolTable &symbols) const {
+  std::uint64_t numInstrs{};
+  std::uint64_t numExecs{};
+  std::uint64_t numMisses{};
+  for (const auto &[entry, block] : blocks_) {
+    numInstrs += block.counters.numInstrs;
+    numExecs += block.counters.numExecs;
+    numMisses += block.counters.numMisses;
+  }
+
+  // Block may be decoded but not executed when simulation stops
+  auto numHits = numExecs - std::min(numExecs, numMisses);
+  ost << fmt::format("Basic blocks: {}, BB cache hit rate: {:.2f}% ({}/{})\n",
+                     blocks_.size(), getPercent(numHits, numExecs), numHits,
+                     numExecs);
+
+  auto hottest = getHottest();
+  hottest.resize(std::min(hottest.size(), numBlocks));
+  for (std::size_t i = 0; i < hottest.size(); ++i) {
+    const auto &block = *hottest[i];
+    ost << fmt::format("#{} 0x{:08x} <{}>: {} instructions ({:.2f}%), {} "
+                       "executions, {} misses\n",
+                       i + 1, block.entry, symbols.str(block.entry),
+                       block.counters.numInstrs,
+                       getPercent(block.counters.numInstrs, numInstrs),
+                       block.counters.numExecs, block.counters.numMisses);
+
+    auto addr = block.entry;
+    for (const auto &inst : block.bb) {
+      ost << fmt::format("  [0x{:08x}]{}\n", addr, inst.str());
+      addr += kXLENInBytes;
+    }
+  }
+}
+
+void BlockStats::writeJSON(std::ostream &ost,
+                           const SymbolTable &symbols) const {
+  ost << "{\"blocks\": [";
+  bool isFirst = true;
+  for (const auto *block : getHottest()) {
+    ost << (isFirst ? "\n" : ",\n");
+    isFirst = false;
+    ost << fmt::format("  {{\"entry\": {}, \"symbol\": \"{}\", \"instrs\": "
+                       "{}, \"execs\": {}, \"misses\": {}, \"disasm\": [",
+                       block->entry, escapeJSON(symbols.str(block->entry)),
+                       block->counters.numInstrs, block->counters.numExecs,
+                       block->counters.numMisses);
+
+    for (std::size_t i = 0; i < block->bb.size(); ++i) {
+      auto disasm = block->bb[i].str();
+      disasm.erase(0, disasm.find_first_not_of(' '));
+      ost << (i ? ", \"" : "\"") << escapeJSON(disasm) << '"';
+    }
+    ost << "]}";
+  }
+  ost << "\n]}\n";
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
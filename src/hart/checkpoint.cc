@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/common.hh"
+#include "hart/hart.hh"
+
+namespace sim {
+
+namespace {
+
+/*
+  Checkpoint file layout (every section starts on a page boundary):
+    header
+    CSRs
+    page index: physical page numbers in ascending order
+    page contents in the same order as in index
+*/
+constexpr std::array<char, 8> kMagic{'S', 'I', 'M', 'C', 'K', 'P', 'T', '\0'};
+constexpr std::uint32_t kVersion = 1;
+
+struct CheckpointHeader final {
+  std::array<char, 8> magic{};
+  std::uint32_t version{};
+  std::uint32_t numPages{};
+  std::uint64_t instrCount{};
+  Addr pc{};
+  std::array<RegVal, kRegNum> regs{};
+  TLB::TLBStats instrTLBStats{};
+  TLB::TLBStats dataTLBStats{};
+  Memory::MemoryStats memStats{};
+};
+
+static_assert(std::is_trivially_copyable_v<CheckpointHeader>);
+static_assert(sizeof(CheckpointHeader) <= kPageSize);
+
+constexpr std::size_t alignToPage(std::size_t size) {
+  return (size + kPageSize - 1) / kPageSize * kPageSize;
+}
+
+constexpr std::size_t kCSROffset = kPageSize;
+constexpr std::size_t kIndexOffset =
+    kCSROffset + alignToPage(kCSRegNum * sizeof(RegVal));
+
+constexpr std::size_t getPagesOffset(std::size_t numPages) {
+  return kIndexOffset + alignToPage(numPages * sizeof(std::uint32_t));
+}
+
+void writePadded(std::ofstream &ost, const void *data, std::size_t size) {
+  static const std::array<char, kPageSize> zeroes{};
+  ost.write(static_cast<const char *>(data),
+            static_cast<std::streamsize>(size));
+  ost.write(zeroes.data(),
+            static_cast<std::streamsize>(alignToPage(size) - size));
+}
+
+/* Private (copy-on-write) mapping of the whole file */
+std::shared_ptr<void> mapFile(const fs::path &file, std::size_t &size) {
+  auto fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error{"Failed to open checkpoint: " + file.string()};
+
+  struct stat st {};
+  void *addr = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    size = static_cast<std::size_t>(st.st_size);
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (addr == MAP_FAILED)
+    throw std::runtime_error{"Failed to map checkpoint: " + file.string()};
+
+  return std::shared_ptr<void>{addr,
+                               [size](void *ptr) { munmap(ptr, size); }};
+}
+
+} // namespace
+
+void Hart::saveCheckpoint(const fs::path &file) {
+  const auto &pages = getMem().getPages();
+  std::vector<std::uint32_t> index{};
+  index.reserve(pages.size());
+  for (const auto &[ppn, page] : pages)
+    index.push_back(ppn);
+  std::sort(index.begin(), index.end());
+
+  CheckpointHeader header{};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.numPages = static_cast<std::uint32_t>(index.size());
+  header.instrCount = exec_.getInstrCount();
+  header.pc = state_.pc;
+  header.regs = state_.regs.getAll();
+  header.instrTLBStats = getMem().getInstrTLBStats();
+  header.dataTLBStats = getMem().getDataTLBStats();
+  header.memStats = getMem().getMemStats();
+
+  std::ofstream ost{file, std::ios::binary | std::ios::trunc};
+  if (!ost)
+    throw std::runtime_error{"Failed to create checkpoint: " + file.string()};
+
+  const auto &csregs = state_.csregs.getAll();
+  writePadded(ost, &header, sizeof(header));
+  writePadded(ost, csregs.data(), csregs.size() * sizeof(RegVal));
+  writePadded(ost, index.data(), index.size() * sizeof(std::uint32_t));
+  for (auto ppn : index)
+    ost.write(reinterpret_cast<const char *>(pages.find(ppn)->words().data()),
+              kPageSize);
+
+  if (!ost.flush())
+    throw std::runtime_error{"Failed to write checkpoint: " + file.string()};
+}
+
+void Hart::restoreCheckpoint(const fs::path &file) {
+  std::size_t size{};
+  auto mapping = mapFile(file, size);
+  auto *base = static_cast<Byte *>(mapping.get());
+
+  CheckpointHeader header{};
+  if (size >= kIndexOffset)
+    std::memcpy(&header, base, sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion ||
+      size != getPagesOffset(header.numPages) +
+                  std::size_t{header.numPages} * kPageSize)
+    throw std::runtime_error{"Bad checkpoint file: " + file.string()};
+
+  std::vector<RegVal> csregs(kCSRegNum);
+  std::memcpy(csregs.data(), base + kCSROffset, kCSRegNum * sizeof(RegVal));
+
+  std::vector<std::uint32_t> index(header.numPages);
+  std::memcpy(index.data(), base + kIndexOffset,
+              index.size() * sizeof(std::uint32_t));
+
+  std::vector<std::pair<std::uint32_t, Word *>> pages{};
+  pages.reserve(index.size());
+  auto *pageData = base + getPagesOffset(header.numPages);
+  for (auto ppn : index) {
+    pages.emplace_back(ppn, reinterpret_cast<Word *>(pageData));
+    pageData += kPageSize;
+  }
+
+  state_.pc = header.pc;
+  state_.regs.setAll(header.regs);
+  state_.csregs.setAll(std::move(csregs));
+  state_.branchIsTaken = false;
+  state_.complete = false;
+  exec_.setInstrCount(header.instrCount);
+  if (tracer_)
+    tracer_->sync(header.instrCount, header.pc);
+
+  getMem().mapPages(pages, std::move(mapping));
+  getMem().setSatp(state_.csregs.get(CSRegFile::SATP));
+  getMem().setTLBStats(header.instrTLBStats, header.dataTLBStats);
+  getMem().setMemStats(header.memStats);
+}
+
+} // namespace sim
@@ -1,101 +1,269 @@
+#include <algorithm>
+#include <coroutine>
 #include <memory>
+#include <span>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 #include <utility>
 
+#include <fmt/format.h>
+
 #include "common/common.hh"
+#include "common/hash.hh"
 #include "common/inst.hh"
+#include "common/timer.hh"
 #include "elfloader/elfloader.hh"
 #include "hart/hart.hh"
 
 namespace sim {
 
-class InfCache final : public IBBCache {
-  std::unordered_map<Addr, BasicBlock> hash_{};
+Hart::Hart(const fs::path &executable, std::int64_t bbCacheSize)
+    : Hart(executable, bbCacheSize, std::make_shared<PhysMemory>(), 0) {}
+
+Hart::Hart(const fs::path &executable, std::int64_t bbCacheSize,
+           std::shared_ptr<PhysMemory> physMem, Word hartId)
+    : state_{.mem = Memory{std::move(physMem)}} {
+  bbc_ = makeBBCache(bbCacheSize);
+  state_.csregs.set(CSRegFile::MHARTID, hartId);
+
+  ELFLoader loader{executable};
+  getPC() = loader.getEntryPoint();
+  // Other harts find the program in shared memory already
+  if (hartId == 0)
+    loadSegments(loader, getMem());
+
+  getMem().setProgramStoredFlag();
+}
+
+Hart::Hart(std::shared_ptr<const ProgramImage> image, std::int64_t bbCacheSize)
+    : image_{std::move(image)} {
+  bbc_ = makeBBCache(bbCacheSize);
+  getPC() = image_->getEntryPoint();
+  image_->mapInto(getMem());
+  getMem().setProgramStoredFlag();
+}
+
+void Hart::attachDevices(std::ostream &console) {
+  if (lockstep_)
+    throw std::logic_error{"Devices are not supported in lockstep mode"};
 
-public:
-  const BasicBlock &
-  lookupUpdate(Addr key, std::function<BasicBlock(Addr)> slowGetData) override {
-    if (auto hit = hash_.find(key); hit != hash_.end())
-      return hit->second;
+  auto uart = std::make_unique<UART>(console);
+  console_ = uart.get();
+  getMem().addDevice(kUARTBase, std::move(uart));
 
-    auto bb = slowGetData(key);
-    return hash_[key] = std::move(bb);
+  getMem().addDevice(kCLINTBase, std::make_unique<CLINT>([this] {
+    return exec_.getInstrCount();
+  }));
+
+  getMem().addDevice(kFinisherBase,
+                     std::make_unique<TestFinisher>([this](int code) {
+                       exitCode_ = code;
+                       state_.complete = true;
+                     }));
+}
+
+void Hart::enableLockstep() {
+  if (console_)
+    throw std::logic_error{"Devices are not supported in lockstep mode"};
+  lockstep_ = std::make_unique<Lockstep>(state_, exec_.getInstrCount());
+}
+
+void Hart::enableProfiler(std::vector<ELFLoader::Symbol> symbols,
+                          std::uint64_t period) {
+  profiler_ = std::make_unique<Profiler>(std::move(symbols), period, getPC(),
+                                         exec_.getInstrCount());
+}
+
+void Hart::writeProfile(std::ostream &ost) const {
+  if (!profiler_)
+    throw std::logic_error{"Profiler is not enabled"};
+  profiler_->write(ost);
+}
+
+void Hart::enableBlockStats() {
+  blockStats_ = std::make_unique<BlockStats>();
+  // Already cached blocks have no counters
+  bbc_->flush();
+}
+
+void Hart::enableInstrMix() {
+  instrMix_ = std::make_unique<InstrMix>();
+  // Already cached blocks have no histograms
+  bbc_->flush();
+}
+
+void Hart::registerStats(StatsRegistry &registry) {
+  registry.addCounter("executor", "instructions",
+                      [this] { return exec_.getInstrCount() - 1; });
+
+  if (registry.isEnabled("instr_mix")) {
+    if (!instrMix_)
+      enableInstrMix();
+    for (std::size_t i = 0; i < InstrMix::kNumCategories; ++i) {
+      auto category = static_cast<InstrMix::Category>(i);
+      registry.addCounter("instr_mix", InstrMix::getCategoryName(category),
+                          [this, category] {
+                            return instrMix_->getCount(category);
+                          });
+    }
+    registry.addCounter("instr_mix", "taken_branches",
+                        [this] { return instrMix_->getNumTakenBranches(); });
   }
-};
-
-class NoCache final : public IBBCache {
-public:
-  const BasicBlock &
-  lookupUpdate(Addr key, std::function<BasicBlock(Addr)> slowGetData) override {
-    static BasicBlock cur{};
-    cur = slowGetData(key);
-    return cur;
+
+  if constexpr (TLB::kCollectStats) {
+    auto addTLB = [&](std::string_view side, auto getStats) {
+      registry.addCounter("tlb", fmt::format("{}_requests", side), [=, this] {
+        return (getMemory().*getStats)().TLBRequests;
+      });
+      registry.addCounter("tlb", fmt::format("{}_hits", side), [=, this] {
+        return (getMemory().*getStats)().TLBHits;
+      });
+      registry.addCounter("tlb", fmt::format("{}_misses", side), [=, this] {
+        return (getMemory().*getStats)().TLBMisses;
+      });
+    };
+    addTLB("instr", &Memory::getInstrTLBStats);
+    addTLB("data", &Memory::getDataTLBStats);
   }
-};
-
-class LRUCache final : public IBBCache {
-  std::size_t size_;
-  std::list<std::pair<Addr, BasicBlock>> cache_{};
-
-  using ListIt = typename std::list<std::pair<Addr, BasicBlock>>::iterator;
-  std::unordered_map<Addr, ListIt> hash_{};
-
-public:
-  explicit LRUCache(std::size_t size) : size_(size) {}
-
-  [[nodiscard]] bool isFull() const { return (cache_.size() == size_); }
-
-  const BasicBlock &
-  lookupUpdate(Addr key, std::function<BasicBlock(Addr)> slowGetData) override {
-    auto hit = hash_.find(key);
-    if (hit == hash_.end()) {
-      if (isFull()) {
-        hash_.erase(cache_.back().first);
-        cache_.pop_back();
-      }
-      cache_.emplace_front(key, slowGetData(key));
-      hash_.emplace(key, cache_.begin());
-    } else if (auto eltit = hit->second; eltit != cache_.begin())
-      cache_.splice(cache_.begin(), cache_, eltit, std::next(eltit));
-
-    return cache_.front().second;
+
+  registry.addCounter("memory", "loads",
+                      [this] { return getMemory().getMemStats().numLoads; });
+  registry.addCounter("memory", "stores",
+                      [this] { return getMemory().getMemStats().numStores; });
+
+  if (registry.isEnabled("bbcache")) {
+    if (!blockStats_)
+      enableBlockStats();
+    auto sum = [this](auto field) {
+      std::uint64_t res{};
+      for (const auto &[entry, block] : blockStats_->getBlocks())
+        res += block.counters.*field;
+      return res;
+    };
+    registry.addCounter("bbcache", "lookups",
+                        [=] { return sum(&BlockCounters::numExecs); });
+    registry.addCounter("bbcache", "misses",
+                        [=] { return sum(&BlockCounters::numMisses); });
+    registry.addCounter("bbcache", "blocks",
+                        [this] { return blockStats_->getBlocks().size(); });
   }
-};
 
-Hart::Hart(const fs::path &executable, std::int64_t bbCacheSize) {
-  if (bbCacheSize < 0)
-    bbc_ = std::make_unique<InfCache>();
-  else if (bbCacheSize == 0)
-    bbc_ = std::make_unique<NoCache>();
-  else
-    bbc_ = std::make_unique<LRUCache>(bbCacheSize);
+  registry.addCounter("decoder", "blocks",
+                      [this] { return decodeStats_.numBlocks; });
+  registry.addCounter("decoder", "instructions",
+                      [this] { return decodeStats_.numInstrs; });
+  registry.addCounter("decoder", "shared_blocks",
+                      [this] { return decodeStats_.numSharedBlocks; });
+  registry.addHistogram("decoder", "block_sizes",
+                        DecodeStats::kNumSizeBuckets, [this] {
+                          const auto &sizes = decodeStats_.blockSizes;
+                          return std::vector(sizes.begin(), sizes.end());
+                        });
+}
 
-  ELFLoader loader{executable};
-  getPC() = loader.getEntryPoint();
+void Hart::startTrace(const fs::path &file) {
+  stopTrace();
+  tracer_ = std::make_unique<Tracer>(file);
+  tracer_->sync(exec_.getInstrCount(), getPC());
+  state_.tracer = tracer_.get();
+  state_.regs.setTracer(tracer_.get());
+  getMem().setTracer(tracer_.get());
+}
+
+void Hart::stopTrace() {
+  if (!tracer_)
+    return;
+
+  state_.tracer = nullptr;
+  state_.regs.setTracer(nullptr);
+  getMem().setTracer(nullptr);
+  auto tracer = std::move(tracer_);
+  tracer->close();
+}
+
+Hart::Snapshot Hart::takeSnapshot() {
+  return Snapshot{state_.pc, state_.regs, state_.csregs, exec_.getInstrCount(),
+                  getMem().takeSnapshot()};
+}
+
+void Hart::restoreSnapshot(const Snapshot &snapshot) {
+  getMem().restoreSnapshot(snapshot.mem);
 
-  for (auto segmentIdx : loader.getLoadableSegments()) {
-    auto text = loader.getSegment(segmentIdx);
-    auto addr = loader.getSegmentAddr(segmentIdx);
-    getMem().storeRange(addr, text.begin(), text.end());
+  auto satp = snapshot.csregs.get(CSRegFile::SATP);
+  bool satpChanged = satp != state_.csregs.get(CSRegFile::SATP);
+  state_.pc = snapshot.pc;
+  state_.regs.setAll(snapshot.regs.getAll());
+  state_.csregs = snapshot.csregs;
+  state_.branchIsTaken = false;
+  state_.complete = false;
+  exec_.setInstrCount(snapshot.instrCount);
+  if (tracer_)
+    tracer_->sync(snapshot.instrCount, snapshot.pc);
 
-    auto fileSize = static_cast<Addr>(loader.getSegmentFileSize(segmentIdx));
-    auto memSize = static_cast<Addr>(loader.getSegmentMemorySize(segmentIdx));
-    for (; fileSize < memSize; fileSize += kXLENInBytes)
-      getMem().storeEntity<Word>(addr + fileSize, Word{});
+  // Restored pages may contain page tables
+  if (satpChanged || getMem().getMMU().isPagingOn()) {
+    getMem().setSatp(satp);
+    getMem().sfenceVMA(std::nullopt, std::nullopt);
   }
+}
 
-  getMem().setProgramStoredFlag();
+void Hart::updateSnapshot(Snapshot &snapshot) {
+  snapshot.pc = state_.pc;
+  snapshot.regs = state_.regs;
+  snapshot.csregs = state_.csregs;
+  snapshot.instrCount = exec_.getInstrCount();
+  getMem().updateSnapshot(snapshot.mem);
+}
+
+DWord Hart::hashState() {
+  StateHasher hasher{};
+  hasher.add(state_.pc);
+  hasher.add(state_.regs.getAll());
+
+  const auto &pages = getMem().getPages();
+  for (auto ppn : getMem().getDirtyPages(PhysMemory::HASH)) {
+    hasher.add(ppn);
+    if (const auto *page = pages.find(ppn))
+      hasher.add(page->words());
+  }
+  getMem().clearDirty(PhysMemory::HASH);
+
+  return hasher.get();
 }
 
-BasicBlock Hart::createBB(Addr addr) {
+CachedBlock Hart::createBB(Addr addr) {
+  timer::ScopedTimer scopedTimer{timer::Section::DECODE};
+  HostPerf::ScopedPhase scopedPhase{hostPerf_, HostPerf::DECODE};
+
+  // Blocks of image are shared by physical address
+  bool isShareable = image_ && !getMem().getMMU().isPagingOn();
+  BasicBlock bb{};
+  if (const auto *shared = isShareable ? image_->findBlock(addr) : nullptr) {
+    bb = *shared;
+    ++decodeStats_.numSharedBlocks;
+  } else {
+    bb = decodeBB(addr);
+    if (isShareable)
+      image_->addBlock(addr, bb);
+  }
+
+  CachedBlock cached{};
+  if (blockStats_)
+    cached.counters = &blockStats_->onDecode(addr, bb);
+  if (instrMix_)
+    cached.histogram = makeHistogram(bb);
+  cached.bb = std::move(bb);
+  return cached;
+}
+
+BasicBlock Hart::decodeBB(Addr addr) {
   BasicBlock bb{};
 
 #ifdef SPDLOG
   spdlog::trace("Creating basic block:");
 #endif
   for (bool isBranch = false; !isBranch; addr += kXLENInBytes) {
-    auto inst = decoder_.decode(getMem().loadEntity<Word>(addr));
+    auto inst = decoder_.decode(getMem().fetchInstr(addr));
     if (inst.type == OpType::UNKNOWN)
       throw std::logic_error{
           "Unknown instruction found while decoding basic block" + inst.str()};
@@ -110,21 +278,89 @@ BasicBlock Hart::createBB(Addr addr) {
 #ifdef SPDLOG
   spdlog::trace("Basic blok created.");
 #endif
+  ++decodeStats_.numBlocks;
+  decodeStats_.numInstrs += bb.size();
+  ++decodeStats_.blockSizes[std::min(bb.size(),
+                                     DecodeStats::kNumSizeBuckets) - 1];
   return bb;
 }
 
-void Hart::run() {
+void Hart::onBlockExecuted(const CachedBlock &cached, Addr entry,
+                           std::size_t numExecuted) {
+  if (lockstep_) [[unlikely]]
+    lockstep_->check(exec_.getInstrCount());
+
+  auto executed = std::span{cached.bb}.first(numExecuted);
+  if (profiler_) [[unlikely]]
+    profiler_->onBlock(entry, executed, getPC(), exec_.getInstrCount());
+  if (executed.empty())
+    return;
+
+  if (hostPerf_) [[unlikely]]
+    hostPerf_->onBlock();
+  if (cached.counters) [[unlikely]]
+    cached.counters->onExec(numExecuted);
+  if (instrMix_) [[unlikely]] {
+    if (numExecuted != cached.bb.size()) {
+      instrMix_->add(makeHistogram(executed));
+      return;
+    }
+    instrMix_->add(cached.histogram);
+    if (InstrMix::isCondBranch(executed.back().type)) {
+      auto fallThrough = entry + static_cast<Addr>(numExecuted * kXLENInBytes);
+      instrMix_->onBranch(getPC() != fallThrough);
+    }
+  }
+}
+
+bool Hart::run(std::uint64_t stopAt) { return runBlocks(stopAt, kNoStop); }
+
+// GCC lowers coroutine into switch w/o default case
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wswitch-default"
+HartTask Hart::runTask(std::uint64_t sliceBlocks) {
+  while (!runBlocks(kNoStop, sliceBlocks) &&
+         !isStopRequested_.load(std::memory_order_relaxed))
+    co_await std::suspend_always{};
+}
+#pragma GCC diagnostic pop
+
+bool Hart::runBlocks(std::uint64_t stopAt, std::uint64_t numBlocks) {
   auto lCreateBB = [this](Addr addr) { return createBB(addr); };
 
   while (!state_.complete) {
-    const auto &bb = bbc_->lookupUpdate(getPC(), lCreateBB);
+    if (isStopRequested_.load(std::memory_order_relaxed)) [[unlikely]]
+      return false;
+    if (numBlocks-- == 0) [[unlikely]]
+      return false;
+    if (auto epoch = getMem().getTranslationEpoch();
+        epoch != translationEpoch_) [[unlikely]] {
+      bbc_->flush();
+      translationEpoch_ = epoch;
+    }
+    auto entry = getPC();
+    const auto &cached = [&]() -> const CachedBlock & {
+      timer::ScopedTimer scopedTimer{timer::Section::BBCACHE};
+      return bbc_->lookupUpdate(entry, lCreateBB);
+    }();
+    const auto &bb = cached.bb;
+
+    auto left = stopAt - exec_.getInstrCount();
+    if (left <= bb.size()) [[unlikely]] {
+      // Stop exactly before instruction number stopAt
+      exec_.execute(bb.begin(),
+                    bb.begin() + static_cast<std::ptrdiff_t>(left), state_);
+      onBlockExecuted(cached, entry, left);
+      if (!state_.complete)
+        return false;
+      break;
+    }
     exec_.execute(bb.begin(), bb.end(), state_);
+    onBlockExecuted(cached, entry, bb.size());
   }
-  auto stats = state_.mem.getTLBStats();
-  std::cout << "TLB HitRate: " << std::fixed << std::setprecision(2)
-            << static_cast<double>(stats.TLBHits) /
-                   static_cast<double>(stats.TLBRequests) * 100.0
-            << "%" << std::endl;
+  if (console_)
+    console_->flush();
+  return true;
 }
 
 } // namespace sim
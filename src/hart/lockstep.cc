@@ -0,0 +1,84 @@
+#include <sstream>
+
+#include <fmt/format.h>
+
+#include "decoder/decoder.hh"
+#include "hart/lockstep.hh"
+
+namespace sim {
+
+//~~~~~Lockstep class functions~~~~~
+
+Lockstep::Lockstep(State &state, std::uint64_t instrCount)
+    : state_(state), instrCount_(instrCount) {
+  // Paging is off in the shadow memory, so pages are stored by physical
+  // addresses
+  for (const auto &[ppn, page] : state_.mem.getPages()) {
+    auto words = page.words();
+    shadow_.mem.storeRange(ppn << kOffsetBits, words.begin(), words.end());
+  }
+
+  shadow_.pc = state_.pc;
+  shadow_.regs.setAll(state_.regs.getAll());
+  shadow_.regs.setCosimLogged(false);
+  shadow_.csregs = state_.csregs;
+  shadow_.mem.setSatp(shadow_.csregs.get(CSRegFile::SATP));
+  shadow_.complete = state_.complete;
+
+  state_.mem.setStoreLog(&stores_);
+  shadow_.mem.setStoreLog(&shadowStores_);
+}
+
+Lockstep::~Lockstep() { state_.mem.setStoreLog(nullptr); }
+
+void Lockstep::step() {
+  auto inst = Decoder::decode(shadow_.mem.fetchInstr(shadow_.pc));
+  if (inst.type == OpType::UNKNOWN)
+    throw DivergenceError{dump("golden model has met unknown instruction")};
+
+  exec_.execute(inst, shadow_);
+  ++instrCount_;
+}
+
+void Lockstep::check(std::uint64_t instrCount) {
+  while (instrCount_ < instrCount && !shadow_.complete)
+    step();
+
+  const char *reason = nullptr;
+  if (instrCount_ != instrCount)
+    reason = "golden model has completed earlier";
+  else if (shadow_.pc != state_.pc)
+    reason = "pc differs";
+  else if (shadow_.regs.getAll() != state_.regs.getAll())
+    reason = "registers differ";
+  else if (shadowStores_ != stores_)
+    reason = "stores differ";
+  else if (shadow_.complete != state_.complete)
+    reason = "completion differs";
+  if (reason)
+    throw DivergenceError{dump(reason)};
+
+  stores_.clear();
+  shadowStores_.clear();
+}
+
+std::string Lockstep::dump(const std::string &reason) const {
+  std::ostringstream ss{};
+  ss << fmt::format("Lockstep divergence before instruction NUM={}: {}\n",
+                    instrCount_, reason);
+
+  auto dumpState = [&ss](const char *name, const State &state,
+                         const StoreLog &stores) {
+    ss << fmt::format("{}: pc=0x{:08x}\n", name, state.pc);
+    ss << state.regs.str();
+    for (auto [addr, val] : stores)
+      ss << fmt::format("  M[0x{:08x}]=0x{:08x}\n", addr, val);
+  };
+  dumpState("engine", state_, stores_);
+  dumpState("golden", shadow_, shadowStores_);
+  return ss.str();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
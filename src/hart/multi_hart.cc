@@ -0,0 +1,40 @@
+#include <stdexcept>
+
+#include "hart/multi_hart.hh"
+
+namespace sim {
+
+//~~~~~MultiHart class functions~~~~~
+
+MultiHart::MultiHart(const fs::path &executable, std::size_t numHarts,
+                     const HartConfig &config) {
+  if (numHarts == 0)
+    throw std::invalid_argument{"At least one hart is required"};
+
+  for (std::size_t i = 0; i < numHarts; ++i) {
+    auto &hart = harts_.emplace_back(std::make_unique<Hart>(
+        executable, config.bbCacheSize, physMem_, static_cast<Word>(i)));
+    hart->configureTLB(config.tlbSize, config.tlbWays);
+  }
+  priorities_.resize(numHarts);
+}
+
+HartScheduler::Stats MultiHart::run(std::size_t numThreads,
+                                    std::uint64_t sliceBlocks) {
+  HartScheduler scheduler{numThreads, sliceBlocks};
+  for (std::size_t i = 0; i < harts_.size(); ++i)
+    scheduler.add(*harts_[i], priorities_[i]);
+  return scheduler.run();
+}
+
+std::uint64_t MultiHart::getNumInstrs() const {
+  std::uint64_t res{};
+  // Instructions are numbered from 1
+  for (const auto &hart : harts_)
+    res += hart->getInstrCount() - 1;
+  return res;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,78 @@
+#include <algorithm>
+
+#include "hart/profiler.hh"
+
+namespace sim {
+
+namespace {
+
+bool isLinkReg(RegId reg) { return reg == 1 || reg == 5; }
+
+} // namespace
+
+//~~~~~Profiler class functions~~~~~
+
+Profiler::Profiler(std::vector<ELFLoader::Symbol> symbols,
+                   std::uint64_t period, Addr pc, std::uint64_t instrCount)
+    : symbols_(std::move(symbols)), period_(std::max<std::uint64_t>(period, 1)),
+      nextSample_(instrCount) {
+  callStack_.push_back(Frame{pc, 0});
+}
+
+void Profiler::sample(Addr addr) {
+  std::vector<Addr> stack{};
+  stack.reserve(callStack_.size() + 1);
+  for (const auto &frame : callStack_)
+    stack.push_back(getFunction(frame.callee));
+
+  // Leaf differs from the top frame after tail calls & in code w/o symbols
+  if (auto leaf = getFunction(addr); stack.back() != leaf)
+    stack.push_back(leaf);
+
+  ++samples_[std::move(stack)];
+  ++numSamples_;
+}
+
+void Profiler::onJump(const Instruction &inst, Addr addr, Addr target) {
+  if (isLinkReg(inst.rd)) {
+    callStack_.push_back(Frame{target, addr + kXLENInBytes});
+    return;
+  }
+  if (inst.type != OpType::JALR || !isLinkReg(inst.rs1))
+    return;
+
+  // Return may skip frames (e.g. longjmp), unmatched ones are ignored. The
+  // root frame is never popped.
+  auto frame = std::find_if(callStack_.rbegin(), callStack_.rend() - 1,
+                            [target](const auto &cur) {
+                              return cur.ret == target;
+                            });
+  if (frame != callStack_.rend() - 1)
+    callStack_.erase(std::next(frame).base(), callStack_.end());
+}
+
+Addr Profiler::getFunction(Addr addr) const {
+  const auto *sym = symbols_.find(addr);
+  return sym == nullptr ? addr : sym->addr;
+}
+
+void Profiler::write(std::ostream &ost) const {
+  // Different addresses may share a name (e.g. static functions)
+  std::map<std::string, std::uint64_t> folded{};
+  for (const auto &[stack, count] : samples_) {
+    std::string line{};
+    for (auto func : stack) {
+      if (!line.empty())
+        line += ';';
+      line += symbols_.str(func);
+    }
+    folded[line] += count;
+  }
+
+  for (const auto &[line, count] : folded)
+    ost << line << ' ' << count << '\n';
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "hart/program_image.hh"
+
+namespace sim {
+
+void loadSegments(const ELFLoader &loader, Memory &mem) {
+  for (auto segmentIdx : loader.getLoadableSegments()) {
+    auto text = loader.getSegment(segmentIdx);
+    auto addr = loader.getSegmentAddr(segmentIdx);
+    mem.storeRange(addr, text.begin(), text.end());
+
+    auto fileSize = static_cast<Addr>(loader.getSegmentFileSize(segmentIdx));
+    auto memSize = static_cast<Addr>(loader.getSegmentMemorySize(segmentIdx));
+    for (; fileSize < memSize; fileSize += kXLENInBytes)
+      mem.storeEntity<Word>(addr + fileSize, Word{});
+  }
+}
+
+//~~~~~ProgramImage class functions~~~~~
+
+ProgramImage::ProgramImage(const ELFLoader &loader)
+    : entryPoint_{loader.getEntryPoint()} {
+  for (auto segmentIdx : loader.getLoadableSegments()) {
+    if (loader.isSegmentWritable(segmentIdx))
+      continue;
+    auto begin = loader.getSegmentAddr(segmentIdx);
+    auto size = static_cast<Addr>(loader.getSegmentMemorySize(segmentIdx));
+    readOnly_.emplace_back(begin, begin + size);
+  }
+
+  Memory mem{};
+  loadSegments(loader, mem);
+  const auto &pages = mem.getPages();
+  for (const auto &[ppn, page] : pages)
+    ppns_.push_back(ppn);
+
+  fd_ = memfd_create("program_image", MFD_CLOEXEC);
+  if (fd_ < 0)
+    throw std::runtime_error{"Failed to create program image file"};
+
+  auto size = ppns_.size() * kPageSize;
+  if (size == 0)
+    return;
+  void *addr = MAP_FAILED;
+  if (ftruncate(fd_, static_cast<off_t>(size)) == 0)
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (addr == MAP_FAILED) {
+    // Destructor is not called if constructor throws
+    close(fd_);
+    throw std::runtime_error{"Failed to fill program image"};
+  }
+
+  auto *data = static_cast<Byte *>(addr);
+  for (auto ppn : ppns_) {
+    std::memcpy(data, pages.find(ppn)->words().data(), kPageSize);
+    data += kPageSize;
+  }
+  munmap(addr, size);
+}
+
+ProgramImage::~ProgramImage() { close(fd_); }
+
+void ProgramImage::mapInto(Memory &mem) const {
+  std::vector<std::pair<std::uint32_t, Word *>> pages{};
+  std::shared_ptr<void> mapping{};
+  if (auto size = ppns_.size() * kPageSize; size != 0) {
+    void *addr =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED)
+      throw std::runtime_error{"Failed to map program image"};
+    mapping = std::shared_ptr<void>{addr,
+                                    [size](void *ptr) { munmap(ptr, size); }};
+
+    auto *data = static_cast<Byte *>(addr);
+    pages.reserve(ppns_.size());
+    for (auto ppn : ppns_) {
+      pages.emplace_back(ppn, reinterpret_cast<Word *>(data));
+      data += kPageSize;
+    }
+  }
+  mem.mapPages(pages, std::move(mapping));
+}
+
+const BasicBlock *ProgramImage::findBlock(Addr entry) const {
+  std::shared_lock lock{blocksMutex_};
+  auto found = blocks_.find(entry);
+  return found != blocks_.end() ? &found->second : nullptr;
+}
+
+void ProgramImage::addBlock(Addr entry, const BasicBlock &bb) const {
+  auto end = entry + static_cast<Addr>(bb.size() * kXLENInBytes);
+  if (!isReadOnly(entry, end))
+    return;
+
+  std::unique_lock lock{blocksMutex_};
+  blocks_.try_emplace(entry, bb);
+}
+
+bool ProgramImage::isReadOnly(Addr begin, Addr end) const {
+  return std::any_of(readOnly_.begin(), readOnly_.end(), [&](auto range) {
+    return range.first <= begin && end <= range.second;
+  });
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "hart/scheduler.hh"
+
+namespace sim {
+
+namespace {
+
+/* Heap order: earlier deadline first, then the one queued earlier */
+template <typename EntryT> bool isLater(const EntryT &lhs, const EntryT &rhs) {
+  if (lhs.deadline != rhs.deadline)
+    return lhs.deadline > rhs.deadline;
+  return lhs.seq > rhs.seq;
+}
+
+} // namespace
+
+//~~~~~HartScheduler class functions~~~~~
+
+HartScheduler::HartScheduler(std::size_t numThreads, std::uint64_t sliceBlocks)
+    : sliceBlocks_{sliceBlocks} {
+  if (numThreads == 0)
+    throw std::invalid_argument{"At least one thread is required"};
+  if (sliceBlocks == 0)
+    throw std::invalid_argument{"Time slice must be non-zero"};
+
+  for (std::size_t i = 0; i < numThreads; ++i)
+    queues_.push_back(std::make_unique<Queue>());
+}
+
+void HartScheduler::add(Hart &hart, int priority) {
+  auto &queue = *queues_[harts_.size() % queues_.size()];
+  harts_.push_back(&hart);
+  push(queue, Entry{hart.runTask(sliceBlocks_), priority, 0, 0});
+  numLive_.fetch_add(1, std::memory_order_relaxed);
+}
+
+HartScheduler::Stats HartScheduler::run() {
+  {
+    std::vector<std::jthread> threads{};
+    // Extra threads would have nothing but stealing to do
+    auto numThreads = std::min(queues_.size(), harts_.size());
+    for (std::size_t i = 0; i < numThreads; ++i)
+      threads.emplace_back([this, i] { work(i); });
+  }
+
+  if (auto error = std::exchange(error_, {}))
+    std::rethrow_exception(error);
+  return Stats{numSlices_.exchange(0), numSteals_.exchange(0)};
+}
+
+void HartScheduler::push(Queue &queue, Entry entry) {
+  {
+    std::lock_guard lock{queue.mutex};
+    entry.seq = queue.nextSeq++;
+    // Deadline is fixed while queued, so heap order holds
+    entry.deadline = static_cast<std::int64_t>(entry.seq) -
+                     std::int64_t{entry.priority} * kAgingSlices;
+    queue.heap.push_back(std::move(entry));
+    std::ranges::push_heap(queue.heap, isLater<Entry>);
+  }
+  epoch_.fetch_add(1, std::memory_order_release);
+  epoch_.notify_one();
+}
+
+std::optional<HartScheduler::Entry> HartScheduler::pop(Queue &queue) {
+  std::lock_guard lock{queue.mutex};
+  if (queue.heap.empty())
+    return std::nullopt;
+
+  std::ranges::pop_heap(queue.heap, isLater<Entry>);
+  auto entry = std::move(queue.heap.back());
+  queue.heap.pop_back();
+  return entry;
+}
+
+std::optional<HartScheduler::Entry>
+HartScheduler::pick(std::size_t threadIdx) {
+  if (auto entry = pop(*queues_[threadIdx]))
+    return entry;
+
+  for (std::size_t i = 1; i < queues_.size(); ++i) {
+    auto &victim = *queues_[(threadIdx + i) % queues_.size()];
+    if (auto entry = pop(victim)) {
+      numSteals_.fetch_add(1, std::memory_order_relaxed);
+      return entry;
+    }
+  }
+  return std::nullopt;
+}
+
+void HartScheduler::work(std::size_t threadIdx) {
+  std::uint64_t numSlices{};
+  for (;;) {
+    // Epoch is read first: task queued or finished after that wakes us up
+    auto epoch = epoch_.load(std::memory_order_acquire);
+    if (numLive_.load(std::memory_order_acquire) == 0)
+      break;
+    auto entry = pick(threadIdx);
+    if (!entry) {
+      // The rest of tasks are being run by other threads
+      epoch_.wait(epoch, std::memory_order_acquire);
+      continue;
+    }
+
+    ++numSlices;
+    bool isDone = true;
+    try {
+      isDone = entry->task.resume();
+    } catch (...) {
+      fail(std::current_exception());
+    }
+
+    if (!isDone)
+      push(*queues_[threadIdx], std::move(*entry));
+    else if (numLive_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // Idle threads are waiting for tasks which will never come
+      epoch_.fetch_add(1, std::memory_order_release);
+      epoch_.notify_all();
+    }
+  }
+  numSlices_.fetch_add(numSlices, std::memory_order_relaxed);
+}
+
+void HartScheduler::fail(std::exception_ptr error) {
+  {
+    std::lock_guard lock{errorMutex_};
+    if (!error_)
+      error_ = std::move(error);
+  }
+  // Others might wait for the failed hart forever
+  for (auto *hart : harts_)
+    hart->requestStop();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
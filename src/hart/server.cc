@@ -0,0 +1,345 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "hart/server.hh"
+
+namespace sim {
+
+namespace {
+
+// Requests are short, longer lines are not jobs
+constexpr std::size_t kMaxLine = 4096;
+
+/* Closes descriptor on scope exit */
+class Socket final {
+public:
+  explicit Socket(int fd) : fd_{fd} {}
+  Socket(const Socket &) = delete;
+  Socket(Socket &&) = delete;
+  Socket &operator=(const Socket &) = delete;
+  Socket &operator=(Socket &&) = delete;
+  ~Socket() {
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  [[nodiscard]] int get() const { return fd_; }
+
+private:
+  int fd_{-1};
+};
+
+std::system_error makeError(const std::string &what) {
+  return std::system_error{errno, std::generic_category(), what};
+}
+
+sockaddr_un makeAddr(const fs::path &socket) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  const auto &path = socket.native();
+  // Path is null-terminated
+  if (path.size() >= sizeof(addr.sun_path))
+    throw std::invalid_argument{"Socket path is too long: " + path};
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return addr;
+}
+
+int openSocket() {
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    throw makeError("Failed to create socket");
+  return fd;
+}
+
+bool connectTo(int fd, const sockaddr_un &addr) {
+  return connect(fd, reinterpret_cast<const sockaddr *>(&addr),
+                 sizeof(addr)) == 0;
+}
+
+void writeAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    // Broken connection must not kill the process w/ SIGPIPE
+    auto res = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (res < 0 && errno == EINTR)
+      continue;
+    if (res < 0)
+      throw makeError("Failed to send");
+    data.remove_prefix(static_cast<std::size_t>(res));
+  }
+}
+
+/* Read one byte, false at the end of stream */
+bool readByte(int fd, char &byte) {
+  for (;;) {
+    auto res = recv(fd, &byte, 1, 0);
+    if (res >= 0)
+      return res == 1;
+    if (errno != EINTR)
+      throw makeError("Failed to receive");
+  }
+}
+
+/* Read line w/o '\n', false if stream has ended before any byte */
+bool readLine(int fd, std::string &line) {
+  line.clear();
+  for (char byte{}; readByte(fd, byte);) {
+    if (byte == '\n')
+      return true;
+    if (line.size() == kMaxLine)
+      throw std::runtime_error{"Too long line received"};
+    line.push_back(byte);
+  }
+  if (!line.empty())
+    throw std::runtime_error{"Connection closed in the middle of line"};
+  return false;
+}
+
+std::string readExact(int fd, std::size_t size) {
+  std::string res(size, '\0');
+  for (std::size_t done = 0; done < size;) {
+    auto got = recv(fd, res.data() + done, size - done, 0);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got < 0)
+      throw makeError("Failed to receive");
+    if (got == 0)
+      throw std::runtime_error{"Connection closed in the middle of response"};
+    done += static_cast<std::size_t>(got);
+  }
+  return res;
+}
+
+/* Whether client has closed its connection or its end for writing */
+bool isHungUp(int fd) {
+  pollfd pfd{fd, POLLRDHUP, 0};
+  if (poll(&pfd, 1, 0) <= 0)
+    return false;
+  return (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR)) != 0;
+}
+
+std::string formatResult(const BatchResult &res, const std::string &console) {
+  return fmt::format("{} {} {} {} {} {} {} {}\n{}{}",
+                     BatchResult::getStatusName(res.status), res.exitCode,
+                     res.numInstrs, res.timeMcs, res.numDecodedBlocks,
+                     res.numSharedBlocks, console.size(), res.error.size(),
+                     console, res.error);
+}
+
+} // namespace
+
+//~~~~~JobServer class functions~~~~~
+
+JobServer::JobServer(fs::path socket, HartConfig config,
+                     std::size_t numThreads)
+    : socket_{std::move(socket)}, numThreads_{numThreads}, runner_{config} {
+  if (numThreads == 0)
+    throw std::invalid_argument{"At least one thread is required"};
+
+  auto addr = makeAddr(socket_);
+  listenFd_ = openSocket();
+  try {
+    // Socket file is left behind if server was killed
+    if (auto status = fs::symlink_status(socket_); fs::exists(status)) {
+      if (!fs::is_socket(status))
+        throw std::runtime_error{socket_.string() + " is not a socket"};
+      Socket probe{openSocket()};
+      if (connectTo(probe.get(), addr))
+        throw std::runtime_error{"Server is already running on " +
+                                 socket_.string()};
+      fs::remove(socket_);
+    }
+
+    if (bind(listenFd_, reinterpret_cast<const sockaddr *>(&addr),
+             sizeof(addr)) != 0)
+      throw makeError("Failed to bind " + socket_.string());
+    if (listen(listenFd_, SOMAXCONN) != 0)
+      throw makeError("Failed to listen on " + socket_.string());
+  } catch (...) {
+    // Destructor is not called if constructor throws
+    close(listenFd_);
+    throw;
+  }
+}
+
+JobServer::~JobServer() {
+  close(listenFd_);
+  std::error_code ec{};
+  fs::remove(socket_, ec);
+}
+
+void JobServer::run() {
+  {
+    std::vector<std::jthread> workers{};
+    for (std::size_t i = 0; i < numThreads_; ++i)
+      workers.emplace_back([this] { work(); });
+  }
+
+  std::lock_guard lock{connsMutex_};
+  if (auto error = std::exchange(error_, {}))
+    std::rethrow_exception(error);
+}
+
+void JobServer::stop() {
+  {
+    std::lock_guard lock{connsMutex_};
+    isStopped_ = true;
+    // Clients get results of stopped jobs & see the end of stream then
+    for (auto [conn, hart] : conns_) {
+      shutdown(conn, SHUT_RD);
+      if (hart)
+        hart->requestStop();
+    }
+  }
+  // Wakes up workers waiting in accept
+  shutdown(listenFd_, SHUT_RDWR);
+}
+
+void JobServer::work() {
+  for (;;) {
+    int conn = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (conn >= 0) {
+      serve(conn);
+      continue;
+    }
+
+    auto error = makeError("Failed to accept connection");
+    {
+      std::lock_guard lock{connsMutex_};
+      if (isStopped_)
+        return;
+    }
+    if (error.code() == std::errc::interrupted ||
+        error.code() == std::errc::connection_aborted)
+      continue;
+    fail(std::make_exception_ptr(error));
+    return;
+  }
+}
+
+void JobServer::serve(int conn) {
+  Socket guard{conn};
+  {
+    std::lock_guard lock{connsMutex_};
+    if (isStopped_)
+      return;
+    conns_.emplace(conn, nullptr);
+  }
+
+  JobHooks hooks{};
+  hooks.setHart = [this, conn](Hart *hart) { setHart(conn, hart); };
+  // Nobody waits for result of job once client has gone
+  hooks.isCancelled = [conn] { return isHungUp(conn); };
+
+  try {
+    for (std::string line{}; readLine(conn, line);) {
+      BatchResult res{};
+      std::ostringstream console{};
+      try {
+        auto job = parseBatchJob(line);
+        if (!job)
+          throw std::runtime_error{"Empty job"};
+        if (!job->console.empty())
+          throw std::runtime_error{"Console file is not supported"};
+        res = runner_.runJob(*job, console, hooks);
+        numJobs_.fetch_add(1, std::memory_order_relaxed);
+      } catch (const std::runtime_error &e) {
+        res.error = e.what();
+      }
+      writeAll(conn, formatResult(res, console.str()));
+    }
+  } catch (const std::exception &) {
+    // Broken connection only drops its client
+  }
+
+  std::lock_guard lock{connsMutex_};
+  conns_.erase(conn);
+}
+
+void JobServer::setHart(int conn, Hart *hart) {
+  std::lock_guard lock{connsMutex_};
+  conns_.at(conn) = hart;
+  // Server may have been stopped before job has started
+  if (hart && isStopped_)
+    hart->requestStop();
+}
+
+std::size_t JobServer::getNumRunningJobs() const {
+  std::lock_guard lock{connsMutex_};
+  return static_cast<std::size_t>(std::count_if(
+      conns_.begin(), conns_.end(),
+      [](const auto &conn) { return conn.second != nullptr; }));
+}
+
+void JobServer::fail(std::exception_ptr error) {
+  {
+    std::lock_guard lock{connsMutex_};
+    if (!error_)
+      error_ = std::move(error);
+  }
+  // Other workers would wait for connections forever
+  stop();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+BatchResult submitJob(const fs::path &socket, const BatchJob &job,
+                      std::string &console) {
+  if (!job.console.empty())
+    throw std::invalid_argument{"Console file is not supported by server"};
+
+  auto addr = makeAddr(socket);
+  Socket conn{openSocket()};
+  if (!connectTo(conn.get(), addr))
+    throw makeError("Failed to connect to " + socket.string());
+
+  // Server may run in another directory
+  auto request = fs::absolute(job.executable).string();
+  if (job.maxInstrs != Hart::kNoStop)
+    request += " max-instrs=" + std::to_string(job.maxInstrs);
+  writeAll(conn.get(), request + '\n');
+
+  std::string header{};
+  if (!readLine(conn.get(), header))
+    throw std::runtime_error{"Server has closed connection"};
+
+  BatchResult res{};
+  std::string status{};
+  std::size_t consoleSize{};
+  std::size_t errorSize{};
+  std::istringstream ist{header};
+  ist >> status >> res.exitCode >> res.numInstrs >> res.timeMcs >>
+      res.numDecodedBlocks >> res.numSharedBlocks >> consoleSize >> errorSize;
+  if (!ist)
+    throw std::runtime_error{"Bad response header '" + header + "'"};
+
+  bool isKnown = false;
+  for (auto st : {BatchResult::COMPLETED, BatchResult::LIMIT,
+                  BatchResult::FAILED, BatchResult::STOPPED})
+    if (status == BatchResult::getStatusName(st)) {
+      res.status = st;
+      isKnown = true;
+    }
+  if (!isKnown)
+    throw std::runtime_error{"Unknown job status '" + status + "'"};
+
+  console = readExact(conn.get(), consoleSize);
+  res.error = readExact(conn.get(), errorSize);
+  return res;
+}
+
+} // namespace sim
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include <unistd.h>
+
+#include "common/counters.hh"
+#include "common/timer.hh"
+#include "hart/hart.hh"
+#include "hart/simpoint.hh"
+
+namespace sim {
+
+namespace {
+
+/* Numbers from SimPoint file by simpoint id */
+template <typename T>
+std::map<std::size_t, T> loadSimPointFile(const fs::path &file) {
+  std::ifstream ist{file};
+  if (!ist)
+    throw std::runtime_error{"Failed to open " + file.string()};
+
+  std::map<std::size_t, T> res{};
+  T val{};
+  std::size_t id{};
+  while (ist >> val >> id)
+    res[id] = val;
+  if (!ist.eof())
+    throw std::runtime_error{"Bad SimPoint file: " + file.string()};
+  return res;
+}
+
+TLB::TLBStats operator-(const TLB::TLBStats &lhs, const TLB::TLBStats &rhs) {
+  TLB::TLBStats res{};
+  res.TLBHits = lhs.TLBHits - rhs.TLBHits;
+  res.TLBMisses = lhs.TLBMisses - rhs.TLBMisses;
+  res.TLBRequests = lhs.TLBRequests - rhs.TLBRequests;
+  return res;
+}
+
+/* Removes checkpoint files on destruction */
+class CheckpointFiles final {
+public:
+  explicit CheckpointFiles(std::size_t size) : files_(size) {}
+  CheckpointFiles(const CheckpointFiles &) = delete;
+  CheckpointFiles(CheckpointFiles &&) = delete;
+  CheckpointFiles &operator=(const CheckpointFiles &) = delete;
+  CheckpointFiles &operator=(CheckpointFiles &&) = delete;
+  ~CheckpointFiles() {
+    std::error_code ec{};
+    for (const auto &file : files_)
+      if (!file.empty())
+        fs::remove(file, ec);
+  }
+
+  fs::path &operator[](std::size_t idx) { return files_[idx]; }
+
+private:
+  std::vector<fs::path> files_;
+};
+
+} // namespace
+
+std::vector<SimPoint> loadSimPoints(const fs::path &simpoints,
+                                    const fs::path &weights) {
+  auto intervals = loadSimPointFile<std::uint64_t>(simpoints);
+  auto weightsById = loadSimPointFile<double>(weights);
+
+  std::vector<SimPoint> res{};
+  for (auto [id, interval] : intervals) {
+    auto weight = weightsById.find(id);
+    if (weight == weightsById.end())
+      throw std::runtime_error{"No weight for simpoint " + std::to_string(id)};
+    res.push_back({interval, weight->second});
+  }
+  return res;
+}
+
+//~~~~~IntervalSampler class functions~~~~~
+
+IntervalSampler::IntervalSampler(fs::path executable, HartConfig config,
+                                 std::uint64_t intervalSize)
+    : executable_(std::move(executable)), config_(config),
+      intervalSize_(intervalSize) {
+  if (!intervalSize_)
+    throw std::invalid_argument{"Interval size has to be positive"};
+}
+
+std::vector<IntervalResult>
+IntervalSampler::run(const std::vector<SimPoint> &points,
+                     std::size_t numThreads,
+                     const fs::path &checkpointDir) const {
+  fs::create_directories(checkpointDir);
+  CheckpointFiles checkpoints{points.size()};
+
+  // Fast-forward pass visits intervals in order
+  std::vector<std::size_t> order(points.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](auto lhs, auto rhs) {
+    return points[lhs].interval < points[rhs].interval;
+  });
+
+  {
+    Hart hart{executable_, config_.bbCacheSize};
+    hart.configureTLB(config_.tlbSize, config_.tlbWays);
+    for (auto idx : order) {
+      // Instructions are numbered from 1
+      if (hart.run(points[idx].interval * intervalSize_ + 1))
+        break;
+      checkpoints[idx] = checkpointDir / fmt::format("simpoint.{}.{}.ckpt",
+                                                     getpid(), idx);
+      hart.saveCheckpoint(checkpoints[idx]);
+    }
+  }
+
+  std::vector<std::optional<IntervalResult>> results(points.size());
+  std::vector<std::exception_ptr> errors(points.size());
+  std::atomic<std::size_t> next{};
+  {
+    std::vector<std::jthread> workers{};
+    for (std::size_t i = 0; i < std::max<std::size_t>(numThreads, 1); ++i)
+      workers.emplace_back([&] {
+        for (auto idx = next++; idx < points.size(); idx = next++) {
+          if (checkpoints[idx].empty())
+            continue;
+          try {
+            results[idx] = runInterval(points[idx], checkpoints[idx]);
+          } catch (...) {
+            errors[idx] = std::current_exception();
+          }
+        }
+      });
+  }
+
+  for (const auto &error : errors)
+    if (error)
+      std::rethrow_exception(error);
+
+  std::vector<IntervalResult> res{};
+  for (auto &result : results)
+    if (result)
+      res.push_back(*result);
+  return res;
+}
+
+IntervalResult IntervalSampler::runInterval(const SimPoint &point,
+                                            const fs::path &checkpoint) const {
+  Hart hart{executable_, config_.bbCacheSize};
+  hart.configureTLB(config_.tlbSize, config_.tlbWays);
+  hart.restoreCheckpoint(checkpoint);
+  hart.enableBlockStats();
+
+  // Statistics are restored from checkpoint as well
+  auto instrTLBStats = hart.getMemory().getInstrTLBStats();
+  auto dataTLBStats = hart.getMemory().getDataTLBStats();
+  auto start = hart.getInstrCount();
+
+  IntervalResult res{};
+  res.point = point;
+  timer::Timer timer{};
+  hart.run(start + intervalSize_);
+  res.timeMcs = static_cast<std::uint64_t>(timer.elapsedMcs());
+  res.numInstrs = hart.getInstrCount() - start;
+  res.instrTLBStats = hart.getMemory().getInstrTLBStats() - instrTLBStats;
+  res.dataTLBStats = hart.getMemory().getDataTLBStats() - dataTLBStats;
+
+  std::uint64_t numExecs{};
+  std::uint64_t numMisses{};
+  double numCycles{};
+  for (const auto &[entry, block] : hart.getBlockStats()->getBlocks()) {
+    numExecs += block.counters.numExecs;
+    numMisses += block.counters.numMisses;
+
+    // Partially executed blocks are accounted w/ average throughput
+    double blockCycles{};
+    for (const auto &inst : block.bb)
+      blockCycles += Counters::getThroughput(inst.type);
+    numCycles += blockCycles * static_cast<double>(block.counters.numInstrs) /
+                 static_cast<double>(block.bb.size());
+  }
+  res.numCycles = static_cast<std::uint64_t>(numCycles);
+  auto numHits = numExecs - std::min(numExecs, numMisses);
+  res.bbCacheHitRate = numExecs ? 100.0 * static_cast<double>(numHits) /
+                                      static_cast<double>(numExecs)
+                                : 0.0;
+  return res;
+}
+
+void IntervalSampler::print(std::ostream &ost,
+                            const std::vector<IntervalResult> &results) {
+  ost << fmt::format("{:>10} {:>8} {:>14} {:>8} {:>10} {:>8} {:>9} {:>9}\n",
+                     "Interval", "Weight", "Instructions", "CPI", "MIPS",
+                     "BBC hit", "ITLB hit", "DTLB hit");
+
+  double totalWeight{};
+  double cpi{};
+  double bbCacheHitRate{};
+  double instrTLBHitRate{};
+  double dataTLBHitRate{};
+  std::uint64_t timeMcs{};
+  for (const auto &res : results) {
+    auto mips = res.timeMcs ? static_cast<double>(res.numInstrs) /
+                                  static_cast<double>(res.timeMcs)
+                            : 0.0;
+    ost << fmt::format("{:>10} {:>8.4f} {:>14} {:>8.3f} {:>10.2f} {:>7.2f}% "
+                       "{:>8.2f}% {:>8.2f}%\n",
+                       res.point.interval, res.point.weight, res.numInstrs,
+                       res.getCPI(), mips, res.bbCacheHitRate,
+                       res.instrTLBStats.hitRate(), res.dataTLBStats.hitRate());
+
+    auto weight = res.point.weight;
+    totalWeight += weight;
+    cpi += weight * res.getCPI();
+    bbCacheHitRate += weight * res.bbCacheHitRate;
+    instrTLBHitRate += weight * res.instrTLBStats.hitRate();
+    dataTLBHitRate += weight * res.dataTLBStats.hitRate();
+    timeMcs += res.timeMcs;
+  }
+
+  // Dropped intervals do not count
+  if (totalWeight <= 0.0)
+    return;
+  ost << fmt::format("{:>10} {:>8.4f} {:>14} {:>8.3f} {:>10} {:>7.2f}% "
+                     "{:>8.2f}% {:>8.2f}%\n",
+                     "Weighted", totalWeight, "", cpi / totalWeight, "",
+                     bbCacheHitRate / totalWeight,
+                     instrTLBHitRate / totalWeight,
+                     dataTLBHitRate / totalWeight);
+  ost << "Host time of detailed runs: " << timeMcs << " us\n";
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -1,3 +1,8 @@
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
 #include "memory/memory.hh"
 
 namespace sim {
@@ -11,45 +16,327 @@ void Memory::printMemStats(std::ostream &ost) const {
   ost << "End of memory stats." << std::endl;
 }
 
+void Memory::printTLBStats(std::ostream &ost) const {
+  auto printSide = [&ost](std::string_view name, const TLB::TLBStats &st) {
+    ost << name << " TLB HitRate: " << std::fixed << std::setprecision(2)
+        << st.hitRate() << "% (" << st.TLBHits << "/" << st.TLBRequests << ")"
+        << std::endl;
+  };
+  printSide("Instr", getInstrTLBStats());
+  printSide("Data", getDataTLBStats());
+}
+
 const Memory::MemoryStats &Memory::getMemStats() const { return stats; }
 
+Word Memory::loadReserved(Addr addr) {
+  stats.numLoads++;
+  auto *word = getEntity<Word, PhysMemory::MemoryOp::LOAD>(addr);
+  auto res = std::atomic_ref<Word>{*word}.load();
+  reservation_.emplace(addr, res);
+  return res;
+}
+
+bool Memory::storeConditional(Addr addr, Word val) {
+  auto reservation = std::exchange(reservation_, std::nullopt);
+  if (!reservation || reservation->first != addr)
+    return false;
+
+  auto *word = getEntity<Word, PhysMemory::MemoryOp::STORE>(addr);
+  auto expected = reservation->second;
+  if (!std::atomic_ref<Word>{*word}.compare_exchange_strong(expected, val))
+    return false;
+  stats.numStores++;
+  onStore(addr, val);
+  return true;
+}
+
+void Memory::configureTLB(std::size_t numEntries, std::size_t numWays) {
+  instrTLB = TLB{numEntries, numWays};
+  dataTLB = TLB{numEntries, numWays};
+}
+
+void Memory::flushTLB() {
+  instrTLB.tlbFlush();
+  dataTLB.tlbFlush();
+}
+
+void Memory::clearDirty(PhysMemory::DirtyTracker tracker) {
+  physMem->clearDirty(tracker);
+  // Revoke "writable since epoch" permission from data TLB entries
+  dataTLB.tlbFlush();
+}
+
+PhysMemory::Snapshot Memory::takeSnapshot() {
+  auto res = physMem->takeSnapshot();
+  dataTLB.tlbFlush();
+  return res;
+}
+
+void Memory::updateSnapshot(PhysMemory::Snapshot &snapshot) {
+  physMem->updateSnapshot(snapshot);
+  dataTLB.tlbFlush();
+}
+
+void Memory::restoreSnapshot(const PhysMemory::Snapshot &snapshot) {
+  reservation_.reset();
+  if (physMem->restoreSnapshot(snapshot))
+    flushTLB();
+  else
+    dataTLB.tlbFlush();
+}
+
+MMIODevice *Memory::addDevice(Addr base, std::unique_ptr<MMIODevice> device) {
+  auto *res = physMem->addDevice(base, std::move(device));
+  // Device might shadow RAM pages cached already
+  flushTLB();
+  return res;
+}
+
+void Memory::mapPages(
+    const std::vector<std::pair<std::uint32_t, Word *>> &pages,
+    std::shared_ptr<void> owner) {
+  physMem->mapPages(pages, std::move(owner));
+  reservation_.reset();
+  flushTLB();
+  mmu.flushWalkCache();
+  ++translationEpoch;
+}
+
+void Memory::setSatp(RegVal satp) {
+  // Cached bare-mode translations are global, so they have to go away
+  // when paging is switched. ASID-tagged ones may stay till SFENCE.VMA.
+  if (mmu.setSatp(satp))
+    flushTLB();
+  ++translationEpoch;
+}
+
+void Memory::sfenceVMA(std::optional<Addr> addr,
+                       std::optional<MMU::ASID> asid) {
+  instrTLB.tlbFlush(addr, asid);
+  dataTLB.tlbFlush(addr, asid);
+  mmu.flushWalkCache();
+  ++translationEpoch;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//~~~~~PhysMemory class functions~~~~~
+
 uint16_t PhysMemory::getOffset(Addr addr) {
   return static_cast<uint16_t>(getBits<kOffsetBits - 1, 0>(addr));
 }
 
+Word &PhysMemory::getPhysWord(Addr paddr) {
+  AddrSections sections(paddr);
+  auto *page = pageTableLookup<MemoryOp::LOAD>(sections);
+  return page->words()[sections.offset / sizeof(Word)];
+}
+
+std::vector<std::uint32_t>
+PhysMemory::getDirtyPages(DirtyTracker tracker) const {
+  const auto &dirtyMap = dirtyMaps[tracker];
+  std::vector<std::uint32_t> res{};
+  for (std::size_t i = 0; i < dirtyMap.size(); ++i)
+    for (auto bits = dirtyMap[i].load(std::memory_order_relaxed); bits;
+         bits &= bits - 1) {
+      auto bit = static_cast<std::size_t>(std::countr_zero(bits));
+      res.push_back(static_cast<std::uint32_t>(i * kBitsInDirtyWord + bit));
+    }
+
+  return res;
+}
+
+void PhysMemory::clearDirty(DirtyTracker tracker) {
+  for (auto &bits : dirtyMaps[tracker])
+    bits.store(DWord{}, std::memory_order_relaxed);
+}
+
+PhysMemory::Snapshot PhysMemory::takeSnapshot() {
+  clearDirty();
+  Snapshot res{};
+  for (const auto &[ppn, page] : pageTable)
+    res.pages.emplace(ppn, page);
+  return res;
+}
+
+void PhysMemory::updateSnapshot(Snapshot &snapshot) {
+  for (auto ppn : getDirtyPages())
+    if (const auto *page = pageTable.find(ppn))
+      snapshot.pages[ppn] = *page;
+  clearDirty();
+}
+
+bool PhysMemory::restoreSnapshot(const Snapshot &snapshot) {
+  bool isErased = false;
+  for (auto ppn : getDirtyPages()) {
+    if (auto it = snapshot.pages.find(ppn); it != snapshot.pages.end()) {
+      // Copy into the same page object: TLB entries stay valid
+      if (auto *page = pageTable.find(ppn))
+        *page = it->second;
+      else
+        pageTable.insert(ppn, it->second);
+      continue;
+    }
+
+    // Page appeared after snapshot
+    pageTable.erase(ppn);
+    isErased = true;
+  }
+
+  clearDirty();
+  return isErased;
+}
+
+MMIODevice *PhysMemory::addDevice(Addr base,
+                                  std::unique_ptr<MMIODevice> device) {
+  return bus.addDevice(base, std::move(device));
+}
+
+void PhysMemory::mapPages(
+    const std::vector<std::pair<std::uint32_t, Word *>> &pages,
+    std::shared_ptr<void> owner) {
+  pageTable.clear();
+  for (auto [ppn, storage] : pages)
+    pageTable.insert(ppn, Page{storage});
+
+  storageOwners.push_back(std::move(owner));
+  clearDirty(SNAPSHOT);
+  clearDirty(HASH);
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-//~~~~~TLB class functions~~~~~~~~
-TLB::TLBIndex TLB::getTLBIndex(Addr addr) {
-  return static_cast<TLB::TLBIndex>(
-      getBits<(kTLBBits + kOffsetBits - 1), kOffsetBits>(addr));
-}
-
-PagePtr TLB::tlbLookup(Addr addr) {
-  stats.TLBRequests++;
-  auto idx = getTLBIndex(addr);
-  auto found = tlb[idx];
-  if (!found.valid) {
-    stats.TLBMisses++;
-    return nullptr;
+//~~~~~PageTable class functions~~~~~
+
+PageTable::~PageTable() {
+  clear();
+  for (auto &entry : dir_)
+    delete entry.load(std::memory_order_relaxed);
+}
+
+std::atomic<PagePtr> &PageTable::getSlot(std::uint32_t ppn) {
+  auto &entry = dir_[ppn >> kLeafBits];
+  auto *leaf = entry.load(std::memory_order_acquire);
+  if (!leaf) {
+    auto fresh = std::make_unique<Leaf>();
+    // On failure leaf is set to the one installed by another thread
+    if (entry.compare_exchange_strong(leaf, fresh.get(),
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire))
+      leaf = fresh.release();
   }
-  if (found.virtualAddress != (addr & kTLBMask)) {
-    stats.TLBMisses++;
-    return nullptr;
+  return (*leaf)[ppn & (kLeafSize - 1)];
+}
+
+PagePtr PageTable::insert(std::uint32_t ppn, Page page) {
+  auto &slot = getSlot(ppn);
+  auto *cur = slot.load(std::memory_order_acquire);
+  if (cur)
+    return cur;
+
+  auto fresh = std::make_unique<Page>(std::move(page));
+  if (!slot.compare_exchange_strong(cur, fresh.get(),
+                                    std::memory_order_acq_rel,
+                                    std::memory_order_acquire))
+    return cur;
+  size_.fetch_add(1, std::memory_order_relaxed);
+  return fresh.release();
+}
+
+void PageTable::erase(std::uint32_t ppn) {
+  auto *leaf = dir_[ppn >> kLeafBits].load(std::memory_order_relaxed);
+  if (!leaf)
+    return;
+  if (auto *page = (*leaf)[ppn & (kLeafSize - 1)].exchange(
+          nullptr, std::memory_order_relaxed)) {
+    delete page;
+    size_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+void PageTable::clear() {
+  for (auto &entry : dir_)
+    if (auto *leaf = entry.load(std::memory_order_relaxed))
+      for (auto &slot : *leaf)
+        delete slot.exchange(nullptr, std::memory_order_relaxed);
+  size_.store(0, std::memory_order_relaxed);
+}
+
+std::uint32_t PageTable::findNext(std::uint32_t ppn) const {
+  while (ppn < kNumPages) {
+    const auto *leaf = dir_[ppn >> kLeafBits].load(std::memory_order_acquire);
+    // Skip the whole leaf if it is missing
+    auto leafEnd = (ppn | (kLeafSize - 1)) + 1;
+    if (!leaf) {
+      ppn = leafEnd;
+      continue;
+    }
+    for (; ppn < leafEnd; ++ppn)
+      if ((*leaf)[ppn & (kLeafSize - 1)].load(std::memory_order_acquire))
+        return ppn;
   }
-  stats.TLBHits++;
-  return found.physPage;
+  return kNumPages;
 }
 
-void TLB::tlbUpdate(Addr addr, PagePtr page) {
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-  auto idx = getTLBIndex(addr);
-  tlb[idx] = TLBEntry((addr & kTLBMask), page, true);
+//~~~~~TLB class functions~~~~~~~~
+TLB::TLB(std::size_t numEntries, std::size_t numWays)
+    : numWays_(numWays), tlb(numEntries) {
+  if (!numWays || numEntries % numWays)
+    throw std::invalid_argument{"TLB ways number must divide entries number"};
+
+  auto numSets = numEntries / numWays;
+  if (!std::has_single_bit(numSets))
+    throw std::invalid_argument{"TLB sets number must be a power of 2"};
+  setMask_ = numSets - 1;
+}
+
+void TLB::tlbUpdate(Addr addr, PagePtr page, ASID asid, std::uint8_t perms,
+                    bool global) {
+  auto *set = getSet(addr);
+  auto key = makeKey(addr, asid);
+
+  // Reuse the way already holding this page, otherwise evict the LRU one
+  auto *victim = std::find_if(set, set + numWays_, [&](const auto &entry) {
+    return entry.matches(key, generation_);
+  });
+  if (victim == set + numWays_)
+    victim = set + numWays_ - 1;
+
+  std::rotate(set, victim, victim + 1);
+  auto mask = global ? kTLBMask : ~Addr{0};
+  *set = TLBEntry(key, mask, page, generation_, perms);
 }
 
 const TLB::TLBStats &TLB::getTLBStats() const { return stats; }
 
-void TLB::tlbFlush() { tlb.clear(); }
+void TLB::tlbFlush() {
+  // Bumping generation invalidates all entries at once. Entries are cleared
+  // for real only when the counter wraps around.
+  if (++generation_ == 0) {
+    std::fill(tlb.begin(), tlb.end(), TLBEntry{});
+    generation_ = 1;
+  }
+}
+
+void TLB::tlbFlush(std::optional<Addr> addr, std::optional<ASID> asid) {
+  if (!addr && !asid) {
+    tlbFlush();
+    return;
+  }
+
+  auto *begin = addr ? getSet(*addr) : tlb.data();
+  auto *end = addr ? begin + numWays_ : tlb.data() + tlb.size();
+  std::for_each(begin, end, [&](auto &entry) {
+    if (addr && (entry.virtualAddress & kTLBMask) != (*addr & kTLBMask))
+      return;
+    if (asid && (entry.isGlobal() || makeKey(0, *asid) !=
+                                         (entry.virtualAddress & ~kTLBMask)))
+      return;
+    entry.generation = 0;
+  });
+}
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -0,0 +1,142 @@
+#include <stdexcept>
+
+#include "memory/mmio.hh"
+
+namespace sim {
+
+//~~~~~UART class functions~~~~~
+
+UART::UART(std::ostream &out, std::size_t bufferSize)
+    : out_(out), bufferSize_(bufferSize) {
+  buffer_.reserve(bufferSize_);
+}
+
+UART::~UART() {
+  try {
+    flush();
+  } catch (...) {
+  }
+}
+
+Word UART::read(Addr offset, std::size_t) {
+  return offset == LSR ? kLSRTxIdle : 0;
+}
+
+void UART::write(Addr offset, Word value, std::size_t) {
+  if (offset != THR)
+    return;
+
+  buffer_.push_back(static_cast<char>(value & 0xFF));
+  if (buffer_.size() >= bufferSize_)
+    flush();
+}
+
+void UART::flush() {
+  if (buffer_.empty())
+    return;
+
+  out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  out_.flush();
+  buffer_.clear();
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//~~~~~CLINT class functions~~~~~
+
+Word CLINT::read(Addr offset, std::size_t) {
+  switch (offset) {
+  case MSIP:
+    return msip_;
+  case MTIMECMP:
+    return static_cast<Word>(mtimecmp_);
+  case MTIMECMP + sizeof(Word):
+    return static_cast<Word>(mtimecmp_ >> sizeofBits<Word>());
+  case MTIME:
+    return static_cast<Word>(getTime_());
+  case MTIME + sizeof(Word):
+    return static_cast<Word>(getTime_() >> sizeofBits<Word>());
+  default:
+    return 0;
+  }
+}
+
+void CLINT::write(Addr offset, Word value, std::size_t) {
+  constexpr DWord kLowerMask = ~Word{0};
+  switch (offset) {
+  case MSIP:
+    msip_ = value & 1;
+    break;
+  case MTIMECMP:
+    mtimecmp_ = (mtimecmp_ & ~kLowerMask) | value;
+    break;
+  case MTIMECMP + sizeof(Word):
+    mtimecmp_ =
+        (mtimecmp_ & kLowerMask) | (DWord{value} << sizeofBits<Word>());
+    break;
+  default:
+    // mtime is driven by simulator
+    break;
+  }
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//~~~~~TestFinisher class functions~~~~~
+
+void TestFinisher::write(Addr offset, Word value, std::size_t) {
+  if (offset != 0)
+    return;
+
+  auto status = getBits<15, 0>(value);
+  if (status == PASS)
+    onExit_(0);
+  else if (status == FAIL)
+    onExit_(static_cast<int>(getBits<31, 16>(value)));
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//~~~~~MMIOBus class functions~~~~~
+
+MMIODevice *MMIOBus::addDevice(Addr base, std::unique_ptr<MMIODevice> device) {
+  auto size = device->getSize();
+  if (base % kPageSize || !size)
+    throw std::invalid_argument{"Device must occupy whole pages"};
+
+  auto firstPage = base >> kOffsetBits;
+  auto lastPage = (base + size - 1) >> kOffsetBits;
+  if (lastPage < firstPage)
+    throw std::invalid_argument{"Device range overflows address space"};
+  for (auto page = firstPage; page <= lastPage; ++page)
+    if (pages_.contains(page))
+      throw std::invalid_argument{"Device ranges overlap"};
+
+  for (auto page = firstPage; page <= lastPage; ++page)
+    pages_.emplace(page, devices_.size());
+
+  auto *res = device.get();
+  devices_.push_back(Mapping{base, std::move(device)});
+  return res;
+}
+
+MMIOBus::Mapping &MMIOBus::getMapping(Addr paddr) {
+  auto it = pages_.find(paddr >> kOffsetBits);
+  if (it == pages_.end())
+    throw std::logic_error{"No device at address"};
+  return devices_[it->second];
+}
+
+Word MMIOBus::read(Addr paddr, std::size_t size) {
+  auto &mapping = getMapping(paddr);
+  return mapping.device->read(paddr - mapping.base, size);
+}
+
+void MMIOBus::write(Addr paddr, Word value, std::size_t size) {
+  auto &mapping = getMapping(paddr);
+  mapping.device->write(paddr - mapping.base, value, size);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,101 @@
+#include "memory/mmu.hh"
+#include "memory/memory.hh"
+
+namespace sim {
+
+bool MMU::setSatp(RegVal satp) {
+  auto oldMode = mode_;
+
+  mode_ = getBits<sv32::kSatpModeBit, sv32::kSatpModeBit>(satp) ? Mode::SV32
+                                                                 : Mode::BARE;
+  asid_ = static_cast<ASID>((satp >> sv32::kSatpASIDShift) &
+                            sv32::kSatpASIDMask);
+  rootTable_ = (satp & sv32::kSatpPPNMask) << kOffsetBits;
+
+  return oldMode != mode_;
+}
+
+void MMU::flushWalkCache() {
+  if (++walkCacheGen_ == 0) {
+    walkCache_.fill(WalkCacheEntry{});
+    walkCacheGen_ = 1;
+  }
+}
+
+Word MMU::loadRootPTE(Addr vaddr, PhysMemory &mem) {
+  auto tag = getWalkCacheTag(vaddr);
+  auto &cached = walkCache_[tag % kWalkCacheSize];
+  if (cached.generation == walkCacheGen_ && cached.tag == tag)
+    return cached.pte;
+
+  auto pte =
+      mem.getPhysWord(rootTable_ + sv32::getVPN1(vaddr) * sv32::kPTESize);
+  // Only pointers to next level are cached: leaves need A/D bits updates
+  if ((pte & sv32::V) && !(pte & sv32::kPermMask))
+    cached = WalkCacheEntry{tag, pte, walkCacheGen_};
+
+  return pte;
+}
+
+MMU::Translation MMU::translate(Addr vaddr, sv32::PTEFlags access,
+                                PhysMemory &mem) {
+  using PageFault = PhysMemory::PageFaultException;
+
+  auto isInvalid = [](Word entry) {
+    return !(entry & sv32::V) || ((entry & sv32::W) && !(entry & sv32::R));
+  };
+
+  auto pte = loadRootPTE(vaddr, mem);
+  if (isInvalid(pte))
+    throw PageFault("Sv32: invalid level 1 page table entry");
+
+  Addr leafAddr{};
+  bool isSuperPage = (pte & sv32::kPermMask) != 0;
+  if (isSuperPage) {
+    if (sv32::getPTEPPN0(pte))
+      throw PageFault("Sv32: misaligned superpage");
+    leafAddr = rootTable_ + sv32::getVPN1(vaddr) * sv32::kPTESize;
+  } else {
+    auto table = sv32::getPTEPPN(pte) << kOffsetBits;
+    leafAddr = table + sv32::getVPN0(vaddr) * sv32::kPTESize;
+  }
+
+  // Walk stops at level 1 for superpage
+  auto *leaf = &mem.getPhysWord(leafAddr);
+  if (isInvalid(*leaf) || !(*leaf & sv32::kPermMask))
+    throw PageFault(isSuperPage ? "Sv32: invalid level 1 page table entry"
+                                : "Sv32: invalid level 0 page table entry");
+
+  if (!(*leaf & access))
+    throw PageFault(
+        isSuperPage
+            ? "Sv32: access type is not permitted by level 1 page table entry"
+            : "Sv32: access type is not permitted by level 0 page table "
+              "entry");
+
+  // Hardware A/D bits update
+  auto updated = *leaf | sv32::A;
+  if (access == sv32::W)
+    updated |= sv32::D;
+  if (updated != *leaf) {
+    *leaf = updated;
+    mem.markDirty(leafAddr);
+  }
+
+  auto ppn = sv32::getPTEPPN(*leaf);
+  if (ppn >> (sizeofBits<Addr>() - kOffsetBits))
+    throw PageFault("Sv32: physical address is out of range");
+
+  auto offsetBits = isSuperPage ? kOffsetBits + sv32::kVPNBits : kOffsetBits;
+  auto offsetMask = (Addr{1} << offsetBits) - 1;
+  auto physAddr = ((ppn << kOffsetBits) & ~offsetMask) | (vaddr & offsetMask);
+
+  // Not dirty page is cached as read-only: first store will walk again
+  auto perms = static_cast<std::uint8_t>(*leaf & sv32::kPermMask);
+  if (!(*leaf & sv32::D))
+    perms &= static_cast<std::uint8_t>(~sv32::W);
+
+  return Translation{physAddr, perms, (*leaf & sv32::G) != 0};
+}
+
+} // namespace sim
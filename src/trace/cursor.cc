@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "trace/cursor.hh"
+#include "trace/trace.hh"
+
+namespace sim {
+
+//~~~~~InstrEffects class functions~~~~~
+
+void InstrEffects::clear() {
+  num = 0;
+  addr.reset();
+  pc = 0;
+  flags = 0;
+  regs.clear();
+  mems.clear();
+}
+
+std::string InstrEffects::str() const {
+  fmt::memory_buffer buf{};
+  auto out = std::back_inserter(buf);
+  fmt::format_to(out, "-----------------------\nNUM={}\n", num);
+  for (auto [reg, val] : regs)
+    fmt::format_to(out, "x{}=0x{:08x}\n", reg, val);
+  for (auto [memAddr, val] : mems)
+    fmt::format_to(out, "M[0x{:08x}]=0x{:08x}\n", memAddr, val);
+  fmt::format_to(out, "PC=0x{:08x}\n", pc);
+  return fmt::to_string(buf);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace {
+
+constexpr std::string_view kNumPrefix = "NUM=";
+constexpr std::string_view kPCPrefix = "PC=0x";
+constexpr std::string_view kRegPrefix = "x";
+constexpr std::string_view kMemPrefix = "M[0x";
+
+template <std::unsigned_integral T>
+T parseInt(std::string_view str, int base = 10) {
+  T val{};
+  const auto *end = str.data() + str.size();
+  auto [ptr, ec] = std::from_chars(str.data(), end, val, base);
+  if (ec != std::errc{} || ptr != end || str.empty())
+    throw std::runtime_error{"Bad number in text trace: " + std::string{str}};
+  return val;
+}
+
+std::size_t skipLine(std::string_view text, std::size_t pos) {
+  auto eol = text.find('\n', pos);
+  return eol == std::string_view::npos ? text.size() : eol + 1;
+}
+
+/* Start of the first NUM line at or after pos */
+std::size_t findNumLine(std::string_view text, std::size_t pos) {
+  if (pos != 0 && pos < text.size() && text[pos - 1] != '\n')
+    pos = skipLine(text, pos);
+  while (pos < text.size() && !text.substr(pos).starts_with(kNumPrefix))
+    pos = skipLine(text, pos);
+  return std::min(pos, text.size());
+}
+
+std::uint64_t getNum(std::string_view text, std::size_t numLine) {
+  auto start = numLine + kNumPrefix.size();
+  auto end = std::min(text.find('\n', start), text.size());
+  return parseInt<std::uint64_t>(text.substr(start, end - start));
+}
+
+class TextCursor final : public TraceCursor {
+public:
+  explicit TextCursor(std::string_view text) : text_(text) {}
+
+  void seek(std::uint64_t num) override;
+  bool next(InstrEffects &effects) override;
+
+private:
+  std::string_view getLine();
+  [[nodiscard]] std::optional<Addr> findPrevPC() const;
+
+  std::string_view text_{};
+  std::size_t pos_{};
+  std::optional<Addr> lastPC_{};
+};
+
+void TextCursor::seek(std::uint64_t num) {
+  // NUM values grow along the trace, so binary search by file offset
+  std::size_t low = 0;
+  std::size_t high = text_.size();
+  while (low < high) {
+    auto mid = low + (high - low) / 2;
+    auto numLine = findNumLine(text_, mid);
+    if (numLine == text_.size() || getNum(text_, numLine) >= num)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+
+  pos_ = findNumLine(text_, low);
+  lastPC_ = findPrevPC();
+}
+
+bool TextCursor::next(InstrEffects &effects) {
+  pos_ = findNumLine(text_, pos_);
+  if (pos_ == text_.size())
+    return false;
+
+  effects.clear();
+  effects.num = getNum(text_, pos_);
+  effects.addr = lastPC_;
+  getLine();
+
+  while (pos_ != text_.size()) {
+    auto line = getLine();
+    if (line.starts_with(kPCPrefix)) {
+      effects.pc = parseInt<Addr>(line.substr(kPCPrefix.size()), 16);
+      lastPC_ = effects.pc;
+      return true;
+    }
+
+    if (line.starts_with(kRegPrefix)) {
+      auto eq = line.find("=0x");
+      if (eq != std::string_view::npos) {
+        auto reg = line.substr(kRegPrefix.size(), eq - kRegPrefix.size());
+        effects.regs.emplace_back(parseInt<RegId>(reg),
+                                  parseInt<RegVal>(line.substr(eq + 3), 16));
+        continue;
+      }
+    } else if (line.starts_with(kMemPrefix)) {
+      auto eq = line.find("]=0x");
+      if (eq != std::string_view::npos) {
+        auto memAddr = line.substr(kMemPrefix.size(), eq - kMemPrefix.size());
+        effects.mems.emplace_back(parseInt<Addr>(memAddr, 16),
+                                  parseInt<Word>(line.substr(eq + 4), 16));
+        continue;
+      }
+    }
+    throw std::runtime_error{"Bad line in text trace: " + std::string{line}};
+  }
+  throw std::runtime_error{"Unexpected end of text trace"};
+}
+
+std::string_view TextCursor::getLine() {
+  auto next = skipLine(text_, pos_);
+  auto line = text_.substr(pos_, next - pos_);
+  pos_ = next;
+  if (line.ends_with('\n'))
+    line.remove_suffix(1);
+  return line;
+}
+
+std::optional<Addr> TextCursor::findPrevPC() const {
+  auto line = text_.rfind(std::string{"\n"}.append(kPCPrefix), pos_);
+  if (line == std::string_view::npos)
+    return std::nullopt;
+
+  auto start = line + 1 + kPCPrefix.size();
+  auto end = std::min(text_.find('\n', start), text_.size());
+  return parseInt<Addr>(text_.substr(start, end - start), 16);
+}
+
+using FrameIndex = std::span<const std::pair<std::size_t, std::uint64_t>>;
+
+class BinaryCursor final : public TraceCursor {
+public:
+  BinaryCursor(std::span<const Byte> data, FrameIndex frames)
+      : reader_(data), frames_(frames) {}
+
+  void seek(std::uint64_t num) override;
+  bool next(InstrEffects &effects) override;
+
+private:
+  bool decode(InstrEffects &effects);
+
+  TraceReader reader_;
+  FrameIndex frames_{};
+  std::uint64_t minNum_{};
+  std::optional<Addr> lastPC_{};
+};
+
+void BinaryCursor::seek(std::uint64_t num) {
+  // Instruction may begin in the frame before the one it is synced in
+  auto frame = std::partition_point(
+      frames_.begin(), frames_.end(),
+      [num](const auto &entry) { return entry.second < num; });
+  if (frame != frames_.begin())
+    --frame;
+  if (frame != frames_.end())
+    reader_.seekFrame(frame->first);
+
+  minNum_ = num;
+  lastPC_.reset();
+}
+
+bool BinaryCursor::next(InstrEffects &effects) {
+  do {
+    if (!decode(effects))
+      return false;
+  } while (effects.num < minNum_);
+  return true;
+}
+
+bool BinaryCursor::decode(InstrEffects &effects) {
+  effects.clear();
+  bool isStarted = false;
+  auto start = [&](const TraceRecord &rec) {
+    if (isStarted)
+      return;
+    isStarted = true;
+    effects.num = rec.instrNum;
+    effects.addr = lastPC_;
+  };
+
+  TraceRecord rec{};
+  while (reader_.next(rec)) {
+    switch (rec.type) {
+    case trace::SYNC:
+      // Drop incomplete instruction before jump in time
+      if (isStarted && rec.instrNum != effects.num) {
+        effects.clear();
+        isStarted = false;
+      }
+      lastPC_ = rec.pc;
+      break;
+    case trace::REG:
+      start(rec);
+      effects.regs.emplace_back(rec.reg, rec.value);
+      break;
+    case trace::MEM:
+      start(rec);
+      effects.mems.emplace_back(rec.addr, rec.value);
+      break;
+    case trace::INSN:
+      start(rec);
+      effects.pc = rec.pc;
+      effects.flags = rec.flags;
+      lastPC_ = rec.pc;
+      return true;
+    case trace::INSN_SEQ:
+    default:
+      throw std::logic_error{"Unexpected trace record"};
+    }
+  }
+  return false;
+}
+
+std::string_view asText(std::span<const Byte> data) {
+  return {reinterpret_cast<const char *>(data.data()), data.size()};
+}
+
+} // namespace
+
+//~~~~~TraceFile class functions~~~~~
+
+TraceFile::TraceFile(const fs::path &file) {
+  std::size_t size{};
+  mapping_ = trace::mapFile(file, size);
+  data_ = std::span{static_cast<const Byte *>(mapping_.get()), size};
+  init();
+}
+
+TraceFile::TraceFile(std::span<const Byte> data) : data_(data) { init(); }
+
+void TraceFile::init() {
+  auto isBinary = data_.size() >= trace::kMagic.size() &&
+                  asText(data_).starts_with(std::string_view{
+                      trace::kMagic.data(), trace::kMagic.size()});
+  format_ = isBinary ? Format::BINARY : Format::TEXT;
+  if (!isBinary)
+    return;
+
+  TraceReader reader{data_};
+  for (auto offset : reader.getFrameOffsets()) {
+    reader.seekFrame(offset);
+    TraceRecord rec{};
+    frames_.emplace_back(offset, reader.next(rec) ? rec.instrNum : 0);
+  }
+}
+
+std::vector<std::uint64_t>
+TraceFile::getSplitPoints(std::size_t numParts) const {
+  std::vector<std::uint64_t> points{};
+  auto text = asText(data_);
+  for (std::size_t i = 1; i < numParts; ++i) {
+    std::uint64_t num{};
+    if (format_ == Format::BINARY) {
+      if (frames_.empty())
+        break;
+      num = frames_[i * frames_.size() / numParts].second;
+    } else {
+      auto numLine = findNumLine(text, i * text.size() / numParts);
+      if (numLine == text.size())
+        break;
+      num = getNum(text, numLine);
+    }
+
+    if (points.empty() || num > points.back())
+      points.push_back(num);
+  }
+  return points;
+}
+
+std::unique_ptr<TraceCursor> TraceFile::makeCursor() const {
+  if (format_ == Format::BINARY)
+    return std::make_unique<BinaryCursor>(data_, frames_);
+  return std::make_unique<TextCursor>(asText(data_));
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace/trace.hh"
+
+namespace sim {
+
+//~~~~~Tracer class functions~~~~~
+
+Tracer::Tracer(const fs::path &file, std::size_t chunkSize,
+               std::size_t numChunks)
+    : out_(file, std::ios::binary | std::ios::trunc), chunkSize_(chunkSize),
+      ring_(numChunks) {
+  if (!out_)
+    throw std::runtime_error{"Failed to create trace file: " + file.string()};
+  if (chunkSize_ < sizeof(trace::FrameSize) + 2 * trace::kMaxRecordSize)
+    throw std::invalid_argument{"Trace chunk is too small"};
+
+  out_.write(trace::kMagic.data(), trace::kMagic.size());
+  out_.write(reinterpret_cast<const char *>(&trace::kVersion),
+             sizeof(trace::kVersion));
+
+  writer_ = std::thread{[this] { writerLoop(); }};
+  nextChunk(false);
+}
+
+Tracer::~Tracer() {
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+void Tracer::sync(std::uint64_t instrNum, Addr pc) {
+  ensureSpace();
+  instrNum_ = instrNum;
+  lastPC_ = pc;
+  putSync();
+}
+
+void Tracer::putSync() {
+  putByte(trace::makeTag(trace::SYNC, 0));
+  putVarint(instrNum_);
+  putVarint(lastPC_);
+  lastRegs_.fill(0);
+  lastMemAddr_ = 0;
+}
+
+void Tracer::close() {
+  if (isClosed_)
+    return;
+
+  isClosed_ = true;
+  nextChunk(true);
+  writer_.join();
+  out_.close();
+  if (writeFailed_ || !out_)
+    throw std::runtime_error{"Failed to write trace"};
+}
+
+void Tracer::nextChunk(bool isLast) {
+  // Publish current chunk (the very first call has nothing to publish)
+  if (chunk_) {
+    chunk_->size = static_cast<std::size_t>(cur_ - chunk_->data.data());
+    auto frameSize =
+        static_cast<trace::FrameSize>(chunk_->size - sizeof(trace::FrameSize));
+    std::copy_n(reinterpret_cast<const Byte *>(&frameSize), sizeof(frameSize),
+                chunk_->data.data());
+    chunk_->isLast = isLast;
+    ring_.publish();
+  }
+  if (isLast)
+    return;
+
+  auto isFirst = chunk_ == nullptr;
+  chunk_ = &ring_.acquire();
+  chunk_->data.resize(chunkSize_);
+  cur_ = chunk_->data.data() + sizeof(trace::FrameSize);
+  end_ = chunk_->data.data() + chunkSize_;
+  // First frame starts with explicit sync()
+  if (!isFirst)
+    putSync();
+}
+
+void Tracer::writerLoop() {
+  for (bool isLast = false; !isLast;) {
+    auto &chunk = ring_.peek();
+    isLast = chunk.isLast;
+    if (!writeFailed_ &&
+        !out_.write(reinterpret_cast<const char *>(chunk.data.data()),
+                    static_cast<std::streamsize>(chunk.size)))
+      writeFailed_ = true;
+    ring_.release();
+  }
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//~~~~~TraceReader class functions~~~~~
+
+std::shared_ptr<const void> trace::mapFile(const fs::path &file,
+                                          std::size_t &size) {
+  auto fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error{"Failed to open trace: " + file.string()};
+
+  struct stat st {};
+  void *addr = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    size = static_cast<std::size_t>(st.st_size);
+    addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    throw std::runtime_error{"Failed to map trace: " + file.string()};
+
+  madvise(addr, size, MADV_SEQUENTIAL);
+  return std::shared_ptr<const void>{addr, [size](const void *ptr) {
+                                       munmap(const_cast<void *>(ptr), size);
+                                     }};
+}
+
+TraceReader::TraceReader(const fs::path &file) {
+  std::size_t size{};
+  mapping_ = trace::mapFile(file, size);
+  data_ = std::span{static_cast<const Byte *>(mapping_.get()), size};
+  parseHeader();
+}
+
+TraceReader::TraceReader(std::span<const Byte> data) : data_(data) {
+  parseHeader();
+}
+
+void TraceReader::parseHeader() {
+  if (data_.size() < trace::kHeaderSize ||
+      !std::equal(trace::kMagic.begin(), trace::kMagic.end(), data_.begin(),
+                  [](char lhs, Byte rhs) {
+                    return lhs == static_cast<char>(rhs);
+                  }))
+    throw std::runtime_error{"Bad trace header"};
+
+  std::uint32_t version{};
+  std::copy_n(data_.begin() + trace::kMagic.size(), sizeof(version),
+              reinterpret_cast<Byte *>(&version));
+  if (version != trace::kVersion)
+    throw std::runtime_error{"Unsupported trace version"};
+  offset_ = frameEnd_ = trace::kHeaderSize;
+}
+
+Byte TraceReader::getByte() {
+  if (offset_ >= frameEnd_)
+    throw std::runtime_error{"Truncated trace record"};
+  return data_[offset_++];
+}
+
+DWord TraceReader::getVarint() {
+  DWord res{};
+  for (std::size_t shift = 0; shift < sizeofBits<DWord>(); shift += 7) {
+    auto byte = getByte();
+    res |= DWord{byte & 0x7FU} << shift;
+    if (!(byte & 0x80))
+      return res;
+  }
+  throw std::runtime_error{"Bad varint in trace"};
+}
+
+trace::FrameSize TraceReader::getFrameSize(std::size_t offset) const {
+  if (data_.size() - offset < sizeof(trace::FrameSize))
+    throw std::runtime_error{"Truncated trace frame"};
+
+  trace::FrameSize size{};
+  std::copy_n(data_.begin() + static_cast<std::ptrdiff_t>(offset),
+              sizeof(size), reinterpret_cast<Byte *>(&size));
+  if (data_.size() - offset - sizeof(size) < size)
+    throw std::runtime_error{"Truncated trace frame"};
+  return size;
+}
+
+std::vector<std::size_t> TraceReader::getFrameOffsets() const {
+  std::vector<std::size_t> offsets{};
+  for (auto offset = trace::kHeaderSize; offset != data_.size();
+       offset += sizeof(trace::FrameSize) + getFrameSize(offset))
+    offsets.push_back(offset);
+  return offsets;
+}
+
+void TraceReader::seekFrame(std::size_t offset) {
+  if (offset < trace::kHeaderSize || offset > data_.size())
+    throw std::out_of_range{"Trace frame offset is out of range"};
+
+  offset_ = frameEnd_ = offset;
+  lastRegs_.fill(0);
+  instrNum_ = 0;
+  lastPC_ = lastMemAddr_ = 0;
+}
+
+bool TraceReader::next(TraceRecord &rec) {
+  // Skip to the next non-empty frame
+  while (offset_ == frameEnd_) {
+    if (offset_ == data_.size())
+      return false;
+
+    auto size = getFrameSize(offset_);
+    offset_ += sizeof(size);
+    frameEnd_ = offset_ + size;
+  }
+
+  auto tag = getByte();
+  auto arg = static_cast<Byte>(tag >> trace::kTypeBits);
+  rec = TraceRecord{};
+  rec.type = static_cast<trace::RecordType>(tag & trace::kTypeMask);
+  rec.instrNum = instrNum_;
+
+  switch (rec.type) {
+  case trace::SYNC:
+    instrNum_ = rec.instrNum = getVarint();
+    lastPC_ = rec.pc = static_cast<Addr>(getVarint());
+    lastRegs_.fill(0);
+    lastMemAddr_ = 0;
+    break;
+  case trace::INSN_SEQ:
+  case trace::INSN: {
+    Addr delta = 0;
+    if (rec.type == trace::INSN)
+      delta = static_cast<Addr>(trace::zigzagDecode(getVarint()));
+    rec.type = trace::INSN;
+    rec.flags = arg;
+    lastPC_ = rec.pc = lastPC_ + kXLENInBytes + delta;
+    ++instrNum_;
+    break;
+  }
+  case trace::REG:
+    if (arg >= kRegNum)
+      throw std::runtime_error{"Bad register number in trace"};
+    rec.reg = arg;
+    lastRegs_[arg] = rec.value = lastRegs_[arg] + static_cast<RegVal>(
+                                     trace::zigzagDecode(getVarint()));
+    break;
+  case trace::MEM:
+    lastMemAddr_ = rec.addr = lastMemAddr_ + static_cast<Addr>(
+                                  trace::zigzagDecode(getVarint()));
+    rec.value = static_cast<Word>(getVarint());
+    break;
+  default:
+    throw std::runtime_error{"Unknown trace record type"};
+  }
+
+  return true;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+} // namespace sim
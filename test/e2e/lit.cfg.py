@@ -12,6 +12,12 @@ config.test_exec_root = path.join(config.my_obj_root, "bin/test")
 config.substitutions.append(
     ("%simulator", path.join(config.my_obj_root, "bin/simulator"))
 )
+config.substitutions.append(
+    ("%trace2text", path.join(config.my_obj_root, "bin/trace2text"))
+)
+config.substitutions.append(
+    ("%cosimdiff", path.join(config.my_obj_root, "bin/cosimdiff"))
+)
 config.substitutions.append(
     ("%fc", "FileCheck-14 --allow-empty --match-full-lines")
 )
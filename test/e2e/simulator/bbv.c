@@ -0,0 +1,15 @@
+// RUN: %gcc %s -o %t
+// RUN: %simulator %t --bbv %t.bb --bbv-interval 1000
+// RUN: %fc %s < %t.bb
+
+unsigned arr[1024];
+
+int main() {
+  for (unsigned i = 0; i < 1024; ++i)
+    arr[i] = i * 3;
+
+  asm("ecall");
+  return arr[1023];
+  // CHECK: {{^T(:[0-9]+:[0-9]+ )+$}}
+  // CHECK-NEXT: {{^T(:[0-9]+:[0-9]+ )+$}}
+}
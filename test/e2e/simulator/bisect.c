@@ -0,0 +1,29 @@
+// RUN: %gcc %s -o %t
+// RUN: %simulator %t --save-hashes %t.hashes --hash-interval 100
+// RUN: %fc %s --check-prefix=HASHES < %t.hashes
+// RUN: %simulator %t --check-hashes %t.hashes
+// RUN: sed -E '3{s/HASH=(.)/HASH=\n\1\n/;h;s/.*\n(.)\n.*/\1/;\
+// RUN:   y/0123456789abcdef/123456789abcdef0/;G;s/^(.)\n(.*)\n.\n/\2\1/}' \
+// RUN:   %t.hashes > %t.bad
+// RUN: not %simulator %t --check-hashes %t.bad --bisect-trace %t.trace
+// RUN: %trace2text %t.trace | %fc %s
+// RUN: rm %t.trace
+
+unsigned arr[64];
+
+int main() {
+  for (unsigned i = 0; i < 64; ++i)
+    arr[i] = i * 3;
+
+  asm("ecall");
+  return arr[63];
+  // Every interval is 100 instructions long, the 1st one too
+  // HASHES: INTERVAL=100
+  // HASHES-NEXT: NUM=101 HASH={{[0-9a-f]+}}
+  // HASHES-NEXT: NUM=201 HASH={{[0-9a-f]+}}
+  // Only the interval of the 2nd hash is traced
+  // CHECK: NUM=101
+  // CHECK-NOT: NUM=100
+  // CHECK: NUM=200
+  // CHECK-NOT: NUM=201
+}
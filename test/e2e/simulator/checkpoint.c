@@ -0,0 +1,30 @@
+// RUN: %gcc %s -o %t
+// RUN: %simulator %t --cosim > %t.full
+// RUN: %simulator %t --save-checkpoint %t.ckpt --at-insn 100
+// RUN: %simulator %t --restore-checkpoint %t.ckpt --cosim > %t.restored
+// RUN: sed -n '/^NUM=100$/,$p' %t.full > %t.expected
+// RUN: sed -n '/^NUM=100$/,$p' %t.restored > %t.actual
+// RUN: diff %t.expected %t.actual
+// RUN: %fc %s --input-file %t.actual
+// RUN: rm %t.ckpt
+
+unsigned arr[64];
+
+unsigned sum(unsigned n) {
+  unsigned res = 0;
+  for (unsigned i = 0; i < n; ++i)
+    res += arr[i];
+  return res;
+}
+
+int main() {
+  // Checkpoint is taken in the middle of this loop
+  for (unsigned i = 0; i < 64; ++i)
+    arr[i] = i;
+
+  unsigned res = sum(64);
+  asm("ecall");
+  return res;
+  // CHECK: NUM=100
+  // CHECK: x10=0x000007e0
+}
@@ -0,0 +1,23 @@
+// RUN: %gcc %s -o %t
+// RUN: %simulator %t --hot-blocks 1 --hot-blocks-json %t.json | %fc %s
+// RUN: %fc %s --check-prefix=JSON < %t.json
+
+unsigned arr[256];
+
+__attribute__((noinline)) unsigned fill(unsigned mul) {
+  for (unsigned i = 0; i < 256; ++i)
+    arr[i] = i * mul;
+  return arr[255];
+}
+
+int main() {
+  unsigned res = 0;
+  for (unsigned i = 1; i < 8; ++i)
+    res += fill(i);
+  asm("ecall");
+  return (int)res;
+  // CHECK: Basic blocks: {{[0-9]+}}, BB cache hit rate: {{.*}}
+  // CHECK: #1 0x{{[0-9a-f]+}} <fill+0x{{[0-9a-f]+}}>: {{.*}}
+  // CHECK-NOT: #2
+  // JSON: {"entry": {{[0-9]+}}, "symbol": "fill+0x{{[0-9a-f]+}}", {{.*}}
+}
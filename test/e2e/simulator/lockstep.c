@@ -0,0 +1,12 @@
+// RUN: %gcc %s -o %t
+// RUN: %simulator %t --lockstep
+
+unsigned arr[64];
+
+int main() {
+  for (unsigned i = 0; i < 64; ++i)
+    arr[i] = i * 3;
+
+  asm("ecall");
+  return arr[63];
+}
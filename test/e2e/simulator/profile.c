@@ -0,0 +1,25 @@
+// RUN: %gcc %s -o %t
+// RUN: %simulator %t --profile %t.folded --profile-period 7
+// RUN: %fc %s < %t.folded
+
+unsigned arr[256];
+
+__attribute__((noinline)) unsigned fill(unsigned mul) {
+  for (unsigned i = 0; i < 256; ++i)
+    arr[i] = i * mul;
+  return arr[255];
+}
+
+__attribute__((noinline)) unsigned work(void) {
+  unsigned res = 0;
+  for (unsigned i = 1; i < 8; ++i)
+    res += fill(i);
+  return res;
+}
+
+int main() {
+  unsigned res = work();
+  asm("ecall");
+  return (int)res;
+  // CHECK: main;work;fill {{[0-9]+$}}
+}
@@ -0,0 +1,19 @@
+// RUN: %gcc %s -o %t
+// RUN: printf "2 0\n5 1\n100000 2\n" > %t.simpoints
+// RUN: printf "0.6 0\n0.3 1\n0.1 2\n" > %t.weights
+// RUN: %simulator %t --simpoints %t.simpoints --weights %t.weights \
+// RUN:   --simpoint-interval 1000 -j 2 | %fc %s
+
+unsigned arr[4096];
+
+int main() {
+  for (unsigned i = 0; i < 4096; ++i)
+    arr[i] = i * 3;
+
+  asm("ecall");
+  return arr[4095];
+  // Interval past program completion is dropped
+  // CHECK: 2 0.6000 1000 {{.*}}%
+  // CHECK-NEXT: 5 0.3000 1000 {{.*}}%
+  // CHECK-NEXT: Weighted 0.9000 {{.*}}%
+}
@@ -0,0 +1,21 @@
+// RUN: %gcc %s -o %t
+// RUN: %simulator %t --stats-file %t.json --stats-interval 1000 \
+// RUN:   --stats-groups executor,memory,decoder,instr_mix
+// RUN: %fc %s < %t.json
+// RUN: %simulator %t --stats-file %t.csv --stats-groups executor,bbcache
+// RUN: %fc %s --check-prefix=CSV < %t.csv
+
+unsigned arr[1024];
+
+int main() {
+  for (unsigned i = 0; i < 1024; ++i)
+    arr[i] = i * 3;
+  asm("ecall");
+  return (int)arr[1023];
+  // CHECK: [
+  // CHECK-NEXT: {"instructions": 1000, "executor.instructions": 1000, {{.*}}"instr_mix.taken_branches": {{[0-9]+}}, {{.*}}"memory.stores": {{[0-9]+}}, {{.*}}"decoder.block_sizes": [{{.*}}]},
+  // CHECK-NEXT: {"instructions": 2000, {{.*}}
+  // CHECK: ]
+  // CSV: instructions,executor.instructions,bbcache.lookups,bbcache.misses,bbcache.blocks
+  // CSV-NEXT: {{[0-9]+}},{{[0-9]+}},{{[0-9]+}},{{[0-9]+}},{{[0-9]+}}
+}
@@ -0,0 +1,29 @@
+// RUN: %gcc %s -o %t
+// RUN: %simulator %t --cosim > %t.full
+// RUN: %simulator %t --trace %t.trace
+// RUN: %trace2text %t.trace -o %t.converted
+// RUN: diff %t.full %t.converted
+// RUN: %cosimdiff --master %t.full --slave %t.trace -j 4
+// RUN: %cosimdiff --master %t.full --slave %t.trace --skip-csr
+// RUN: not %cosimdiff --master %t.full --slave %t.full --skip-csr 2>&1 \
+// RUN:   | %fc %s --check-prefix=SKIPCSR
+// RUN: %simulator %t --trace %t.trace --trace-from 100 --trace-to 200
+// RUN: %trace2text %t.trace > %t.window
+// RUN: sed -n '/^NUM=100$/,/^NUM=200$/p' %t.full | head -n -2 > %t.expected
+// RUN: tail -n +2 %t.window > %t.actual
+// RUN: diff %t.expected %t.actual
+// RUN: %fc %s --input-file %t.actual
+// RUN: rm %t.trace
+
+unsigned arr[64];
+
+int main() {
+  for (unsigned i = 0; i < 64; ++i)
+    arr[i] = i * i;
+
+  asm("ecall");
+  return arr[63];
+  // CHECK: NUM=100
+  // CHECK-NOT: NUM=200
+  // SKIPCSR: --skip-csr requires at least one binary trace
+}
@@ -0,0 +1,161 @@
+#include <filesystem>
+#include <sstream>
+
+#include "test_header.hh"
+#include "test_executable.hh"
+
+#include "assembler/assembler.hh"
+#include "assembler/kernels.hh"
+#include "decoder/decoder.hh"
+#include "elfloader/elfloader.hh"
+#include "hart/hart.hh"
+
+using namespace sim;
+
+namespace {
+
+std::vector<Instruction> decodeAll(const std::vector<Word> &text) {
+  std::vector<Instruction> res{};
+  for (auto word : text)
+    res.push_back(Decoder::decode(word));
+  return res;
+}
+
+/* Run executable through hart & return a0 */
+RegVal runKernel(Kernel kernel, const KernelParams &params) {
+  Assembler as{};
+  generateKernel(as, kernel, params);
+  auto file = test::writeExecutable(as, "sim_kernel");
+
+  Hart hart{file, -1};
+  fs::remove(file);
+  EXPECT_TRUE(hart.run());
+  return hart.takeSnapshot().regs.get(reg::A0);
+}
+
+} // namespace
+
+TEST(Assembler, li) {
+  // Arrange
+  Assembler as{};
+  // Act
+  as.li(reg::A0, 42);
+  as.li(reg::A1, static_cast<Word>(-1));
+  as.li(reg::A2, 0x12345fff);
+  as.li(reg::A3, 0x1000);
+  auto insts = decodeAll(as.assemble());
+  // Assert
+  ASSERT_EQ(insts.size(), 5);
+  EXPECT_EQ(insts[0].type, OpType::ADDI);
+  EXPECT_EQ(insts[0].imm, 42);
+  EXPECT_EQ(insts[1].type, OpType::ADDI);
+  EXPECT_EQ(insts[1].imm, static_cast<Word>(-1));
+  // 0x12346000 - 1
+  EXPECT_EQ(insts[2].type, OpType::LUI);
+  EXPECT_EQ(insts[2].imm, 0x12346000);
+  EXPECT_EQ(insts[3].type, OpType::ADDI);
+  EXPECT_EQ(insts[3].rs1, reg::A2);
+  EXPECT_EQ(insts[3].imm, static_cast<Word>(-1));
+  // No addi for zero lower part
+  EXPECT_EQ(insts[4].type, OpType::LUI);
+  EXPECT_EQ(insts[4].imm, 0x1000);
+}
+
+TEST(Assembler, labels) {
+  // Arrange
+  Assembler as{};
+  auto forward = as.newLabel();
+  // Act
+  auto back = as.here();
+  as.branch(OpType::BNE, reg::A0, reg::ZERO, forward);
+  as.nop();
+  as.bind(forward);
+  as.j(back);
+  auto data = as.dataWords(std::vector<Word>{1, 2});
+  as.la(reg::A0, data);
+  auto insts = decodeAll(as.assemble());
+  // Assert
+  ASSERT_EQ(insts.size(), 5);
+  EXPECT_EQ(insts[0].type, OpType::BNE);
+  EXPECT_EQ(insts[0].imm, 8);
+  EXPECT_EQ(insts[2].type, OpType::JAL);
+  EXPECT_EQ(insts[2].imm, static_cast<Word>(-8));
+  EXPECT_EQ(insts[3].imm + insts[4].imm, Assembler::kDefaultDataBase);
+}
+
+TEST(Assembler, errors) {
+  Assembler as{};
+  auto far = as.newLabel();
+  as.branch(OpType::BEQ, reg::ZERO, reg::ZERO, far);
+  for (std::size_t i = 0; i < 1024; ++i)
+    as.nop();
+  as.bind(far);
+  EXPECT_THROW(as.bind(far), std::logic_error);
+  EXPECT_THROW((void)as.assemble(), std::runtime_error);
+
+  Assembler unbound{};
+  unbound.j(unbound.newLabel());
+  EXPECT_THROW((void)unbound.assemble(), std::logic_error);
+}
+
+TEST(Assembler, elf) {
+  // Arrange
+  Assembler as{};
+  auto words = std::vector<Word>{0xdeadbeef};
+  auto data = as.dataWords(words);
+  auto zeroed = as.bss(10);
+  as.nop();
+  auto start = as.newLabel();
+  as.bind(start);
+  as.beginFunction("start");
+  as.la(reg::A0, data);
+  as.la(reg::A1, zeroed);
+  as.ecall();
+  as.endFunction();
+  as.setEntry(start);
+  // Act
+  std::stringstream ss{};
+  as.write(ss);
+  ELFLoader loader{ss};
+  // Assert
+  EXPECT_EQ(loader.getEntryPoint(), Assembler::kDefaultTextBase + 4);
+  auto segments = loader.getLoadableSegments();
+  ASSERT_EQ(segments.size(), 2);
+
+  EXPECT_EQ(loader.getSegmentAddr(segments[0]), Assembler::kDefaultTextBase);
+  EXPECT_EQ(loader.getSegmentFileSize(segments[0]), 6 * kXLENInBytes);
+  EXPECT_EQ(loader.getSegment(segments[0]).front(), 0x00000013);
+
+  EXPECT_EQ(loader.getSegmentAddr(segments[1]), Assembler::kDefaultDataBase);
+  EXPECT_EQ(loader.getSegmentFileSize(segments[1]), kXLENInBytes);
+  EXPECT_EQ(loader.getSegmentMemorySize(segments[1]), 4 * kXLENInBytes);
+  EXPECT_EQ(loader.getSegment(segments[1]).front(), 0xdeadbeef);
+  EXPECT_EQ(as.getAddr(zeroed), Assembler::kDefaultDataBase + kXLENInBytes);
+
+  auto symbols = loader.getFunctionSymbols();
+  ASSERT_EQ(symbols.size(), 1);
+  EXPECT_EQ(symbols[0].name, "start");
+  EXPECT_EQ(symbols[0].addr, Assembler::kDefaultTextBase + 4);
+  EXPECT_EQ(symbols[0].size, 5 * kXLENInBytes);
+}
+
+TEST(Kernels, run) {
+  EXPECT_EQ(runKernel(Kernel::STRAIGHT_LINE, {10, 100, 4}), 10);
+  // Block is out of branch reach
+  EXPECT_EQ(runKernel(Kernel::STRAIGHT_LINE, {3, 2000, 4}), 3);
+  EXPECT_EQ(runKernel(Kernel::LOOP, {10, 50, 4}), 500);
+  EXPECT_EQ(runKernel(Kernel::CALL_CHAIN, {10, 20, 4}), 200);
+  EXPECT_EQ(runKernel(Kernel::INDIRECT_MAZE, {1000, 3, 4}), 1000);
+  EXPECT_EQ(runKernel(Kernel::INDIRECT_MAZE, {1000, 300, 4}), 1000);
+  EXPECT_EQ(runKernel(Kernel::MEM_STRIDE, {4, 100, 4096}), 400);
+}
+
+TEST(Kernels, errors) {
+  Assembler as{};
+  EXPECT_THROW(generateKernel(as, Kernel::LOOP, {0, 1, 4}),
+               std::invalid_argument);
+  EXPECT_THROW(generateKernel(as, Kernel::MEM_STRIDE, {1, 1, 3}),
+               std::invalid_argument);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,50 @@
+#include <sstream>
+#include <stdexcept>
+
+#include "test_header.hh"
+
+#include "common/host_perf.hh"
+
+TEST(HostPerf, phases) {
+  sim::HostPerf perf{};
+  std::ostringstream ost{};
+  if (!perf.isAvailable()) {
+    EXPECT_FALSE(perf.getError().empty());
+    perf.print(ost, 1);
+    EXPECT_NE(ost.str().find("unavailable"), std::string::npos);
+    GTEST_SKIP() << "perf_event_open failed: " << perf.getError();
+  }
+
+  volatile std::uint64_t sum{};
+  perf.begin(sim::HostPerf::RUN);
+  for (std::uint64_t i = 0; i < 100000; ++i)
+    sum = sum + i;
+  perf.begin(sim::HostPerf::DECODE);
+  perf.end(sim::HostPerf::DECODE);
+  perf.end(sim::HostPerf::RUN);
+  perf.onBlock();
+
+  if (perf.isAvailable(sim::HostPerf::INSTRUCTIONS)) {
+    const auto &run = perf.getTotals(sim::HostPerf::RUN);
+    const auto &decode = perf.getTotals(sim::HostPerf::DECODE);
+    EXPECT_GE(run[sim::HostPerf::INSTRUCTIONS], 100000);
+    EXPECT_LT(decode[sim::HostPerf::INSTRUCTIONS],
+              run[sim::HostPerf::INSTRUCTIONS]);
+
+    // Phase is ended even if it throws
+    try {
+      sim::HostPerf::ScopedPhase phase{&perf, sim::HostPerf::LOAD};
+      for (std::uint64_t i = 0; i < 100000; ++i)
+        sum = sum + i;
+      throw std::runtime_error{"Failed to load"};
+    } catch (const std::runtime_error &) {
+    }
+    EXPECT_GE(perf.getTotals(sim::HostPerf::LOAD)[sim::HostPerf::INSTRUCTIONS],
+              100000);
+  }
+  EXPECT_EQ(perf.getNumBlocks(), 1);
+  perf.print(ost, 100000);
+  EXPECT_NE(ost.str().find("Host counters"), std::string::npos);
+}
+
+#include "test_footer.hh"
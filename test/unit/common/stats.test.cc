@@ -0,0 +1,69 @@
+#include <sstream>
+
+#include "test_header.hh"
+
+#include "common/stats.hh"
+
+TEST(StatsRegistry, groups) {
+  sim::StatsRegistry registry{{"tlb", "memory"}};
+  EXPECT_TRUE(registry.isEnabled("tlb"));
+  EXPECT_FALSE(registry.isEnabled("decoder"));
+
+  registry.addCounter("tlb", "hits", [] { return 1; });
+  registry.addCounter("decoder", "blocks", [] { return 2; });
+  registry.addHistogram("memory", "sizes", 2,
+                        [] { return std::vector<std::uint64_t>{3, 4}; });
+  ASSERT_EQ(registry.getStats().size(), 2);
+  EXPECT_EQ(registry.getStats()[0].name, "tlb.hits");
+  EXPECT_EQ(registry.getStats()[1].name, "memory.sizes");
+  EXPECT_EQ(registry.getStats()[1].numBuckets, 2);
+
+  EXPECT_THROW(registry.addHistogram("memory", "empty", 0, [] {
+    return std::vector<std::uint64_t>{};
+  }),
+               std::invalid_argument);
+
+  sim::StatsRegistry all{};
+  EXPECT_TRUE(all.isEnabled("decoder"));
+}
+
+TEST(StatsWriter, json) {
+  std::uint64_t numHits{};
+  sim::StatsRegistry registry{};
+  registry.addCounter("tlb", "hits", [&] { return numHits; });
+  registry.addHistogram("decoder", "sizes", 2, [&] {
+    return std::vector<std::uint64_t>{numHits, 2 * numHits};
+  });
+
+  std::ostringstream ost{};
+  sim::StatsWriter writer{registry, ost, sim::StatsWriter::Format::JSON};
+  numHits = 1;
+  writer.dump(10);
+  numHits = 5;
+  writer.dump(20);
+  writer.finish();
+  EXPECT_EQ(ost.str(),
+            "[\n"
+            "  {\"instructions\": 10, \"tlb.hits\": 1, "
+            "\"decoder.sizes\": [1, 2]},\n"
+            "  {\"instructions\": 20, \"tlb.hits\": 5, "
+            "\"decoder.sizes\": [5, 10]}\n"
+            "]\n");
+}
+
+TEST(StatsWriter, csv) {
+  sim::StatsRegistry registry{};
+  registry.addCounter("tlb", "hits", [] { return 7; });
+  registry.addHistogram("decoder", "sizes", 2,
+                        [] { return std::vector<std::uint64_t>{1, 2}; });
+
+  std::ostringstream ost{};
+  sim::StatsWriter writer{registry, ost, sim::StatsWriter::Format::CSV};
+  writer.dump(100);
+  writer.finish();
+  EXPECT_EQ(ost.str(), "instructions,tlb.hits,decoder.sizes[0],"
+                       "decoder.sizes[1]\n"
+                       "100,7,1,2\n");
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,32 @@
+#include <sstream>
+#include <thread>
+
+#include "test_header.hh"
+
+#include "common/timer.hh"
+
+TEST(ScopedTimer, sections) {
+  if constexpr (!timer::kSelfProfile)
+    GTEST_SKIP() << "Self-profiling is disabled";
+
+  constexpr auto kDecode = static_cast<std::size_t>(timer::Section::DECODE);
+  constexpr auto kExec = static_cast<std::size_t>(timer::Section::EXECUTE);
+  auto before = timer::getSectionTimes();
+  {
+    timer::ScopedTimer exec{timer::Section::EXECUTE};
+    timer::ScopedTimer decode{timer::Section::DECODE};
+  }
+  // Times of finished threads are merged
+  std::thread{[] { timer::ScopedTimer exec{timer::Section::EXECUTE}; }}
+      .join();
+
+  auto after = timer::getSectionTimes();
+  EXPECT_EQ(after.counts[kDecode] - before.counts[kDecode], 1);
+  EXPECT_EQ(after.counts[kExec] - before.counts[kExec], 2);
+
+  std::ostringstream ost{};
+  timer::printSectionTimes(ost);
+  EXPECT_NE(ost.str().find("page table"), std::string::npos);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,81 @@
+#include <random>
+
+#include "decoder/decoder.hh"
+#include "decoder/encoder.hh"
+#include "test_header.hh"
+
+TEST(encoder, unknown) {
+  // Arrange
+  sim::Instruction inst{};
+  // Act & Assert
+  EXPECT_THROW(sim::Encoder::encode(inst), std::runtime_error);
+}
+
+TEST(encoder, lui) {
+  // Arrange
+  sim::Instruction inst{};
+  inst.type = sim::OpType::LUI;
+  inst.rd = 0x11;
+  inst.imm = 0b10000000000000000001000000000000;
+  // Act
+  auto raw = sim::Encoder::encode(inst);
+  // Assert
+  EXPECT_EQ(raw, 0b10000000000000000001'10001'0110111);
+}
+
+TEST(encoder, jal) {
+  // Arrange
+  sim::Instruction inst{};
+  inst.type = sim::OpType::JAL;
+  inst.rd = 3;
+  inst.imm = 0b11111111111110000000011111111110;
+  // Act
+  auto raw = sim::Encoder::encode(inst);
+  // Assert
+  EXPECT_EQ(raw, 0b1'1111111111'0'10000000'00011'1101111);
+}
+
+TEST(encoder, sw) {
+  // Arrange: sw x5, -4(x6)
+  sim::Instruction inst{};
+  inst.type = sim::OpType::SW;
+  inst.rs1 = 6;
+  inst.rs2 = 5;
+  inst.imm = static_cast<sim::Word>(-4);
+  // Act
+  auto raw = sim::Encoder::encode(inst);
+  // Assert
+  EXPECT_EQ(raw, 0xfe532e23);
+}
+
+TEST(encoder, allTypes) {
+  for (auto [type, name] : sim::opTypeToString) {
+    // Arrange
+    sim::Instruction inst{};
+    inst.type = type;
+    // Act
+    auto decoded = sim::Decoder::decode(sim::Encoder::encode(inst));
+    // Assert
+    EXPECT_EQ(decoded.type, type) << name;
+  }
+}
+
+TEST(encoder, roundTrip) {
+  // Arrange
+  std::mt19937 gen{42};
+  std::size_t numValid = 0;
+
+  for (std::size_t i = 0; i < 100000; ++i) {
+    auto raw = static_cast<sim::Word>(gen());
+    auto inst = sim::Decoder::decode(raw);
+    if (inst.type == sim::OpType::UNKNOWN)
+      continue;
+    ++numValid;
+    // Act & Assert
+    ASSERT_EQ(sim::Encoder::encode(inst), raw)
+        << sim::opTypeToString.at(inst.type);
+  }
+  EXPECT_GT(numValid, 0);
+}
+
+#include "test_footer.hh"
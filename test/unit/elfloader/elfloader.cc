@@ -184,4 +184,22 @@ TEST(elfloader, segments) {
   EXPECT_EQ(loader.getEntryPoint(), Addr(0x10094));
 }
 
+TEST(elfloader, symbolTable) {
+  // Assign
+  SymbolTable symbols{{{0x100, 0x10, "foo"}, {0x200, 0, "bar"}}};
+
+  // Act & Assert
+  EXPECT_EQ(symbols.find(0xFC), nullptr);
+  EXPECT_EQ(symbols.find(0x110), nullptr);
+  ASSERT_NE(symbols.find(0x10C), nullptr);
+  EXPECT_EQ(symbols.find(0x10C)->name, "foo");
+  // Symbol of unknown size spans till the next one
+  ASSERT_NE(symbols.find(0x1000), nullptr);
+  EXPECT_EQ(symbols.find(0x1000)->name, "bar");
+
+  EXPECT_EQ(symbols.str(0x100), "foo");
+  EXPECT_EQ(symbols.str(0x108), "foo+0x8");
+  EXPECT_EQ(symbols.str(0x110), "0x00000110");
+}
+
 #include "test_footer.hh"
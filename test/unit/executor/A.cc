@@ -0,0 +1,114 @@
+#include "executor_test.hh"
+#include "test_header.hh"
+
+namespace {
+
+constexpr sim::Addr kAddr = 0x1000;
+
+/* Run AMO on word holding mem w/ rs2 = val, return rd */
+sim::RegVal runAMO(sim::OpType type, sim::Instruction::Callback callback,
+                   sim::Word mem, sim::Word val) {
+  simulationState.mem.storeEntity<sim::Word>(kAddr, mem);
+  simulationState.regs.set(1, kAddr);
+  simulationState.regs.set(2, val);
+  sim::Instruction instr = {1, // rs1
+                            2, // rs2
+                            0,
+                            3, // rd
+                            0,
+                            0,
+                            type,
+                            0,
+                            false,
+                            callback};
+  executor.execute(instr, simulationState);
+  return simulationState.regs.get(3);
+}
+
+sim::Word getMem() { return simulationState.mem.loadEntity<sim::Word>(kAddr); }
+
+} // namespace
+
+TEST(execute, amoArith) {
+  using sim::OpType;
+  EXPECT_EQ(runAMO(OpType::AMOADD_W, sim::executeAMOADD_W, 40, 2), 40);
+  EXPECT_EQ(getMem(), 42);
+  EXPECT_EQ(runAMO(OpType::AMOADD_W, sim::executeAMOADD_W, ~0U, 2), ~0U);
+  EXPECT_EQ(getMem(), 1);
+
+  EXPECT_EQ(runAMO(OpType::AMOSWAP_W, sim::executeAMOSWAP_W, 7, 9), 7);
+  EXPECT_EQ(getMem(), 9);
+  EXPECT_EQ(runAMO(OpType::AMOAND_W, sim::executeAMOAND_W, 0xF0F0, 0xFF00),
+            0xF0F0);
+  EXPECT_EQ(getMem(), 0xF000);
+  EXPECT_EQ(runAMO(OpType::AMOOR_W, sim::executeAMOOR_W, 0xF0F0, 0xFF00),
+            0xF0F0);
+  EXPECT_EQ(getMem(), 0xFFF0);
+  EXPECT_EQ(runAMO(OpType::AMOXOR_W, sim::executeAMOXOR_W, 0xF0F0, 0xFF00),
+            0xF0F0);
+  EXPECT_EQ(getMem(), 0x0FF0);
+}
+
+TEST(execute, amoMinMax) {
+  using sim::OpType;
+  constexpr sim::Word kMinusOne = ~0U;
+
+  EXPECT_EQ(runAMO(OpType::AMOMAX_W, sim::executeAMOMAX_W, kMinusOne, 1),
+            kMinusOne);
+  EXPECT_EQ(getMem(), 1);
+  EXPECT_EQ(runAMO(OpType::AMOMAXU_W, sim::executeAMOMAXU_W, kMinusOne, 1),
+            kMinusOne);
+  EXPECT_EQ(getMem(), kMinusOne);
+  EXPECT_EQ(runAMO(OpType::AMOMIN_W, sim::executeAMOMIN_W, kMinusOne, 1),
+            kMinusOne);
+  EXPECT_EQ(getMem(), kMinusOne);
+  EXPECT_EQ(runAMO(OpType::AMOMINU_W, sim::executeAMOMINU_W, kMinusOne, 1),
+            kMinusOne);
+  EXPECT_EQ(getMem(), 1);
+
+  // Misaligned AMO is not supported
+  simulationState.regs.set(1, kAddr + 2);
+  sim::Instruction instr = {1, 2, 0, 3, 0, 0, OpType::AMOADD_W,
+                            0, false, sim::executeAMOADD_W};
+  EXPECT_THROW(executor.execute(instr, simulationState),
+               sim::PhysMemory::MisAlignedAddrException);
+}
+
+TEST(execute, lrsc) {
+  using sim::OpType;
+  simulationState.mem.storeEntity<sim::Word>(kAddr, 5);
+  simulationState.regs.set(1, kAddr);
+  simulationState.regs.set(2, 6);
+  sim::Instruction lr = {1, 0, 0, 3, 0, 0, OpType::LR_W,
+                         0, false, sim::executeLR_W};
+  sim::Instruction sc = {1, 2, 0, 4, 0, 0, OpType::SC_W,
+                         0, false, sim::executeSC_W};
+
+  executor.execute(lr, simulationState);
+  EXPECT_EQ(simulationState.regs.get(3), 5);
+  executor.execute(sc, simulationState);
+  EXPECT_EQ(simulationState.regs.get(4), 0);
+  EXPECT_EQ(getMem(), 6);
+
+  // Reservation is consumed by SC
+  simulationState.regs.set(2, 7);
+  executor.execute(sc, simulationState);
+  EXPECT_EQ(simulationState.regs.get(4), 1);
+  EXPECT_EQ(getMem(), 6);
+
+  // Word changed since LR
+  executor.execute(lr, simulationState);
+  simulationState.mem.storeEntity<sim::Word>(kAddr, 8);
+  executor.execute(sc, simulationState);
+  EXPECT_EQ(simulationState.regs.get(4), 1);
+  EXPECT_EQ(getMem(), 8);
+
+  // SC to other address than reserved one
+  executor.execute(lr, simulationState);
+  simulationState.regs.set(1, kAddr + 4);
+  executor.execute(sc, simulationState);
+  EXPECT_EQ(simulationState.regs.get(4), 1);
+  EXPECT_EQ(simulationState.mem.loadEntity<sim::Word>(kAddr + 4), 0);
+}
+
+#include "test_footer.hh"
@@ -101,4 +101,28 @@ TEST(execute, CSRRCI) {
   ASSERT_EQ(simulationState.csregs.get(15), 0xF0FFFFFE);
 }
 
+TEST(execute, satpAndSFENCE_VMA) {
+  sim::State state{};
+  auto epoch = state.mem.getTranslationEpoch();
+  state.regs.set(5, 0x80000000);
+  sim::Instruction instr = {5, // rs1
+                            0, // rs2
+                            0,
+                            0, // rd
+                            0,    sim::CSRegFile::SATP, sim::OpType::CSRRW,
+                            0x0,  false,                sim::executeCSRRW};
+  executor.execute(instr, state);
+  ASSERT_TRUE(state.mem.getMMU().isPagingOn());
+  ASSERT_GT(state.mem.getTranslationEpoch(), epoch);
+
+  epoch = state.mem.getTranslationEpoch();
+  instr = {0, // rs1
+           0, // rs2
+           0,
+           0, // rd
+           0, 0, sim::OpType::SFENCE_VMA, 0x0, true, sim::executeSFENCE_VMA};
+  executor.execute(instr, state);
+  ASSERT_GT(state.mem.getTranslationEpoch(), epoch);
+}
+
 #include "test_footer.hh"
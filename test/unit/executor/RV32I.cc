@@ -68,6 +68,35 @@ TEST(execute, lWAndSW) {
   ASSERT_EQ(simulationState.regs.get(3), 0xFF);
 }
 
+TEST(execute, byteAndHalf) {
+  simulationState.regs.set(1, 0xB0);
+  simulationState.regs.set(2, 0x12345680);
+  sim::Instruction instr = {1, // rs1
+                            2, // rs2
+                            0,
+                            0, // rd
+                            0, 0, sim::OpType::SW, 0x0, false, sim::executeSW};
+  executor.execute(instr, simulationState);
+  instr = {1, 2, 0, 0, 0, 0, sim::OpType::SB, 0x1, false, sim::executeSB};
+  executor.execute(instr, simulationState);
+  instr = {1, 2, 0, 0, 0, 0, sim::OpType::SH, 0x2, false, sim::executeSH};
+  executor.execute(instr, simulationState);
+  ASSERT_EQ(simulationState.mem.loadEntity<Word>(0xB0), 0x56808080);
+
+  instr = {1, 0, 0, 3, 0, 0, sim::OpType::LB, 0x1, false, sim::executeLB};
+  executor.execute(instr, simulationState);
+  ASSERT_EQ(simulationState.regs.get(3), 0xFFFFFF80);
+  instr = {1, 0, 0, 3, 0, 0, sim::OpType::LBU, 0x1, false, sim::executeLBU};
+  executor.execute(instr, simulationState);
+  ASSERT_EQ(simulationState.regs.get(3), 0x80);
+  instr = {1, 0, 0, 3, 0, 0, sim::OpType::LH, 0x0, false, sim::executeLH};
+  executor.execute(instr, simulationState);
+  ASSERT_EQ(simulationState.regs.get(3), 0xFFFF8080);
+  instr = {1, 0, 0, 3, 0, 0, sim::OpType::LHU, 0x2, false, sim::executeLHU};
+  executor.execute(instr, simulationState);
+  ASSERT_EQ(simulationState.regs.get(3), 0x5680);
+}
+
 TEST(execute, JAL) {
   simulationState.pc = 0x0;
   sim::Instruction instr = {1, // rs1
@@ -211,8 +240,8 @@ TEST(execute, LUI) {
                             15, // rs2
                             0,
                             11, // rd
-                            0,   0,     sim::OpType::LUI,
-                            0x1, false, sim::executeLUI};
+                            0,      0,     sim::OpType::LUI,
+                            0x1000, false, sim::executeLUI};
   executor.execute(instr, simulationState);
   ASSERT_EQ(simulationState.regs.get(11), 0x1000);
 }
@@ -223,8 +252,8 @@ TEST(execute, AUIPC) {
                             15, // rs2
                             0,
                             11, // rd
-                            0,   0,     sim::OpType::AUIPC,
-                            0x1, false, sim::executeAUIPC};
+                            0,      0,     sim::OpType::AUIPC,
+                            0x1000, false, sim::executeAUIPC};
   executor.execute(instr, simulationState);
   ASSERT_EQ(simulationState.regs.get(11), 0x1001);
 }
@@ -0,0 +1,63 @@
+#include <sstream>
+#include <vector>
+
+#include "test_header.hh"
+
+#include "executor/instr_mix.hh"
+
+using sim::InstrMix;
+using sim::OpType;
+
+namespace {
+
+std::vector<sim::Instruction> makeBlock(std::initializer_list<OpType> types) {
+  std::vector<sim::Instruction> block{};
+  for (auto type : types) {
+    sim::Instruction inst{};
+    inst.type = type;
+    block.push_back(inst);
+  }
+  return block;
+}
+
+} // namespace
+
+TEST(InstrMix, histogram) {
+  auto block = makeBlock({OpType::ADDI, OpType::LW, OpType::ADDI, OpType::BNE});
+  auto histogram = sim::makeHistogram(block);
+  ASSERT_EQ(histogram.size(), 3);
+  EXPECT_EQ(histogram[0], std::make_pair(OpType::ADDI, std::uint32_t{2}));
+  EXPECT_EQ(histogram[1], std::make_pair(OpType::LW, std::uint32_t{1}));
+  EXPECT_EQ(histogram[2], std::make_pair(OpType::BNE, std::uint32_t{1}));
+}
+
+TEST(InstrMix, counts) {
+  auto loop = sim::makeHistogram(
+      makeBlock({OpType::ADDI, OpType::SW, OpType::ADDI, OpType::BNE}));
+  auto exit = sim::makeHistogram(makeBlock({OpType::CSRRS, OpType::ECALL}));
+
+  InstrMix mix{};
+  for (int i = 0; i < 10; ++i) {
+    mix.add(loop);
+    mix.onBranch(i != 9);
+  }
+  mix.add(exit);
+
+  EXPECT_EQ(mix.getCount(OpType::ADDI), 20);
+  EXPECT_EQ(mix.getCount(OpType::BNE), 10);
+  EXPECT_EQ(mix.getCount(InstrMix::ALU), 20);
+  EXPECT_EQ(mix.getCount(InstrMix::STORE), 10);
+  EXPECT_EQ(mix.getCount(InstrMix::CSR), 1);
+  EXPECT_EQ(mix.getCount(InstrMix::SYSTEM), 1);
+  EXPECT_EQ(mix.getNumTakenBranches(), 9);
+
+  std::ostringstream ost{};
+  mix.writeJSON(ost);
+  auto json = ost.str();
+  EXPECT_NE(json.find("\"instructions\": 42"), std::string::npos);
+  EXPECT_NE(json.find("\"branch_taken\": 9, \"branch_not_taken\": 1"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"types\": {\"ADDI\": 20, "), std::string::npos);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,163 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "test_header.hh"
+#include "test_executable.hh"
+
+#include "assembler/assembler.hh"
+#include "hart/batch.hh"
+
+using namespace sim;
+using namespace sim::test;
+
+TEST(Batch, loadJobs) {
+  auto file = writeFile("jobs", "# comment\n"
+                                "a.elf\n"
+                                "\n"
+                                "  b.elf max-instrs=100 console=b.log # c\n");
+  auto jobs = loadBatchJobs(file);
+  ASSERT_EQ(jobs.size(), 2);
+  EXPECT_EQ(jobs[0].executable, "a.elf");
+  EXPECT_EQ(jobs[0].maxInstrs, Hart::kNoStop);
+  EXPECT_TRUE(jobs[0].console.empty());
+  EXPECT_EQ(jobs[1].executable, "b.elf");
+  EXPECT_EQ(jobs[1].maxInstrs, 100);
+  EXPECT_EQ(jobs[1].console, "b.log");
+
+  for (const auto *text : {"a.elf max-instrs=1x\n", "a.elf console=\n",
+                           "a.elf foo=1\n"}) {
+    std::ofstream{file} << text;
+    EXPECT_THROW(loadBatchJobs(file), std::runtime_error);
+  }
+  fs::remove(file);
+}
+
+TEST(Batch, sharedImage) {
+  using namespace reg;
+
+  // Counter in bss is incremented & reported as exit code
+  Assembler as{};
+  auto counter = as.bss(kXLENInBytes);
+  as.la(T0, counter);
+  as.load(OpType::LW, T1, T0, 0);
+  as.iType(OpType::ADDI, T1, T1, 1);
+  as.store(OpType::SW, T1, T0, 0);
+  as.li(T2, kUARTBase);
+  as.li(T3, 'A');
+  as.store(OpType::SB, T3, T2, 0);
+  as.iType(OpType::SLLI, T1, T1, 16);
+  as.li(T3, TestFinisher::FAIL);
+  as.rType(OpType::ADD, T1, T1, T3);
+  as.li(T2, kFinisherBase);
+  as.store(OpType::SW, T1, T2, 0);
+  as.ecall();
+  auto counterFile = writeExecutable(as, "sim_batch_counter");
+
+  Assembler spin{};
+  auto loop = spin.here();
+  spin.j(loop);
+  auto spinFile = writeExecutable(spin, "sim_batch_spin");
+
+  auto console = getTempPath("sim_batch_console", ".txt");
+  std::vector<BatchJob> jobs{{counterFile, Hart::kNoStop, console},
+                             {counterFile, Hart::kNoStop, {}},
+                             {spinFile, 100, {}},
+                             {counterFile, Hart::kNoStop, {}},
+                             {"missing.elf", Hart::kNoStop, {}}};
+  BatchRunner runner{HartConfig{}};
+  auto results = runner.run(jobs, 1);
+  fs::remove(counterFile);
+  fs::remove(spinFile);
+  ASSERT_EQ(results.size(), jobs.size());
+
+  // Stores of one job are not seen by the others
+  for (std::size_t i : {0U, 1U, 3U}) {
+    EXPECT_EQ(results[i].status, BatchResult::COMPLETED);
+    EXPECT_EQ(results[i].exitCode, 1);
+    EXPECT_EQ(results[i].numInstrs, results[0].numInstrs);
+  }
+  // Later jobs do not decode anything
+  EXPECT_GT(results[0].numDecodedBlocks, 0);
+  EXPECT_EQ(results[0].numSharedBlocks, 0);
+  EXPECT_EQ(results[1].numDecodedBlocks, 0);
+  EXPECT_EQ(results[1].numSharedBlocks, results[0].numDecodedBlocks);
+  EXPECT_EQ(results[3].numDecodedBlocks, 0);
+
+  EXPECT_EQ(results[2].status, BatchResult::LIMIT);
+  EXPECT_EQ(results[2].numInstrs, 100);
+  EXPECT_EQ(results[4].status, BatchResult::FAILED);
+  EXPECT_FALSE(results[4].error.empty());
+  EXPECT_EQ(runner.getNumImages(), 2);
+
+  std::ifstream ist{console};
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>{ist}, {}), "A");
+  fs::remove(console);
+
+  std::ostringstream ost{};
+  BatchRunner::print(ost, jobs, results);
+  EXPECT_NE(ost.str().find("Passed 0 of 5 jobs"), std::string::npos);
+}
+
+TEST(Batch, threads) {
+  using namespace reg;
+  constexpr std::size_t kNumJobs = 16;
+
+  Assembler as{};
+  as.li(T0, 1000);
+  auto loop = as.here();
+  as.iType(OpType::ADDI, T0, T0, ~Word{});
+  as.branch(OpType::BNE, T0, ZERO, loop);
+  as.ecall();
+  auto file = writeExecutable(as, "sim_batch_threads");
+
+  std::vector<BatchJob> jobs(kNumJobs, BatchJob{file, Hart::kNoStop, {}});
+  BatchRunner runner{HartConfig{}};
+  auto results = runner.run(jobs, 4);
+  fs::remove(file);
+
+  for (const auto &res : results) {
+    EXPECT_TRUE(res.isPassed());
+    EXPECT_EQ(res.numInstrs, results[0].numInstrs);
+  }
+  EXPECT_EQ(runner.getNumImages(), 1);
+}
+
+TEST(Batch, evictLeastRecentlyUsed) {
+  using namespace reg;
+  auto writeProgram = [](Word val, const std::string &name) {
+    Assembler as{};
+    as.li(T0, val);
+    as.ecall();
+    return writeExecutable(as, name);
+  };
+
+  auto hot = writeProgram(0, "sim_batch_hot");
+  std::ostringstream console{};
+  BatchRunner runner{HartConfig{}};
+  EXPECT_GT(runner.runJob({hot, Hart::kNoStop, {}}, console).numDecodedBlocks,
+            0);
+
+  // Hot image is used between others & stays loaded
+  for (std::size_t i = 0; i < BatchRunner::kMaxImages; ++i) {
+    auto file =
+        writeProgram(static_cast<Word>(i + 1), "sim_batch_evict");
+    EXPECT_TRUE(runner.runJob({file, Hart::kNoStop, {}}, console).isPassed());
+    auto res = runner.runJob({hot, Hart::kNoStop, {}}, console);
+    EXPECT_EQ(res.numDecodedBlocks, 0);
+    EXPECT_GT(res.numSharedBlocks, 0);
+  }
+  EXPECT_EQ(runner.getNumImages(), BatchRunner::kMaxImages);
+
+  // The least recently used ones are loaded again
+  auto first = writeProgram(1, "sim_batch_evict");
+  auto res = runner.runJob({first, Hart::kNoStop, {}}, console);
+  EXPECT_GT(res.numDecodedBlocks, 0);
+  EXPECT_EQ(res.numSharedBlocks, 0);
+  fs::remove(first);
+  fs::remove(hot);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,61 @@
+#include <filesystem>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_header.hh"
+#include "test_executable.hh"
+
+#include "assembler/assembler.hh"
+#include "hart/bbv.hh"
+
+using namespace sim;
+using namespace sim::test;
+
+namespace {
+
+/* Instructions of every interval from .bb lines */
+std::vector<std::uint64_t> getIntervalSizes(const std::string &bbv) {
+  std::vector<std::uint64_t> res{};
+  std::istringstream lines{bbv};
+  for (std::string line{}; std::getline(lines, line);) {
+    std::istringstream words{line.substr(1)};
+    std::uint64_t size{};
+    for (std::string word{}; words >> word;)
+      size += std::stoull(word.substr(word.rfind(':') + 1));
+    res.push_back(size);
+  }
+  return res;
+}
+
+} // namespace
+
+TEST(BBV, intervalSizes) {
+  using namespace reg;
+  constexpr std::uint64_t kInterval = 100;
+
+  Assembler as{};
+  as.li(T0, 1000);
+  auto loop = as.here();
+  as.iType(OpType::ADDI, T0, T0, ~Word{});
+  as.branch(OpType::BNE, T0, ZERO, loop);
+  as.ecall();
+  auto file = writeExecutable(as, "sim_bbv");
+
+  Hart hart{file, -1};
+  fs::remove(file);
+  std::ostringstream ost{};
+  BBVRecorder{hart, kInterval}.record(ost);
+
+  auto sizes = getIntervalSizes(ost.str());
+  auto numInstrs = hart.getInstrCount() - 1;
+  ASSERT_EQ(sizes.size(), (numInstrs + kInterval - 1) / kInterval);
+  EXPECT_EQ(std::accumulate(sizes.begin(), sizes.end(), std::uint64_t{}),
+            numInstrs);
+  // Only the last interval may be shorter
+  for (std::size_t i = 0; i + 1 < sizes.size(); ++i)
+    EXPECT_EQ(sizes[i], kInterval) << "interval " << i;
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,44 @@
+#include <sstream>
+
+#include "test_header.hh"
+
+#include "common/inst.hh"
+#include "hart/block_stats.hh"
+
+using sim::BasicBlock;
+
+TEST(BlockStats, counters) {
+  sim::BlockStats stats{};
+  sim::Instruction inst{};
+  inst.type = sim::OpType::ADDI;
+  BasicBlock cold(1, inst);
+  BasicBlock hot(3, inst);
+
+  auto &coldCounters = stats.onDecode(0x100, cold);
+  coldCounters.onExec(1);
+  auto &hotCounters = stats.onDecode(0x200, hot);
+  for (int i = 0; i < 4; ++i)
+    hotCounters.onExec(3);
+  // Evicted & decoded again
+  EXPECT_EQ(&stats.onDecode(0x200, hot), &hotCounters);
+  hotCounters.onExec(2);
+
+  auto hottest = stats.getHottest();
+  ASSERT_EQ(hottest.size(), 2);
+  EXPECT_EQ(hottest[0]->entry, 0x200);
+  EXPECT_EQ(hottest[0]->counters.numInstrs, 14);
+  EXPECT_EQ(hottest[0]->counters.numExecs, 5);
+  EXPECT_EQ(hottest[0]->counters.numMisses, 2);
+  EXPECT_EQ(hottest[1]->entry, 0x100);
+
+  sim::SymbolTable symbols{{{0x200, 0x10, "loop"}}};
+  std::ostringstream ost{};
+  stats.print(ost, 1, symbols);
+  auto report = ost.str();
+  EXPECT_NE(report.find("hit rate: 50.00% (3/6)"), std::string::npos);
+  EXPECT_NE(report.find("#1 0x00000200 <loop>: 14 instructions"),
+            std::string::npos);
+  EXPECT_EQ(report.find("#2"), std::string::npos);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,51 @@
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+#include "test_header.hh"
+#include "test_executable.hh"
+
+#include "assembler/assembler.hh"
+#include "hart/hart.hh"
+
+using namespace sim;
+using namespace sim::test;
+
+TEST(HartInstrMix, branchOutcomes) {
+  using namespace reg;
+  constexpr Word kNumIters = 10;
+
+  Assembler as{};
+  as.li(T0, kNumIters);
+  auto loop = as.here();
+  as.iType(OpType::ADDI, T0, T0, ~Word{});
+  // Taken every iteration but the last one
+  as.branch(OpType::BNE, T0, ZERO, loop);
+  // Taken forward
+  auto done = as.newLabel();
+  as.branch(OpType::BEQ, T0, ZERO, done);
+  as.nop();
+  as.bind(done);
+  // Never taken
+  as.branch(OpType::BLTU, T0, ZERO, done);
+  as.ecall();
+  auto file = writeExecutable(as, "sim_instr_mix");
+
+  Hart hart{file, -1};
+  fs::remove(file);
+  hart.enableInstrMix();
+  ASSERT_TRUE(hart.run());
+
+  const auto *mix = hart.getInstrMix();
+  ASSERT_NE(mix, nullptr);
+  EXPECT_EQ(mix->getCount(OpType::BNE), kNumIters);
+  EXPECT_EQ(mix->getCount(InstrMix::BRANCH), kNumIters + 2);
+  EXPECT_EQ(mix->getNumTakenBranches(), kNumIters);
+
+  std::ostringstream ost{};
+  mix->writeJSON(ost);
+  EXPECT_NE(ost.str().find("\"branch_taken\": 10, \"branch_not_taken\": 2"),
+            std::string::npos);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,79 @@
+#include <vector>
+
+#include "test_header.hh"
+
+#include "common/state.hh"
+#include "decoder/decoder.hh"
+#include "executor/executor.hh"
+#include "hart/lockstep.hh"
+
+using sim::Addr;
+using sim::Word;
+
+namespace {
+
+constexpr Addr kCodeBase = 0x1000;
+constexpr Addr kDataBase = 0x2000;
+
+// addi x5, x5, 1; sw x5, 0(x6); addi x6, x6, 4
+const std::vector<Word> kCode{0x00128293, 0x00532023, 0x00430313};
+
+void prepareState(sim::State &state) {
+  state.mem.storeRange(kCodeBase, kCode.begin(), kCode.end());
+  state.mem.storeEntity<Word>(kDataBase, 0);
+  state.pc = kCodeBase;
+  state.regs.set(6, kDataBase);
+}
+
+void runCode(sim::State &state, sim::Executor &exec) {
+  for (std::size_t i = 0; i < kCode.size(); ++i) {
+    auto inst = sim::Decoder::decode(state.mem.fetchInstr(state.pc));
+    exec.execute(inst, state);
+  }
+  exec.setInstrCount(exec.getInstrCount() + kCode.size());
+}
+
+} // namespace
+
+TEST(Lockstep, match) {
+  sim::State state{};
+  sim::Executor exec{};
+  prepareState(state);
+
+  sim::Lockstep lockstep{state, exec.getInstrCount()};
+  runCode(state, exec);
+  EXPECT_NO_THROW(lockstep.check(exec.getInstrCount()));
+}
+
+TEST(Lockstep, divergence) {
+  sim::State state{};
+  sim::Executor exec{};
+  prepareState(state);
+
+  sim::Lockstep lockstep{state, exec.getInstrCount()};
+  runCode(state, exec);
+  // Engine bug: wrong value stored
+  state.mem.storeEntity<Word>(kDataBase, 42);
+  EXPECT_THROW(lockstep.check(exec.getInstrCount()),
+               sim::Lockstep::DivergenceError);
+}
+
+TEST(Lockstep, registerDivergence) {
+  sim::State state{};
+  sim::Executor exec{};
+  prepareState(state);
+
+  sim::Lockstep lockstep{state, exec.getInstrCount()};
+  runCode(state, exec);
+  state.regs.set(7, 1);
+  try {
+    lockstep.check(exec.getInstrCount());
+    FAIL() << "Divergence is not detected";
+  } catch (const sim::Lockstep::DivergenceError &e) {
+    std::string msg = e.what();
+    EXPECT_NE(msg.find("registers differ"), std::string::npos);
+    EXPECT_NE(msg.find("golden: pc=0x0000100c"), std::string::npos);
+  }
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,279 @@
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_header.hh"
+#include "test_executable.hh"
+
+#include "assembler/assembler.hh"
+#include "hart/multi_hart.hh"
+
+using namespace sim;
+using namespace sim::test;
+
+namespace {
+
+constexpr std::size_t kNumHarts = 4;
+
+void csrr(Assembler &as, RegId rd, CSRegId csr) {
+  Instruction inst{};
+  inst.type = OpType::CSRRS;
+  inst.rd = rd;
+  inst.csr = csr;
+  as.emit(inst);
+}
+
+Word readWord(const MultiHart &harts, Addr addr) {
+  const auto *page =
+      harts.getPhysMemory().getPages().find(addr >> kOffsetBits);
+  if (page == nullptr)
+    throw std::out_of_range{"Page is not mapped"};
+  return page->words()[addr % kPageSize / kXLENInBytes];
+}
+
+} // namespace
+
+TEST(MultiHart, sharedMemory) {
+  using namespace reg;
+  constexpr Word kNumIters = 1000;
+
+  // Every hart counts in its own word of shared array
+  Assembler as{};
+  auto counters = as.bss(kNumHarts * kXLENInBytes);
+  csrr(as, T0, CSRegFile::MHARTID);
+  as.la(T1, counters);
+  as.iType(OpType::SLLI, T2, T0, 2);
+  as.rType(OpType::ADD, T1, T1, T2);
+  as.li(T3, kNumIters);
+  auto loop = as.here();
+  as.load(OpType::LW, T4, T1, 0);
+  as.iType(OpType::ADDI, T4, T4, 1);
+  as.store(OpType::SW, T4, T1, 0);
+  as.iType(OpType::ADDI, T3, T3, ~Word{});
+  as.branch(OpType::BNE, T3, ZERO, loop);
+  as.ecall();
+
+  auto file = writeExecutable(as, "sim_multi_hart");
+  MultiHart harts{file, kNumHarts, HartConfig{}};
+  fs::remove(file);
+  harts.run();
+
+  auto addr = as.getAddr(counters);
+  const auto *page =
+      harts.getPhysMemory().getPages().find(addr >> kOffsetBits);
+  ASSERT_NE(page, nullptr);
+  auto words = page->words().subspan(addr % kPageSize / kXLENInBytes);
+  for (std::size_t i = 0; i < kNumHarts; ++i) {
+    EXPECT_EQ(words[i], kNumIters);
+    auto snapshot = harts.getHart(i).takeSnapshot();
+    EXPECT_EQ(snapshot.csregs.get(CSRegFile::MHARTID), i);
+    EXPECT_EQ(snapshot.regs.get(T3), 0);
+  }
+  EXPECT_EQ(harts.getNumInstrs(),
+            kNumHarts * (harts.getHart(0).getInstrCount() - 1));
+}
+
+TEST(MultiHart, atomics) {
+  using namespace reg;
+  constexpr Word kNumIters = 200;
+
+  // Counters incremented under spinlock, by AMO & by LR/SC loop
+  Assembler as{};
+  auto lock = as.bss(kXLENInBytes);
+  auto counters = as.bss(3 * kXLENInBytes);
+  as.la(S0, lock);
+  as.la(S1, counters);
+  as.li(S2, kNumIters);
+  as.li(S3, 1);
+  auto loop = as.here();
+  auto acquire = as.here();
+  as.rType(OpType::AMOSWAP_W, T0, S0, S3);
+  as.branch(OpType::BNE, T0, ZERO, acquire);
+  as.load(OpType::LW, T1, S1, 0);
+  as.iType(OpType::ADDI, T1, T1, 1);
+  as.store(OpType::SW, T1, S1, 0);
+  as.rType(OpType::AMOSWAP_W, ZERO, S0, ZERO);
+
+  as.iType(OpType::ADDI, T0, S1, kXLENInBytes);
+  as.rType(OpType::AMOADD_W, ZERO, T0, S3);
+
+  as.iType(OpType::ADDI, T0, S1, 2 * kXLENInBytes);
+  auto retry = as.here();
+  as.rType(OpType::LR_W, T1, T0, ZERO);
+  as.iType(OpType::ADDI, T1, T1, 1);
+  as.rType(OpType::SC_W, T2, T0, T1);
+  as.branch(OpType::BNE, T2, ZERO, retry);
+
+  as.iType(OpType::ADDI, S2, S2, ~Word{});
+  as.branch(OpType::BNE, S2, ZERO, loop);
+  as.ecall();
+
+  auto file = writeExecutable(as, "sim_multi_hart_atomics");
+  // Spinning harts must yield to the lock holder on the same thread
+  for (std::size_t numThreads : {kNumHarts, std::size_t{1}}) {
+    MultiHart harts{file, kNumHarts, HartConfig{}};
+    harts.run(numThreads, 16);
+
+    auto addr = as.getAddr(counters);
+    const auto *page =
+        harts.getPhysMemory().getPages().find(addr >> kOffsetBits);
+    ASSERT_NE(page, nullptr);
+    auto words = page->words().subspan(addr % kPageSize / kXLENInBytes);
+    for (std::size_t i = 0; i < 3; ++i)
+      EXPECT_EQ(words[i], kNumHarts * kNumIters);
+  }
+  fs::remove(file);
+}
+
+TEST(MultiHart, manyHarts) {
+  using namespace reg;
+  constexpr std::size_t kNumManyHarts = 256;
+  constexpr std::size_t kNumThreads = 2;
+  constexpr Word kNumIters = 100;
+
+  Assembler as{};
+  auto counter = as.bss(kXLENInBytes);
+  as.la(S0, counter);
+  as.li(S1, 1);
+  as.li(S2, kNumIters);
+  auto loop = as.here();
+  as.rType(OpType::AMOADD_W, ZERO, S0, S1);
+  as.iType(OpType::ADDI, S2, S2, ~Word{});
+  as.branch(OpType::BNE, S2, ZERO, loop);
+  as.ecall();
+
+  auto file = writeExecutable(as, "sim_multi_hart_many");
+  MultiHart harts{file, kNumManyHarts, HartConfig{}};
+  fs::remove(file);
+  EXPECT_THROW(harts.run(0), std::invalid_argument);
+  EXPECT_THROW(harts.run(kNumThreads, 0), std::invalid_argument);
+  auto stats = harts.run(kNumThreads, 8);
+
+  // Every hart is resumed several times
+  EXPECT_GT(stats.numSlices, kNumManyHarts * (kNumIters / 8));
+  EXPECT_EQ(readWord(harts, as.getAddr(counter)),
+            kNumManyHarts * kNumIters);
+}
+
+TEST(MultiHart, priority) {
+  using namespace reg;
+  constexpr Word kNumIters = 100;
+
+  // Harts spin for a while & then record order in which they finish
+  Assembler as{};
+  auto index = as.bss(kXLENInBytes);
+  auto order = as.bss(2 * kXLENInBytes);
+  as.li(T0, kNumIters);
+  auto loop = as.here();
+  as.iType(OpType::ADDI, T0, T0, ~Word{});
+  as.branch(OpType::BNE, T0, ZERO, loop);
+  as.la(S0, index);
+  as.li(S1, 1);
+  as.rType(OpType::AMOADD_W, T0, S0, S1);
+  as.iType(OpType::SLLI, T0, T0, 2);
+  as.la(S1, order);
+  as.rType(OpType::ADD, T0, T0, S1);
+  csrr(as, T1, CSRegFile::MHARTID);
+  as.store(OpType::SW, T1, T0, 0);
+  as.ecall();
+
+  auto file = writeExecutable(as, "sim_multi_hart_priority");
+  // Equal priorities take turns, so hart 0 is the first one to finish
+  for (Word first : {0U, 1U}) {
+    MultiHart harts{file, 2, HartConfig{}};
+    harts.setPriority(1, static_cast<int>(first));
+    harts.run(1, 4);
+    EXPECT_EQ(readWord(harts, as.getAddr(order)), first);
+  }
+  fs::remove(file);
+}
+
+TEST(MultiHart, priorityLock) {
+  using namespace reg;
+  constexpr Word kNumIters = 100;
+
+  // Lock is taken from the start, hart 0 releases it after a while & hart 1
+  // spins on it
+  Assembler as{};
+  auto lock = as.dataWords(std::vector<Word>{1});
+  auto flag = as.bss(kXLENInBytes);
+  auto holder = as.newLabel();
+  as.la(S0, lock);
+  csrr(as, T0, CSRegFile::MHARTID);
+  as.branch(OpType::BEQ, T0, ZERO, holder);
+  as.li(S1, 1);
+  auto acquire = as.here();
+  as.rType(OpType::AMOSWAP_W, T0, S0, S1);
+  as.branch(OpType::BNE, T0, ZERO, acquire);
+  as.la(T1, flag);
+  as.store(OpType::SW, S1, T1, 0);
+  as.ecall();
+
+  as.bind(holder);
+  as.li(T0, kNumIters);
+  auto loop = as.here();
+  as.iType(OpType::ADDI, T0, T0, ~Word{});
+  as.branch(OpType::BNE, T0, ZERO, loop);
+  as.rType(OpType::AMOSWAP_W, ZERO, S0, ZERO);
+  as.ecall();
+
+  auto file = writeExecutable(as, "sim_multi_hart_priority_lock");
+  // Lower priority lock holder still gets its slices on the only thread
+  MultiHart harts{file, 2, HartConfig{}};
+  fs::remove(file);
+  harts.setPriority(1, 1);
+  harts.run(1, 4);
+  EXPECT_EQ(readWord(harts, as.getAddr(flag)), 1U);
+  EXPECT_EQ(readWord(harts, as.getAddr(lock)), 1U);
+}
+
+TEST(HartTask, slices) {
+  using namespace reg;
+  constexpr Word kNumIters = 10;
+
+  Assembler as{};
+  as.li(T0, kNumIters);
+  auto loop = as.here();
+  as.iType(OpType::ADDI, T0, T0, ~Word{});
+  as.branch(OpType::BNE, T0, ZERO, loop);
+  as.ecall();
+
+  auto file = writeExecutable(as, "sim_hart_task");
+  Hart ref{file, -1};
+  Hart hart{file, -1};
+  fs::remove(file);
+  ref.run();
+
+  // One block per slice: every iteration & final ECALL
+  auto task = hart.runTask(1);
+  std::size_t numSlices = 1;
+  while (!task.resume())
+    ++numSlices;
+  EXPECT_TRUE(task.isDone());
+  EXPECT_EQ(numSlices, kNumIters + 1);
+  EXPECT_EQ(hart.getInstrCount(), ref.getInstrCount());
+}
+
+TEST(MultiHart, failureStopsHarts) {
+  using namespace reg;
+
+  // Hart 0 fails while the others spin forever
+  Assembler as{};
+  auto fail = as.newLabel();
+  csrr(as, T0, CSRegFile::MHARTID);
+  as.branch(OpType::BEQ, T0, ZERO, fail);
+  auto spin = as.here();
+  as.j(spin);
+  as.bind(fail);
+  as.rType(OpType::AND, T0, T0, T0);
+  as.ecall();
+
+  auto file = writeExecutable(as, "sim_multi_hart_fail");
+  MultiHart harts{file, kNumHarts, HartConfig{}};
+  fs::remove(file);
+  EXPECT_THROW(harts.run(), std::runtime_error);
+  EXPECT_THROW(MultiHart(file, 0, HartConfig{}), std::invalid_argument);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,86 @@
+#include <sstream>
+#include <vector>
+
+#include "test_header.hh"
+
+#include "common/inst.hh"
+#include "hart/profiler.hh"
+
+using sim::Addr;
+using sim::Instruction;
+
+namespace {
+
+const std::vector<sim::ELFLoader::Symbol> kSymbols{
+    {0x100, 0x40, "main"}, {0x200, 0x20, "foo"}, {0x300, 0x20, "bar"}};
+
+Instruction makeJump(sim::OpType type, sim::RegId rd, sim::RegId rs1) {
+  Instruction inst{};
+  inst.type = type;
+  inst.rd = rd;
+  inst.rs1 = rs1;
+  inst.isBranch = true;
+  return inst;
+}
+
+const Instruction kAdd{};
+const Instruction kCall = makeJump(sim::OpType::JAL, 1, 0);
+const Instruction kRet = makeJump(sim::OpType::JALR, 0, 1);
+const Instruction kTailCall = makeJump(sim::OpType::JAL, 0, 0);
+
+std::string getFolded(const sim::Profiler &profiler) {
+  std::ostringstream ost{};
+  profiler.write(ost);
+  return ost.str();
+}
+
+} // namespace
+
+TEST(Profiler, callStack) {
+  sim::Profiler profiler{kSymbols, 1, 0x100, 1};
+  // main: call foo
+  std::vector block{kAdd, kAdd, kCall};
+  profiler.onBlock(0x100, block, 0x200, 4);
+  // foo: call bar
+  block = {kAdd, kCall};
+  profiler.onBlock(0x200, block, 0x300, 6);
+  // bar: return to foo
+  block = {kRet};
+  profiler.onBlock(0x300, block, 0x208, 7);
+  // foo: return to main
+  block = {kAdd, kRet};
+  profiler.onBlock(0x208, block, 0x10c, 9);
+  block = {kAdd};
+  profiler.onBlock(0x10c, block, 0x110, 10);
+
+  EXPECT_EQ(profiler.getNumSamples(), 5);
+  EXPECT_EQ(getFolded(profiler), "main 2\nmain;foo 2\nmain;foo;bar 1\n");
+}
+
+TEST(Profiler, period) {
+  sim::Profiler profiler{kSymbols, 10, 0x100, 1};
+  std::vector block{kAdd, kAdd, kAdd, kAdd};
+  for (std::uint64_t count = 5; count <= 41; count += 4)
+    profiler.onBlock(0x100, block, 0x100, count);
+
+  // Samples at 5, 17, 29 & 41 instructions
+  EXPECT_EQ(profiler.getNumSamples(), 4);
+  EXPECT_EQ(getFolded(profiler), "main 4\n");
+}
+
+TEST(Profiler, unknownCode) {
+  sim::Profiler profiler{kSymbols, 1, 0x100, 1};
+  // Tail call to code w/o symbol keeps caller frame
+  std::vector block{kTailCall};
+  profiler.onBlock(0x100, block, 0x400, 2);
+  block = {kAdd};
+  profiler.onBlock(0x400, block, 0x404, 3);
+  // Return w/o matching call is ignored
+  block = {kRet};
+  profiler.onBlock(0x404, block, 0x500, 4);
+
+  EXPECT_EQ(getFolded(profiler),
+            "main 1\nmain;0x00000400 1\nmain;0x00000404 1\n");
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,172 @@
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "test_header.hh"
+#include "test_executable.hh"
+
+#include "assembler/assembler.hh"
+#include "hart/server.hh"
+
+using namespace sim;
+using namespace sim::test;
+
+namespace {
+
+/* Prints 'A' & exits w/ code 1 */
+fs::path writeHello() {
+  using namespace reg;
+  Assembler as{};
+  as.li(T2, kUARTBase);
+  as.li(T3, 'A');
+  as.store(OpType::SB, T3, T2, 0);
+  as.li(T1, (1 << 16) + TestFinisher::FAIL);
+  as.li(T2, kFinisherBase);
+  as.store(OpType::SW, T1, T2, 0);
+  as.ecall();
+  return writeExecutable(as, "sim_server_hello");
+}
+
+/* Never terminates */
+fs::path writeSpin() {
+  Assembler as{};
+  auto loop = as.here();
+  as.j(loop);
+  return writeExecutable(as, "sim_server_spin");
+}
+
+/* Wait till condition holds, false on timeout */
+bool waitFor(const std::function<bool()> &cond) {
+  using namespace std::chrono_literals;
+  for (int i = 0; i < 1000; ++i) {
+    if (cond())
+      return true;
+    std::this_thread::sleep_for(10ms);
+  }
+  return false;
+}
+
+} // namespace
+
+TEST(JobServer, submit) {
+  auto hello = writeHello();
+  auto spinFile = writeSpin();
+
+  auto socket = getTempPath("sim_server", ".sock");
+  JobServer server{socket, HartConfig{}, 2};
+  std::jthread thread{[&] { server.run(); }};
+  EXPECT_THROW(JobServer(socket, HartConfig{}, 1), std::runtime_error);
+
+  std::string console{};
+  auto first = submitJob(socket, {hello, Hart::kNoStop, {}}, console);
+  EXPECT_EQ(first.status, BatchResult::COMPLETED);
+  EXPECT_EQ(first.exitCode, 1);
+  EXPECT_EQ(console, "A");
+  EXPECT_GT(first.numDecodedBlocks, 0);
+
+  // Decoded blocks stay warm between requests
+  auto second = submitJob(socket, {hello, Hart::kNoStop, {}}, console);
+  EXPECT_EQ(second.status, BatchResult::COMPLETED);
+  EXPECT_EQ(second.numInstrs, first.numInstrs);
+  EXPECT_EQ(second.numDecodedBlocks, 0);
+  EXPECT_EQ(second.numSharedBlocks, first.numDecodedBlocks);
+  EXPECT_EQ(console, "A");
+
+  auto limited = submitJob(socket, {spinFile, 100, {}}, console);
+  EXPECT_EQ(limited.status, BatchResult::LIMIT);
+  EXPECT_EQ(limited.numInstrs, 100);
+  EXPECT_TRUE(console.empty());
+
+  auto missing = submitJob(socket, {"missing.elf", Hart::kNoStop, {}}, console);
+  EXPECT_EQ(missing.status, BatchResult::FAILED);
+  EXPECT_FALSE(missing.error.empty());
+
+  EXPECT_THROW(submitJob(socket, {hello, Hart::kNoStop, "out.txt"}, console),
+               std::invalid_argument);
+
+  {
+    std::vector<std::jthread> clients{};
+    for (int i = 0; i < 4; ++i)
+      clients.emplace_back([&] {
+        std::string out{};
+        auto res = submitJob(socket, {hello, Hart::kNoStop, {}}, out);
+        EXPECT_EQ(res.exitCode, 1);
+        EXPECT_EQ(out, "A");
+      });
+  }
+  EXPECT_EQ(server.getNumJobs(), 8);
+
+  server.stop();
+  thread.join();
+  EXPECT_THROW(submitJob(socket, {hello, Hart::kNoStop, {}}, console),
+               std::system_error);
+  fs::remove(hello);
+  fs::remove(spinFile);
+}
+
+TEST(JobServer, stopRunningJob) {
+  auto spinFile = writeSpin();
+  auto socket = getTempPath("sim_server_stop", ".sock");
+  JobServer server{socket, HartConfig{}, 1};
+  std::jthread thread{[&] { server.run(); }};
+
+  BatchResult res{};
+  std::string console{};
+  std::jthread client{[&] {
+    res = submitJob(socket, {spinFile, Hart::kNoStop, {}}, console);
+  }};
+  ASSERT_TRUE(waitFor([&] { return server.getNumRunningJobs() == 1; }));
+
+  // Returns only after the running job is stopped
+  server.stop();
+  thread.join();
+  client.join();
+  EXPECT_EQ(res.status, BatchResult::STOPPED);
+  EXPECT_GT(res.numInstrs, 0);
+  EXPECT_FALSE(res.error.empty());
+  fs::remove(spinFile);
+}
+
+TEST(JobServer, clientHangUp) {
+  auto spinFile = writeSpin();
+  auto socket = getTempPath("sim_server_hangup", ".sock");
+  JobServer server{socket, HartConfig{}, 1};
+  std::jthread thread{[&] { server.run(); }};
+
+  {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, socket.c_str());
+    int conn = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(conn, 0);
+    ASSERT_EQ(connect(conn, reinterpret_cast<const sockaddr *>(&addr),
+                      sizeof(addr)),
+              0);
+    auto request = fs::absolute(spinFile).string() + '\n';
+    ASSERT_EQ(write(conn, request.data(), request.size()),
+              static_cast<ssize_t>(request.size()));
+    ASSERT_TRUE(waitFor([&] { return server.getNumRunningJobs() == 1; }));
+    close(conn);
+  }
+
+  // The only worker is free for other clients again
+  ASSERT_TRUE(waitFor([&] { return server.getNumRunningJobs() == 0; }));
+  std::string console{};
+  auto res = submitJob(socket, {spinFile, 100, {}}, console);
+  EXPECT_EQ(res.status, BatchResult::LIMIT);
+
+  server.stop();
+  thread.join();
+  fs::remove(spinFile);
+}
+
+#include "test_footer.hh"
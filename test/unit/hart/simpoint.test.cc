@@ -0,0 +1,32 @@
+#include <filesystem>
+
+#include "test_header.hh"
+#include "test_files.hh"
+
+#include "hart/simpoint.hh"
+
+namespace fs = std::filesystem;
+
+using sim::test::writeFile;
+
+TEST(SimPoint, load) {
+  auto simpoints = writeFile("simpoints", "17 1\n3 0\n");
+  auto weights = writeFile("weights", "0.25 0\n0.75 1\n");
+
+  auto points = sim::loadSimPoints(simpoints, weights);
+  ASSERT_EQ(points.size(), 2);
+  EXPECT_EQ(points[0].interval, 3);
+  EXPECT_DOUBLE_EQ(points[0].weight, 0.25);
+  EXPECT_EQ(points[1].interval, 17);
+  EXPECT_DOUBLE_EQ(points[1].weight, 0.75);
+
+  auto noWeight = writeFile("noweight", "0.25 0\n");
+  EXPECT_THROW(sim::loadSimPoints(simpoints, noWeight), std::runtime_error);
+  auto bad = writeFile("bad", "3 0\nfoo 1\n");
+  EXPECT_THROW(sim::loadSimPoints(bad, weights), std::runtime_error);
+
+  for (const auto &file : {simpoints, weights, noWeight, bad})
+    fs::remove(file);
+}
+
+#include "test_footer.hh"
@@ -1,3 +1,7 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "test_header.hh"
 
 #include "common/common.hh"
@@ -120,14 +124,16 @@ TEST(PhysMemory, getEntity) {
 }
 
 TEST(TLB, getTLBIndex) {
-  sim::TLB tlb;
+  // Direct-mapped
+  sim::TLB tlb{sim::kTLBSize, 1};
   EXPECT_EQ(tlb.getTLBIndex(0xDEADBEEF), 731);
   EXPECT_EQ(tlb.getTLBIndex(0x0), 0);
   EXPECT_EQ(tlb.getTLBIndex(0xFFFFFFFF), 1023);
 }
 
 TEST(TLB, tlbLookup) {
-  sim::TLB tlb;
+  // Direct-mapped
+  sim::TLB tlb{sim::kTLBSize, 1};
   Page page_1{};
   tlb.tlbUpdate(0xDEADBEEF, &page_1);
 
@@ -152,10 +158,254 @@ TEST(TLB, tlbLookup) {
   EXPECT_EQ(tlb.tlbLookup(0xDEADBEEF), nullptr); // miss
   EXPECT_EQ(tlb.tlbLookup(0xFAADBDEA), &page_3); // hit
 
+#ifdef TLB_STATS
   auto stats = tlb.getTLBStats();
   EXPECT_EQ(stats.TLBHits, 7);
   EXPECT_EQ(stats.TLBMisses, 3);
   EXPECT_EQ(stats.TLBRequests, 10);
+#endif
+}
+
+TEST(TLB, badGeometry) {
+  EXPECT_THROW(sim::TLB(1024, 0), std::invalid_argument);
+  EXPECT_THROW(sim::TLB(1024, 3), std::invalid_argument);
+  EXPECT_THROW(sim::TLB(96, 2), std::invalid_argument);
+  EXPECT_NO_THROW(sim::TLB(8, 8));
+}
+
+TEST(TLB, setAssociative) {
+  sim::TLB tlb{8, 2};
+  EXPECT_EQ(tlb.getNumSets(), 4);
+  EXPECT_EQ(tlb.getNumWays(), 2);
+
+  // 0x1000, 0x5000 & 0x9000 fall into the same set
+  Page page_1{}, page_2{}, page_3{};
+  EXPECT_EQ(tlb.getTLBIndex(0x1000), tlb.getTLBIndex(0x5000));
+  EXPECT_EQ(tlb.getTLBIndex(0x1000), tlb.getTLBIndex(0x9000));
+
+  tlb.tlbUpdate(0x1000, &page_1);
+  tlb.tlbUpdate(0x5000, &page_2);
+  // Both ways are occupied, no conflict
+  EXPECT_EQ(tlb.tlbLookup(0x1234), &page_1);
+  EXPECT_EQ(tlb.tlbLookup(0x5678), &page_2);
+
+  // 0x1000 is LRU now -> evicted
+  tlb.tlbUpdate(0x9000, &page_3);
+  EXPECT_EQ(tlb.tlbLookup(0x1000), nullptr);
+  EXPECT_EQ(tlb.tlbLookup(0x5000), &page_2);
+  EXPECT_EQ(tlb.tlbLookup(0x9000), &page_3);
+
+  // Updating present page does not evict anything
+  tlb.tlbUpdate(0x5000, &page_1);
+  EXPECT_EQ(tlb.tlbLookup(0x5000), &page_1);
+  EXPECT_EQ(tlb.tlbLookup(0x9000), &page_3);
+}
+
+TEST(TLB, tlbFlush) {
+  sim::TLB tlb;
+  Page page_1{};
+  tlb.tlbUpdate(0xDEADBEEF, &page_1);
+  EXPECT_EQ(tlb.tlbLookup(0xDEADBEEF), &page_1);
+
+  tlb.tlbFlush();
+  EXPECT_EQ(tlb.tlbLookup(0xDEADBEEF), nullptr);
+
+  // TLB is still usable after flush
+  tlb.tlbUpdate(0xDEADBEEF, &page_1);
+  EXPECT_EQ(tlb.tlbLookup(0xDEADBEEF), &page_1);
+  tlb.tlbFlush();
+  tlb.tlbFlush();
+  EXPECT_EQ(tlb.tlbLookup(0xDEADBEEF), nullptr);
+}
+
+TEST(TLB, splitInstrData) {
+  sim::Memory mem;
+  mem.storeEntity<Word>(0x1000, 0x13);
+  EXPECT_EQ(mem.fetchInstr(0x1000), 0x13);
+  EXPECT_EQ(mem.fetchInstr(0x1004), 0x0);
+  EXPECT_EQ(mem.loadEntity<Word>(0x1000), 0x13);
+
+  // Fetch on unmapped region
+  EXPECT_THROW(mem.fetchInstr(0x2000), sim::PhysMemory::PageFaultException);
+
+#ifdef TLB_STATS
+  auto iStats = mem.getInstrTLBStats();
+  EXPECT_EQ(iStats.TLBRequests, 3);
+  EXPECT_EQ(iStats.TLBHits, 1);
+
+  auto dStats = mem.getDataTLBStats();
+  EXPECT_EQ(dStats.TLBRequests, 2);
+  EXPECT_EQ(dStats.TLBHits, 1);
+#endif
+}
+
+TEST(PhysMemory, dirtyTracking) {
+  sim::Memory mem;
+  mem.storeEntity<Word>(0x1000, 1);
+  mem.storeEntity<Word>(0x3004, 2);
+  EXPECT_EQ(mem.getDirtyPages(), (std::vector<std::uint32_t>{1, 3}));
+
+  mem.clearDirty();
+  EXPECT_TRUE(mem.getDirtyPages().empty());
+
+  // Loads keep page clean, first store after clear marks it dirty again
+  EXPECT_EQ(mem.loadEntity<Word>(0x1000), 1);
+  EXPECT_TRUE(mem.getDirtyPages().empty());
+  mem.storeEntity<Word>(0x1000, 3);
+  mem.storeEntity<Word>(0x1008, 4);
+  EXPECT_EQ(mem.getDirtyPages(), (std::vector<std::uint32_t>{1}));
+}
+
+TEST(PhysMemory, dirtyTrackers) {
+  using sim::PhysMemory;
+  sim::Memory mem;
+  mem.storeEntity<Word>(0x1000, 1);
+  mem.clearDirty(PhysMemory::HASH);
+  EXPECT_EQ(mem.getDirtyPages(), (std::vector<std::uint32_t>{1}));
+  EXPECT_TRUE(mem.getDirtyPages(PhysMemory::HASH).empty());
+
+  // Page stays dirty for snapshot, but store has to be seen by hash tracker
+  mem.storeEntity<Word>(0x1004, 2);
+  EXPECT_EQ(mem.getDirtyPages(PhysMemory::HASH),
+            (std::vector<std::uint32_t>{1}));
+
+  mem.clearDirty(PhysMemory::SNAPSHOT);
+  mem.storeEntity<Word>(0x1008, 3);
+  EXPECT_EQ(mem.getDirtyPages(), (std::vector<std::uint32_t>{1}));
+}
+
+TEST(PhysMemory, snapshot) {
+  sim::Memory mem;
+  mem.storeEntity<Word>(0x1000, 1);
+  mem.storeEntity<Word>(0x2000, 2);
+  auto snapshot = mem.takeSnapshot();
+  EXPECT_TRUE(mem.getDirtyPages().empty());
+
+  mem.storeEntity<Word>(0x1000, 10);
+  mem.storeEntity<Word>(0x5000, 50);
+  mem.restoreSnapshot(snapshot);
+  EXPECT_TRUE(mem.getDirtyPages().empty());
+  EXPECT_EQ(mem.loadEntity<Word>(0x1000), 1);
+  EXPECT_EQ(mem.loadEntity<Word>(0x2000), 2);
+  // Page created after snapshot is gone
+  EXPECT_THROW(mem.loadEntity<Word>(0x5000),
+               sim::PhysMemory::PageFaultException);
+
+  // Restore can be repeated
+  mem.storeEntity<Word>(0x2000, 20);
+  mem.restoreSnapshot(snapshot);
+  EXPECT_EQ(mem.loadEntity<Word>(0x2000), 2);
+
+  // Incremental update moves snapshot forward
+  mem.storeEntity<Word>(0x2000, 200);
+  mem.storeEntity<Word>(0x6000, 60);
+  mem.updateSnapshot(snapshot);
+  mem.storeEntity<Word>(0x2000, 0);
+  mem.restoreSnapshot(snapshot);
+  EXPECT_EQ(mem.loadEntity<Word>(0x1000), 1);
+  EXPECT_EQ(mem.loadEntity<Word>(0x2000), 200);
+  EXPECT_EQ(mem.loadEntity<Word>(0x6000), 60);
+}
+
+TEST(PhysMemory, mapPages) {
+  sim::Memory mem;
+  mem.storeEntity<Word>(0x1000, 1);
+
+  auto storage = std::make_shared<std::vector<Word>>(2 * Page::kWords);
+  (*storage)[0] = 0xDEADBEEF;
+  mem.mapPages({{0x2, storage->data()}, {0x5, storage->data() + Page::kWords}},
+               storage);
+
+  // Old contents are gone, accesses go to external storage
+  EXPECT_THROW(mem.loadEntity<Word>(0x1000),
+               sim::PhysMemory::PageFaultException);
+  EXPECT_EQ(mem.loadEntity<Word>(0x2000), 0xDEADBEEF);
+  mem.storeEntity<Word>(0x5004, 42);
+  EXPECT_EQ((*storage)[Page::kWords + 1], 42);
+  EXPECT_EQ(mem.getDirtyPages(), (std::vector<std::uint32_t>{5}));
+
+  // Snapshot holds its own copy of external pages
+  auto snapshot = mem.takeSnapshot();
+  mem.storeEntity<Word>(0x2000, 0);
+  mem.restoreSnapshot(snapshot);
+  EXPECT_EQ((*storage)[0], 0xDEADBEEF);
+}
+
+TEST(PageTable, insertFind) {
+  sim::PageTable pages;
+  EXPECT_EQ(pages.find(7), nullptr);
+  EXPECT_EQ(pages.begin(), pages.end());
+
+  Page page{};
+  page.words()[0] = 42;
+  auto *ptr = pages.insert(7, page);
+  EXPECT_EQ(pages.find(7), ptr);
+  EXPECT_EQ(ptr->words()[0], 42);
+  // Present page is kept
+  EXPECT_EQ(pages.insert(7, Page{}), ptr);
+  EXPECT_EQ(ptr->words()[0], 42);
+
+  // Iteration is ordered by page numbers & skips missing leaves
+  pages.insert(sim::PageTable::kNumPages - 1, Page{});
+  pages.insert(3, Page{});
+  std::vector<std::uint32_t> ppns{};
+  for (const auto &[ppn, cur] : pages)
+    ppns.push_back(ppn);
+  EXPECT_EQ(ppns, (std::vector<std::uint32_t>{
+                      3, 7, sim::PageTable::kNumPages - 1}));
+  EXPECT_EQ(pages.size(), 3);
+
+  pages.erase(7);
+  pages.erase(8);
+  EXPECT_EQ(pages.find(7), nullptr);
+  EXPECT_EQ(pages.size(), 2);
+  pages.clear();
+  EXPECT_EQ(pages.begin(), pages.end());
+  EXPECT_EQ(pages.size(), 0);
+}
+
+TEST(PageTable, concurrentInsert) {
+  constexpr std::size_t kNumThreads = 4;
+  constexpr std::uint32_t kNumPages = 4096;
+
+  // Every thread inserts the same pages in its own order
+  sim::PageTable pages;
+  std::vector<std::vector<PagePtr>> found(
+      kNumThreads, std::vector<PagePtr>(kNumPages));
+  {
+    std::vector<std::jthread> threads{};
+    for (std::size_t i = 0; i < kNumThreads; ++i)
+      threads.emplace_back([&, i] {
+        for (std::uint32_t j = 0; j < kNumPages; ++j) {
+          auto ppn = (j * 7 + static_cast<std::uint32_t>(i) * 1031) % kNumPages;
+          found[i][ppn] = pages.insert(ppn * 3, Page{});
+        }
+      });
+  }
+
+  EXPECT_EQ(pages.size(), kNumPages);
+  for (std::uint32_t ppn = 0; ppn < kNumPages; ++ppn)
+    for (const auto &ptrs : found)
+      EXPECT_EQ(ptrs[ppn], pages.find(ppn * 3));
+}
+
+TEST(PhysMemory, shared) {
+  auto physMem = std::make_shared<sim::PhysMemory>();
+  sim::Memory first{physMem};
+  sim::Memory second{physMem};
+
+  // Stores are visible through the other view
+  first.storeEntity<Word>(0x1000, 1);
+  EXPECT_EQ(second.loadEntity<Word>(0x1000), 1);
+  second.storeEntity<Word>(0x1004, 2);
+  EXPECT_EQ(first.loadEntity<Word>(0x1004), 2);
+  EXPECT_EQ(physMem->getDirtyPages(), (std::vector<std::uint32_t>{1}));
+
+  // Translation is private
+  first.setSatp(sim::RegVal{1} << 31);
+  EXPECT_TRUE(first.getMMU().isPagingOn());
+  EXPECT_FALSE(second.getMMU().isPagingOn());
+  EXPECT_EQ(first.getMemStats().numStores, 1);
 }
 
 #include "test_footer.hh"
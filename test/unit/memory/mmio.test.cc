@@ -0,0 +1,100 @@
+#include <sstream>
+
+#include "test_header.hh"
+
+#include "common/common.hh"
+#include "memory/memory.hh"
+#include "memory/mmio.hh"
+
+using sim::Addr;
+using sim::Word;
+
+TEST(MMIO, uartBuffering) {
+  std::ostringstream out;
+  sim::UART uart{out, 4};
+  EXPECT_EQ(uart.read(sim::UART::LSR, sizeof(Word)), sim::UART::kLSRTxIdle);
+
+  for (char sym : std::string{"abc"})
+    uart.write(sim::UART::THR, static_cast<Word>(sym), sizeof(Word));
+  EXPECT_TRUE(out.str().empty());
+
+  // Buffer is full
+  uart.write(sim::UART::THR, 'd', sizeof(Word));
+  EXPECT_EQ(out.str(), "abcd");
+
+  uart.write(sim::UART::THR, 'e', sizeof(Word));
+  uart.flush();
+  EXPECT_EQ(out.str(), "abcde");
+}
+
+TEST(MMIO, busLayout) {
+  sim::MMIOBus bus;
+  std::ostringstream out;
+  EXPECT_TRUE(bus.empty());
+
+  EXPECT_THROW(bus.addDevice(0x10, std::make_unique<sim::UART>(out)),
+               std::invalid_argument);
+  bus.addDevice(0x0, std::make_unique<sim::CLINT>([] { return 0; }));
+  EXPECT_THROW(bus.addDevice(0xF000, std::make_unique<sim::UART>(out)),
+               std::invalid_argument);
+  bus.addDevice(0x10000, std::make_unique<sim::UART>(out));
+
+  EXPECT_TRUE(bus.isDevicePage(0xF004));
+  EXPECT_TRUE(bus.isDevicePage(0x10005));
+  EXPECT_FALSE(bus.isDevicePage(0x11000));
+}
+
+TEST(MMIO, dispatch) {
+  sim::Memory mem;
+  std::ostringstream out;
+  sim::DWord time = 0x100000002;
+  auto *uart = dynamic_cast<sim::UART *>(
+      mem.addDevice(sim::kUARTBase, std::make_unique<sim::UART>(out)));
+  mem.addDevice(sim::kCLINTBase,
+                std::make_unique<sim::CLINT>([&time] { return time; }));
+
+  mem.storeEntity<Word>(0x1000, 42);
+  for (char sym : std::string{"Hi\n"})
+    mem.storeEntity<Word>(sim::kUARTBase + sim::UART::THR,
+                          static_cast<Word>(sym));
+  uart->flush();
+  EXPECT_EQ(out.str(), "Hi\n");
+  EXPECT_EQ(mem.loadEntity<Word>(0x1000), 42);
+  EXPECT_EQ(mem.loadEntity<Word>(sim::kUARTBase + 4), 0);
+
+  // Device registers are read every time, not cached
+  auto mtime = sim::kCLINTBase + sim::CLINT::MTIME;
+  EXPECT_EQ(mem.loadEntity<Word>(mtime), 2);
+  EXPECT_EQ(mem.loadEntity<Word>(mtime + 4), 1);
+  time = 3;
+  EXPECT_EQ(mem.loadEntity<Word>(mtime), 3);
+
+  auto mtimecmp = sim::kCLINTBase + sim::CLINT::MTIMECMP;
+  mem.storeEntity<Word>(mtimecmp + 4, 0xAB);
+  mem.storeEntity<Word>(mtimecmp, 0xCD);
+  EXPECT_EQ(mem.loadEntity<Word>(mtimecmp), 0xCD);
+  EXPECT_EQ(mem.loadEntity<Word>(mtimecmp + 4), 0xAB);
+
+  // Device memory is neither executable nor part of RAM
+  EXPECT_THROW(mem.fetchInstr(sim::kUARTBase),
+               sim::PhysMemory::PageFaultException);
+  EXPECT_EQ(mem.getPages().find(sim::kUARTBase >> sim::kOffsetBits), nullptr);
+}
+
+TEST(MMIO, testFinisher) {
+  sim::Memory mem;
+  std::optional<int> exitCode{};
+  mem.addDevice(sim::kFinisherBase,
+                std::make_unique<sim::TestFinisher>(
+                    [&exitCode](int code) { exitCode = code; }));
+
+  mem.storeEntity<Word>(sim::kFinisherBase, 0x1234);
+  EXPECT_FALSE(exitCode.has_value());
+  mem.storeEntity<Word>(sim::kFinisherBase,
+                        (3 << 16) | sim::TestFinisher::FAIL);
+  EXPECT_EQ(exitCode, 3);
+  mem.storeEntity<Word>(sim::kFinisherBase, sim::TestFinisher::PASS);
+  EXPECT_EQ(exitCode, 0);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,205 @@
+#include <string>
+
+#include "test_header.hh"
+
+#include "common/common.hh"
+#include "memory/memory.hh"
+#include "memory/mmu.hh"
+
+using sim::Addr;
+using sim::Word;
+using PageFault = sim::PhysMemory::PageFaultException;
+namespace sv32 = sim::sv32;
+
+constexpr Addr kRootTable = 0x1000;
+constexpr Addr kLeafTable = 0x2000;
+constexpr Addr kVirtPage = 0x40000000;
+constexpr Word kRWAD = sv32::V | sv32::R | sv32::W | sv32::A | sv32::D;
+constexpr Word kRWXAD = kRWAD | sv32::X;
+
+static Word makePTE(Addr physAddr, Word flags) {
+  return ((physAddr >> sim::kOffsetBits) << 10) | flags;
+}
+
+static Word makeSatp(Word asid, Addr root) {
+  return (1U << sv32::kSatpModeBit) | (asid << sv32::kSatpASIDShift) |
+         (root >> sim::kOffsetBits);
+}
+
+static Addr getPTEAddr(Addr table, Word vpn) {
+  return table + vpn * sv32::kPTESize;
+}
+
+/*
+ * Page tables layout:
+ *   0x00000000 - 0x003FFFFF -> identity superpage (page tables are here)
+ *   0x40000000 -> 0x5000 (RWX)
+ *   0x40001000 -> 0x6000 (R)
+ *   0x40002000 -> 0x7000 (RW, not dirty)
+ */
+static void fillPageTables(sim::Memory &mem) {
+  mem.storeEntity<Word>(getPTEAddr(kRootTable, 0), makePTE(0, kRWAD));
+  mem.storeEntity<Word>(getPTEAddr(kRootTable, sv32::getVPN1(kVirtPage)),
+                        makePTE(kLeafTable, sv32::V));
+  mem.storeEntity<Word>(getPTEAddr(kLeafTable, 0), makePTE(0x5000, kRWXAD));
+  mem.storeEntity<Word>(getPTEAddr(kLeafTable, 1),
+                        makePTE(0x6000, sv32::V | sv32::R));
+  mem.storeEntity<Word>(getPTEAddr(kLeafTable, 2),
+                        makePTE(0x7000, sv32::V | sv32::R | sv32::W));
+  mem.storeEntity<Word>(0x5000, 0xDEADBEEF);
+  mem.storeEntity<Word>(0x6000, 0xCAFEBABE);
+  mem.storeEntity<Word>(0x7000, 0x0);
+}
+
+TEST(MMU, bareMode) {
+  sim::Memory mem;
+  EXPECT_FALSE(mem.getMMU().isPagingOn());
+
+  mem.storeEntity<Word>(kVirtPage, 42);
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 42);
+
+  mem.setSatp(0);
+  EXPECT_FALSE(mem.getMMU().isPagingOn());
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 42);
+}
+
+TEST(MMU, translate) {
+  sim::Memory mem;
+  fillPageTables(mem);
+  mem.setSatp(makeSatp(1, kRootTable));
+  EXPECT_TRUE(mem.getMMU().isPagingOn());
+  EXPECT_EQ(mem.getMMU().getASID(), 1);
+
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xDEADBEEF);
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage + 0x1000), 0xCAFEBABE);
+  EXPECT_EQ(mem.fetchInstr(kVirtPage), 0xDEADBEEF);
+
+  // Store is visible through identity superpage
+  mem.storeEntity<Word>(kVirtPage + 4, 0x12345678);
+  EXPECT_EQ(mem.loadEntity<Word>(0x5004), 0x12345678);
+
+  // Unmapped page & access w/o permission
+  EXPECT_THROW(mem.loadEntity<Word>(kVirtPage + 0x3000), PageFault);
+  EXPECT_THROW(mem.loadEntity<Word>(0x80000000), PageFault);
+  EXPECT_THROW(mem.storeEntity<Word>(kVirtPage + 0x1000, 0), PageFault);
+  EXPECT_THROW(mem.fetchInstr(kVirtPage + 0x1000), PageFault);
+}
+
+TEST(MMU, accessedDirtyBits) {
+  sim::Memory mem;
+  fillPageTables(mem);
+  mem.setSatp(makeSatp(1, kRootTable));
+
+  auto pteAddr = getPTEAddr(kLeafTable, 2);
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage + 0x2000), 0);
+  auto pte = mem.loadEntity<Word>(pteAddr);
+  EXPECT_TRUE(pte & sv32::A);
+  EXPECT_FALSE(pte & sv32::D);
+
+  // Page was cached as clean, so store has to walk again and set D
+  mem.storeEntity<Word>(kVirtPage + 0x2000, 1);
+  pte = mem.loadEntity<Word>(pteAddr);
+  EXPECT_TRUE(pte & sv32::D);
+  EXPECT_EQ(mem.loadEntity<Word>(0x7000), 1);
+}
+
+TEST(MMU, dirtyPages) {
+  sim::Memory mem;
+  fillPageTables(mem);
+  mem.setSatp(makeSatp(1, kRootTable));
+  mem.clearDirty();
+
+  // A bit update by the walker dirties the leaf table page
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage + 0x2000), 0);
+  EXPECT_EQ(mem.getDirtyPages(),
+            (std::vector<std::uint32_t>{kLeafTable >> sim::kOffsetBits}));
+
+  // Translation is cached, but page is clean: store must mark it dirty
+  mem.clearDirty();
+  mem.storeEntity<Word>(kVirtPage + 4, 1);
+  EXPECT_EQ(mem.getDirtyPages(), (std::vector<std::uint32_t>{0x5}));
+}
+
+TEST(MMU, superPage) {
+  sim::Memory mem;
+  fillPageTables(mem);
+  // 0x80000000 - 0x803FFFFF -> 0x00400000
+  mem.storeEntity<Word>(getPTEAddr(kRootTable, sv32::getVPN1(0x80000000)),
+                        makePTE(0x00400000, kRWAD));
+  // Misaligned superpage
+  mem.storeEntity<Word>(getPTEAddr(kRootTable, sv32::getVPN1(0xC0000000)),
+                        makePTE(0x00401000, kRWAD));
+  mem.storeEntity<Word>(0x00412344, 0xABCD);
+  mem.setSatp(makeSatp(0, kRootTable));
+
+  EXPECT_EQ(mem.loadEntity<Word>(0x80012344), 0xABCD);
+  EXPECT_THROW(mem.loadEntity<Word>(0xC0000000), PageFault);
+
+  // Fault is reported at the level walk has stopped
+  try {
+    mem.fetchInstr(0x80000000);
+    FAIL() << "Superpage is not executable";
+  } catch (const PageFault &e) {
+    EXPECT_NE(std::string{e.what()}.find("level 1"), std::string::npos);
+  }
+}
+
+TEST(MMU, asidAndGlobal) {
+  sim::Memory mem;
+  fillPageTables(mem);
+
+  // Second address space: root at 0x3000, same VA mapped to 0x6000,
+  // global page at 0x40003000 (unmapped in the first one)
+  constexpr Addr kRootTable2 = 0x3000;
+  constexpr Addr kLeafTable2 = 0x4000;
+  constexpr Addr kGlobalPage = kVirtPage + 0x3000;
+  mem.storeEntity<Word>(getPTEAddr(kRootTable2, 0), makePTE(0, kRWAD));
+  mem.storeEntity<Word>(getPTEAddr(kRootTable2, sv32::getVPN1(kVirtPage)),
+                        makePTE(kLeafTable2, sv32::V));
+  mem.storeEntity<Word>(getPTEAddr(kLeafTable2, 0), makePTE(0x6000, kRWAD));
+  mem.storeEntity<Word>(getPTEAddr(kLeafTable2, 3),
+                        makePTE(0x5000, kRWAD | sv32::G));
+
+  mem.setSatp(makeSatp(1, kRootTable));
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xDEADBEEF);
+  EXPECT_THROW(mem.loadEntity<Word>(kGlobalPage), PageFault);
+  // No flush is needed to switch address space
+  mem.setSatp(makeSatp(2, kRootTable2));
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xCAFEBABE);
+  EXPECT_EQ(mem.loadEntity<Word>(kGlobalPage), 0xDEADBEEF);
+  mem.setSatp(makeSatp(1, kRootTable));
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xDEADBEEF);
+
+  // Global mapping is visible in every address space & survives ASID flush
+  EXPECT_EQ(mem.loadEntity<Word>(kGlobalPage), 0xDEADBEEF);
+  mem.sfenceVMA(std::nullopt, 1);
+  EXPECT_EQ(mem.loadEntity<Word>(kGlobalPage), 0xDEADBEEF);
+  mem.sfenceVMA(kGlobalPage, 1);
+  EXPECT_EQ(mem.loadEntity<Word>(kGlobalPage), 0xDEADBEEF);
+
+  mem.sfenceVMA(kGlobalPage, std::nullopt);
+  EXPECT_THROW(mem.loadEntity<Word>(kGlobalPage), PageFault);
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xDEADBEEF);
+}
+
+TEST(MMU, sfenceVMA) {
+  sim::Memory mem;
+  fillPageTables(mem);
+  mem.setSatp(makeSatp(1, kRootTable));
+  auto epoch = mem.getTranslationEpoch();
+
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xDEADBEEF);
+  // Remap page: stale translation is used till SFENCE.VMA
+  mem.storeEntity<Word>(getPTEAddr(kLeafTable, 0), makePTE(0x6000, kRWAD));
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xDEADBEEF);
+
+  // Other page flush does not help
+  mem.sfenceVMA(kVirtPage + 0x1000, std::nullopt);
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xDEADBEEF);
+
+  mem.sfenceVMA(kVirtPage, 1);
+  EXPECT_EQ(mem.loadEntity<Word>(kVirtPage), 0xCAFEBABE);
+  EXPECT_GT(mem.getTranslationEpoch(), epoch);
+}
+
+#include "test_footer.hh"
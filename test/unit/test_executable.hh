@@ -0,0 +1,21 @@
+#ifndef __TEST_UNIT_TEST_EXECUTABLE_HH__
+#define __TEST_UNIT_TEST_EXECUTABLE_HH__
+
+#include <string>
+
+#include "test_files.hh"
+
+#include "assembler/assembler.hh"
+
+namespace sim::test {
+
+/* Write assembled program as executable in temporary directory */
+inline fs::path writeExecutable(const Assembler &as, const std::string &name) {
+  auto file = getTempPath(name, ".elf");
+  as.write(file);
+  return file;
+}
+
+} // namespace sim::test
+
+#endif // __TEST_UNIT_TEST_EXECUTABLE_HH__
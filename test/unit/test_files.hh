@@ -0,0 +1,27 @@
+#ifndef __TEST_UNIT_TEST_FILES_HH__
+#define __TEST_UNIT_TEST_FILES_HH__
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace sim::test {
+
+namespace fs = std::filesystem;
+
+/* Path in temporary directory unique for test process */
+inline fs::path getTempPath(const std::string &name, const std::string &ext) {
+  return fs::temp_directory_path() /
+         (name + "." + std::to_string(getpid()) + ext);
+}
+
+inline fs::path writeFile(const std::string &name, const std::string &text) {
+  auto file = getTempPath(name, ".txt");
+  std::ofstream{file} << text;
+  return file;
+}
+
+} // namespace sim::test
+
+#endif // __TEST_UNIT_TEST_FILES_HH__
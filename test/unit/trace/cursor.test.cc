@@ -0,0 +1,138 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "test_header.hh"
+#include "test_files.hh"
+
+#include "common/common.hh"
+#include "trace/cursor.hh"
+#include "trace/trace.hh"
+
+namespace fs = std::filesystem;
+
+using sim::Addr;
+using sim::Byte;
+using sim::InstrEffects;
+using sim::TraceFile;
+
+namespace {
+
+constexpr std::uint64_t kFirstNum = 5;
+constexpr std::uint64_t kNumInstrs = 500;
+constexpr Addr kStartPC = 0x1000;
+
+Addr getNextPC(std::uint64_t num, Addr pc) {
+  return num % 10 ? pc + 4 : kStartPC;
+}
+
+/* Same instructions in binary & text formats */
+std::vector<Byte> makeBinaryTrace() {
+  auto file = sim::test::getTempPath("cursor", ".trace");
+  {
+    sim::Tracer tracer{file, 128, 2};
+    tracer.sync(kFirstNum, kStartPC);
+    Addr pc = kStartPC;
+    for (auto num = kFirstNum; num < kFirstNum + kNumInstrs; ++num) {
+      tracer.regWrite(static_cast<sim::RegId>(num % 31 + 1),
+                      static_cast<sim::RegVal>(num));
+      if (num % 3 == 0)
+        tracer.memWrite(static_cast<Addr>(num * 4), 0xDEAD);
+      pc = getNextPC(num, pc);
+      tracer.instrEnd(pc, num % 7 ? 0 : sim::trace::CSR_ACCESS);
+    }
+  }
+
+  std::ifstream ist{file, std::ios::binary};
+  std::vector<Byte> data{std::istreambuf_iterator<char>{ist},
+                         std::istreambuf_iterator<char>{}};
+  fs::remove(file);
+  return data;
+}
+
+std::vector<Byte> makeTextTrace() {
+  std::string text{};
+  Addr pc = kStartPC;
+  for (auto num = kFirstNum; num < kFirstNum + kNumInstrs; ++num) {
+    InstrEffects effects{};
+    effects.num = num;
+    effects.regs.emplace_back(static_cast<sim::RegId>(num % 31 + 1),
+                              static_cast<sim::RegVal>(num));
+    if (num % 3 == 0)
+      effects.mems.emplace_back(static_cast<Addr>(num * 4), 0xDEAD);
+    effects.pc = pc = getNextPC(num, pc);
+    text += effects.str();
+  }
+  return {text.begin(), text.end()};
+}
+
+/* Text trace does not know address of the very first instruction */
+void checkTrace(const TraceFile &trace, std::optional<Addr> firstAddr) {
+  auto cursor = trace.makeCursor();
+  InstrEffects effects{};
+  auto addr = firstAddr;
+  auto num = kFirstNum;
+  for (; cursor->next(effects); ++num) {
+    EXPECT_EQ(effects.num, num);
+    EXPECT_EQ(effects.addr, addr);
+    ASSERT_EQ(effects.regs.size(), 1);
+    EXPECT_EQ(effects.regs[0].second, num);
+    EXPECT_EQ(effects.mems.size(), num % 3 == 0 ? 1 : 0);
+    addr = effects.pc;
+  }
+  EXPECT_EQ(num, kFirstNum + kNumInstrs);
+
+  // Seek is exact & restores instruction address
+  for (auto target : {std::uint64_t{0}, kFirstNum + 1, kFirstNum + 10,
+                      kFirstNum + 257, kFirstNum + kNumInstrs - 1}) {
+    cursor->seek(target);
+    ASSERT_TRUE(cursor->next(effects));
+    EXPECT_EQ(effects.num, std::max(target, kFirstNum));
+    if (target > kFirstNum)
+      EXPECT_TRUE(effects.addr.has_value());
+    else
+      EXPECT_EQ(effects.addr, firstAddr);
+  }
+  cursor->seek(kFirstNum + kNumInstrs);
+  EXPECT_FALSE(cursor->next(effects));
+
+  auto points = trace.getSplitPoints(8);
+  EXPECT_FALSE(points.empty());
+  EXPECT_TRUE(std::is_sorted(points.begin(), points.end()));
+  EXPECT_EQ(std::adjacent_find(points.begin(), points.end()), points.end());
+}
+
+} // namespace
+
+TEST(Cursor, binary) {
+  auto data = makeBinaryTrace();
+  TraceFile trace{data};
+  EXPECT_EQ(trace.getFormat(), TraceFile::Format::BINARY);
+  checkTrace(trace, kStartPC);
+
+  auto cursor = trace.makeCursor();
+  InstrEffects effects{};
+  cursor->seek(14);
+  ASSERT_TRUE(cursor->next(effects));
+  EXPECT_EQ(effects.flags, sim::trace::CSR_ACCESS);
+}
+
+TEST(Cursor, text) {
+  auto data = makeTextTrace();
+  TraceFile trace{data};
+  EXPECT_EQ(trace.getFormat(), TraceFile::Format::TEXT);
+  checkTrace(trace, std::nullopt);
+}
+
+TEST(Cursor, badText) {
+  std::string text{"-----\nNUM=1\nx1=0x1\nfoo\nPC=0x4\n"};
+  std::vector<Byte> data{text.begin(), text.end()};
+  TraceFile trace{data};
+  auto cursor = trace.makeCursor();
+  InstrEffects effects{};
+  EXPECT_THROW(cursor->next(effects), std::runtime_error);
+}
+
+#include "test_footer.hh"
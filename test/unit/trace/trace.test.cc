@@ -0,0 +1,162 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "test_header.hh"
+#include "test_files.hh"
+
+#include "common/common.hh"
+#include "trace/ring_buffer.hh"
+#include "trace/trace.hh"
+
+namespace fs = std::filesystem;
+
+using sim::Addr;
+using sim::Byte;
+using sim::TraceReader;
+using sim::TraceRecord;
+using sim::Tracer;
+
+namespace {
+
+fs::path getTracePath(const std::string &name) {
+  return sim::test::getTempPath(name, ".trace");
+}
+
+std::vector<TraceRecord> readAll(const fs::path &file) {
+  TraceReader reader{file};
+  std::vector<TraceRecord> records{};
+  for (TraceRecord rec{}; reader.next(rec);)
+    records.push_back(rec);
+  return records;
+}
+
+} // namespace
+
+TEST(Trace, ringBuffer) {
+  constexpr std::size_t kNum = 100000;
+  sim::SPSCRingBuffer<std::size_t> ring{4};
+  EXPECT_THROW(sim::SPSCRingBuffer<int>{3}, std::invalid_argument);
+
+  std::size_t sum = 0;
+  std::thread consumer{[&] {
+    for (std::size_t i = 0; i < kNum; ++i) {
+      sum += ring.peek();
+      ring.release();
+    }
+  }};
+  for (std::size_t i = 0; i < kNum; ++i) {
+    ring.acquire() = i;
+    ring.publish();
+  }
+  consumer.join();
+
+  EXPECT_EQ(sum, kNum * (kNum - 1) / 2);
+  EXPECT_EQ(ring.tryPeek(), nullptr);
+}
+
+TEST(Trace, zigzag) {
+  for (std::int64_t val : {0L, 1L, -1L, 0x7FFFFFFFL, -0x80000000L})
+    EXPECT_EQ(sim::trace::zigzagDecode(sim::trace::zigzagEncode(val)), val);
+  EXPECT_EQ(sim::trace::zigzagEncode(-1), 1);
+  EXPECT_EQ(sim::trace::wordDelta(0, 0xFFFFFFFF), 1);
+}
+
+TEST(Trace, roundTrip) {
+  // Chunks are small to get many frames
+  constexpr std::size_t kChunkSize = 64;
+  constexpr std::uint64_t kNumInstrs = 1000;
+  auto file = getTracePath("roundTrip");
+  {
+    Tracer tracer{file, kChunkSize, 2};
+    tracer.sync(1, 0x1000);
+    Addr pc = 0x1000;
+    for (std::uint64_t i = 0; i < kNumInstrs; ++i) {
+      tracer.regWrite(static_cast<sim::RegId>(i % sim::kRegNum),
+                      static_cast<sim::RegVal>(i * 0x10001 - 5));
+      if (i % 3 == 0)
+        tracer.memWrite(static_cast<Addr>(0x8000 - i * 4),
+                        static_cast<sim::Word>(i));
+      // Jump back every 7th instruction
+      pc = i % 7 ? pc + 4 : pc - 0x40;
+      tracer.instrEnd(pc, i % 5 ? 0 : sim::trace::CSR_ACCESS);
+    }
+  }
+
+  auto records = readAll(file);
+  fs::remove(file);
+
+  Addr pc = 0x1000;
+  std::uint64_t i = 0;
+  for (const auto &rec : records) {
+    ASSERT_LT(i, kNumInstrs);
+    EXPECT_EQ(rec.instrNum, i + 1);
+    switch (rec.type) {
+    case sim::trace::SYNC:
+      EXPECT_EQ(rec.pc, pc);
+      break;
+    case sim::trace::REG:
+      EXPECT_EQ(rec.reg, i % sim::kRegNum);
+      EXPECT_EQ(rec.value, static_cast<sim::RegVal>(i * 0x10001 - 5));
+      break;
+    case sim::trace::MEM:
+      EXPECT_EQ(rec.addr, 0x8000 - i * 4);
+      EXPECT_EQ(rec.value, i);
+      break;
+    case sim::trace::INSN:
+      pc = i % 7 ? pc + 4 : pc - 0x40;
+      EXPECT_EQ(rec.pc, pc);
+      EXPECT_EQ(rec.flags, i % 5 ? 0 : sim::trace::CSR_ACCESS);
+      ++i;
+      break;
+    case sim::trace::INSN_SEQ:
+    default:
+      FAIL() << "Unexpected record type";
+    }
+  }
+  EXPECT_EQ(i, kNumInstrs);
+}
+
+TEST(Trace, resync) {
+  auto file = getTracePath("resync");
+  {
+    Tracer tracer{file};
+    tracer.sync(10, 0x100);
+    tracer.instrEnd(0x104, 0);
+    tracer.sync(50, 0x200);
+    tracer.regWrite(1, 42);
+    tracer.instrEnd(0x204, 0);
+  }
+
+  auto records = readAll(file);
+  fs::remove(file);
+
+  ASSERT_EQ(records.size(), 5);
+  EXPECT_EQ(records[1].instrNum, 10);
+  EXPECT_EQ(records[2].type, sim::trace::SYNC);
+  EXPECT_EQ(records[2].instrNum, 50);
+  EXPECT_EQ(records[3].instrNum, 50);
+  EXPECT_EQ(records[3].value, 42);
+  EXPECT_EQ(records[4].pc, 0x204);
+}
+
+TEST(Trace, badTrace) {
+  std::vector<Byte> data(sim::trace::kHeaderSize);
+  EXPECT_THROW(TraceReader{data}, std::runtime_error);
+
+  std::copy(sim::trace::kMagic.begin(), sim::trace::kMagic.end(),
+            data.begin());
+  data[sim::trace::kMagic.size()] = sim::trace::kVersion;
+  TraceReader empty{data};
+  TraceRecord rec{};
+  EXPECT_FALSE(empty.next(rec));
+
+  // Frame is longer than data
+  data.insert(data.end(), {8, 0, 0, 0, sim::trace::SYNC});
+  TraceReader truncated{data};
+  EXPECT_THROW(truncated.next(rec), std::runtime_error);
+}
+
+#include "test_footer.hh"
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <CLI/App.hpp>
+#include <CLI/Config.hpp>
+#include <CLI/Formatter.hpp>
+
+#include <fmt/format.h>
+
+#include "trace/cursor.hh"
+#include "trace/trace.hh"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct CompareOptions final {
+  std::size_t context{};
+  // Ignore register values written by CSR accesses, only binary traces mark
+  // them
+  bool skipCSR{};
+  // Ignore register values written by instructions at these addresses
+  std::unordered_set<sim::Addr> ignoredPCs{};
+};
+
+struct Mismatch final {
+  std::uint64_t num{};
+  std::string reason{};
+  // Last instructions up to mismatched one
+  std::vector<sim::InstrEffects> master{};
+  std::vector<sim::InstrEffects> slave{};
+};
+
+struct PartResult final {
+  std::optional<Mismatch> mismatch{};
+  std::uint64_t numCompared{};
+};
+
+bool isIgnoredRegs(const sim::InstrEffects &lhs, const sim::InstrEffects &rhs,
+                   const CompareOptions &opts) {
+  if (opts.skipCSR && ((lhs.flags | rhs.flags) & sim::trace::CSR_ACCESS))
+    return true;
+  auto addr = lhs.addr ? lhs.addr : rhs.addr;
+  return addr && opts.ignoredPCs.contains(*addr);
+}
+
+/* Empty string if instructions match */
+std::string compare(const sim::InstrEffects &master,
+                    const sim::InstrEffects &slave,
+                    const CompareOptions &opts) {
+  if (master.num != slave.num)
+    return fmt::format("instruction numbers differ: NUM={} vs NUM={}",
+                       master.num, slave.num);
+  if (master.pc != slave.pc)
+    return "PC differs";
+  if (master.mems != slave.mems)
+    return "memory writes differ";
+
+  auto sameReg = [](const auto &lhs, const auto &rhs) {
+    return lhs.first == rhs.first;
+  };
+  if (master.regs.size() != slave.regs.size() ||
+      !std::equal(master.regs.begin(), master.regs.end(), slave.regs.begin(),
+                  sameReg))
+    return "written registers differ";
+  if (master.regs != slave.regs && !isIgnoredRegs(master, slave, opts))
+    return "register values differ";
+  return {};
+}
+
+class PartComparator final {
+public:
+  PartComparator(const sim::TraceFile &master, const sim::TraceFile &slave,
+                 const CompareOptions &opts)
+      : master_(master.makeCursor()), slave_(slave.makeCursor()),
+        opts_(opts), masterRing_(opts.context + 1),
+        slaveRing_(opts.context + 1) {}
+
+  /**
+   * @brief Compare instructions with numbers in [begin, end)
+   *
+   * @param[in] isCancelled returns true when comparison is not needed anymore
+   */
+  template <typename Pred>
+  PartResult run(std::uint64_t begin, std::uint64_t end, Pred isCancelled);
+
+private:
+  Mismatch makeMismatch(std::size_t count, std::string reason) const;
+
+  std::unique_ptr<sim::TraceCursor> master_;
+  std::unique_ptr<sim::TraceCursor> slave_;
+  const CompareOptions &opts_;
+  // Context of the last decoded instructions
+  std::vector<sim::InstrEffects> masterRing_;
+  std::vector<sim::InstrEffects> slaveRing_;
+};
+
+template <typename Pred>
+PartResult PartComparator::run(std::uint64_t begin, std::uint64_t end,
+                               Pred isCancelled) {
+  constexpr std::uint64_t kCancelCheckPeriod = 1 << 12;
+
+  // Start a bit earlier to get context for mismatch at the very beginning
+  auto start = begin - std::min<std::uint64_t>(begin, opts_.context);
+  master_->seek(start);
+  slave_->seek(start);
+
+  PartResult res{};
+  auto ringSize = masterRing_.size();
+  for (std::size_t count = 0;; ++count) {
+    if (count % kCancelCheckPeriod == 0 && isCancelled())
+      return res;
+
+    auto &master = masterRing_[count % ringSize];
+    auto &slave = slaveRing_[count % ringSize];
+    bool hasMaster = master_->next(master) && master.num < end;
+    bool hasSlave = slave_->next(slave) && slave.num < end;
+    if (!hasMaster && !hasSlave)
+      return res;
+
+    if (!hasMaster || !hasSlave) {
+      const auto &rest = hasMaster ? master : slave;
+      if (rest.num < begin)
+        continue;
+      res.mismatch = makeMismatch(
+          count, fmt::format("{} trace has no NUM={}",
+                             hasMaster ? "slave" : "master", rest.num));
+      res.mismatch->num = rest.num;
+      // Drop instruction beyond the end of finished trace
+      (hasMaster ? res.mismatch->slave : res.mismatch->master).pop_back();
+      return res;
+    }
+
+    if (master.num < begin && slave.num < begin)
+      continue;
+
+    if (auto reason = compare(master, slave, opts_); !reason.empty()) {
+      res.mismatch = makeMismatch(count, std::move(reason));
+      res.mismatch->num = std::min(master.num, slave.num);
+      return res;
+    }
+    ++res.numCompared;
+  }
+}
+
+Mismatch PartComparator::makeMismatch(std::size_t count,
+                                      std::string reason) const {
+  Mismatch mismatch{};
+  mismatch.reason = std::move(reason);
+
+  auto ringSize = masterRing_.size();
+  auto first = count - std::min(count, ringSize - 1);
+  for (auto i = first; i <= count; ++i) {
+    mismatch.master.push_back(masterRing_[i % ringSize]);
+    mismatch.slave.push_back(slaveRing_[i % ringSize]);
+  }
+  return mismatch;
+}
+
+void printContext(const std::string &name,
+                  const std::vector<sim::InstrEffects> &context) {
+  std::cout << name << ":\n";
+  for (const auto &effects : context)
+    std::cout << effects.str();
+}
+
+} // namespace
+
+int main(int argc, char **argv) try {
+  CLI::App app{"Compare cosim traces (text or binary)"};
+
+  fs::path masterFile{};
+  app.add_option("--master", masterFile, "Path to master trace")
+      ->required()
+      ->check(CLI::ExistingFile);
+
+  fs::path slaveFile{};
+  app.add_option("--slave", slaveFile, "Path to slave trace")
+      ->required()
+      ->check(CLI::ExistingFile);
+
+  std::size_t numThreads{};
+  app.add_option("-j,--jobs", numThreads, "Number of comparison threads")
+      ->default_val(std::max(1U, std::thread::hardware_concurrency()));
+
+  CompareOptions opts{};
+  app.add_option("--context", opts.context,
+                 "Number of instructions printed before mismatch")
+      ->default_val(3);
+
+  app.add_flag("--skip-csr", opts.skipCSR,
+               "Ignore values read from CSRs (e.g. counters), at least one "
+               "trace has to be binary");
+
+  std::vector<std::string> ignoredPCs{};
+  app.add_option("--ignore-pc", ignoredPCs,
+                 "Ignore register values written by instruction at address");
+
+  try {
+    app.parse(argc, argv);
+  } catch (const CLI::ParseError &e) {
+    return app.exit(e);
+  }
+
+  for (const auto &pc : ignoredPCs)
+    opts.ignoredPCs.insert(static_cast<sim::Addr>(std::stoul(pc, nullptr, 0)));
+
+  sim::TraceFile master{masterFile};
+  sim::TraceFile slave{slaveFile};
+  // Text format has no instruction flags to tell CSR accesses apart
+  auto isText = [](const sim::TraceFile &trace) {
+    return trace.getFormat() == sim::TraceFile::Format::TEXT;
+  };
+  if (opts.skipCSR && isText(master) && isText(slave))
+    throw std::invalid_argument{
+        "--skip-csr requires at least one binary trace"};
+
+  // Parts are compared in parallel, the first mismatch is in the lowest part
+  // which has one. Parts above the one with a known mismatch are cancelled.
+  auto bounds = master.getSplitPoints(std::max<std::size_t>(numThreads, 1));
+  bounds.insert(bounds.begin(), 0);
+  bounds.push_back(UINT64_MAX);
+  auto numParts = bounds.size() - 1;
+
+  std::vector<PartResult> results(numParts);
+  std::atomic<std::size_t> firstMismatch{numParts};
+  {
+    std::vector<std::jthread> workers{};
+    for (std::size_t i = 0; i < numParts; ++i)
+      workers.emplace_back([&, i] {
+        PartComparator comparator{master, slave, opts};
+        results[i] = comparator.run(bounds[i], bounds[i + 1], [&, i] {
+          return firstMismatch.load(std::memory_order_relaxed) < i;
+        });
+        if (!results[i].mismatch)
+          return;
+        auto cur = firstMismatch.load();
+        while (i < cur && !firstMismatch.compare_exchange_weak(cur, i))
+          ;
+      });
+  }
+
+  if (firstMismatch == numParts) {
+    std::uint64_t numCompared{};
+    for (const auto &res : results)
+      numCompared += res.numCompared;
+    std::cout << "Successfully compared " << numCompared << " instructions"
+              << std::endl;
+    return 0;
+  }
+
+  const auto &mismatch = *results[firstMismatch].mismatch;
+  std::cout << "Mismatch at NUM=" << mismatch.num << ": " << mismatch.reason
+            << "\n";
+  printContext("master", mismatch.master);
+  printContext("slave", mismatch.slave);
+  std::cout.flush();
+  return 1;
+} catch (const std::exception &e) {
+  std::cerr << e.what() << std::endl;
+  return 2;
+}
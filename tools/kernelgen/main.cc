@@ -0,0 +1,59 @@
+#include <filesystem>
+#include <iostream>
+#include <map>
+
+#include <CLI/App.hpp>
+#include <CLI/Config.hpp>
+#include <CLI/Formatter.hpp>
+
+#include "assembler/assembler.hh"
+#include "assembler/kernels.hh"
+
+namespace fs = std::filesystem;
+
+int main(int argc, char **argv) try {
+  CLI::App app{"Generate RV32 microkernel executable"};
+
+  sim::Kernel kernel{};
+  std::map<std::string, sim::Kernel> map{
+      {"straight-line", sim::Kernel::STRAIGHT_LINE},
+      {"loop", sim::Kernel::LOOP},
+      {"call-chain", sim::Kernel::CALL_CHAIN},
+      {"indirect-maze", sim::Kernel::INDIRECT_MAZE},
+      {"mem-stride", sim::Kernel::MEM_STRIDE}};
+  app.add_option("kernel", kernel, "Kernel to generate")
+      ->required()
+      ->transform(CLI::CheckedTransformer(map, CLI::ignore_case));
+
+  fs::path output{};
+  app.add_option("-o,--output", output, "Output executable")
+      ->required()
+      ->check(!CLI::ExistingDirectory);
+
+  sim::KernelParams params{};
+  app.add_option("-n,--iterations", params.iterations,
+                 "Number of outer loop iterations")
+      ->default_val(params.iterations);
+  app.add_option("-s,--size", params.size,
+                 "Block length, inner loop trip count, call depth, number of "
+                 "maze blocks or number of array elements")
+      ->default_val(params.size);
+  app.add_option("--stride", params.stride,
+                 "Distance between array elements in bytes (mem-stride)")
+      ->default_val(params.stride);
+
+  try {
+    app.parse(argc, argv);
+  } catch (const CLI::ParseError &e) {
+    return app.exit(e);
+  }
+
+  sim::Assembler as{};
+  sim::generateKernel(as, kernel, params);
+  as.write(output);
+
+  return 0;
+} catch (const std::exception &e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+}
@@ -0,0 +1,61 @@
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <CLI/App.hpp>
+#include <CLI/Config.hpp>
+#include <CLI/Formatter.hpp>
+
+#include "hart/batch.hh"
+#include "hart/hart.hh"
+#include "hart/server.hh"
+
+namespace fs = std::filesystem;
+
+int main(int argc, char **argv) try {
+  CLI::App app{"Run executable on simulator server (simulator --serve)"};
+
+  fs::path socket{};
+  app.add_option("-s,--socket", socket, "Socket server listens on")
+      ->required();
+
+  sim::BatchJob job{};
+  app.add_option("input", job.executable, "Executable file")
+      ->required()
+      ->check(CLI::ExistingFile);
+
+  app.add_option("--max-instrs", job.maxInstrs,
+                 "Stop job after this number of instructions");
+
+  bool printStats{false};
+  app.add_flag("--print-stats", printStats,
+               "Print instructions, time & decoded blocks to stderr");
+
+  try {
+    app.parse(argc, argv);
+  } catch (const CLI::ParseError &e) {
+    return app.exit(e);
+  }
+
+  std::string console{};
+  auto res = sim::submitJob(socket, job, console);
+  std::cout << console << std::flush;
+
+  if (printStats)
+    std::cerr << "Status: " << sim::BatchResult::getStatusName(res.status)
+              << "\nInstruction number: " << res.numInstrs
+              << "\nElapsed time: " << res.timeMcs << "us"
+              << "\nDecoded blocks: " << res.numDecodedBlocks
+              << "\nShared blocks: " << res.numSharedBlocks << std::endl;
+
+  if (res.status == sim::BatchResult::COMPLETED)
+    return res.exitCode;
+  if (res.status == sim::BatchResult::LIMIT)
+    std::cerr << "Instruction limit reached" << std::endl;
+  else
+    std::cerr << res.error << std::endl;
+  return 1;
+} catch (const std::exception &e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+}
@@ -1,8 +1,15 @@
+#include <algorithm>
 #include <chrono>
+#include <csignal>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <CLI/App.hpp>
 #include <CLI/Config.hpp>
@@ -13,8 +20,17 @@
 #include <spdlog/spdlog.h>
 
 #include "common/common.hh"
+#include "common/host_perf.hh"
+#include "common/stats.hh"
 #include "common/timer.hh"
+#include "elfloader/elfloader.hh"
+#include "hart/batch.hh"
+#include "hart/bbv.hh"
+#include "hart/bisect.hh"
 #include "hart/hart.hh"
+#include "hart/multi_hart.hh"
+#include "hart/server.hh"
+#include "hart/simpoint.hh"
 
 namespace fs = std::filesystem;
 namespace lvl = spdlog::level;
@@ -41,9 +57,8 @@ int main(int argc, char **argv) try {
       ->default_val("warn");
 
   fs::path input{};
-  app.add_option("input", input, "Executable file")
-      ->required()
-      ->check(CLI::ExistingFile);
+  auto *inputOpt = app.add_option("input", input, "Executable file")
+                       ->check(CLI::ExistingFile);
 
   auto *isCosimOpt = app.add_flag("--cosim", "Enable cosim mode");
 
@@ -64,15 +79,316 @@ int main(int argc, char **argv) try {
       });
 
   bool printPerf{false};
-  app.add_flag("--print-perf", printPerf,
-               "Print information about performance");
+  auto *printPerfOpt = app.add_flag("--print-perf", printPerf,
+                                    "Print information about performance");
+
+  bool isHostPerf{false};
+  auto *hostPerfOpt =
+      app.add_flag("--host-perf", isHostPerf,
+                   "Measure loading, decoding & execution w/ host "
+                   "performance counters");
+
+  bool isInstrMix{false};
+  auto *instrMixOpt =
+      app.add_flag("--instr-mix", isInstrMix,
+                   "Count dynamic instruction mix & print it w/ performance")
+          ->needs(printPerfOpt);
+
+  fs::path instrMixFile{};
+  auto *instrMixFileOpt =
+      app.add_option("--instr-mix-json", instrMixFile,
+                     "Count dynamic instruction mix & write it in JSON")
+          ->check(!CLI::ExistingDirectory);
+
+  fs::path statsFile{};
+  auto *statsFileOpt =
+      app.add_option("--stats-file", statsFile,
+                     "Write statistics in JSON (CSV for .csv extension)")
+          ->check(!CLI::ExistingDirectory);
+
+  std::uint64_t statsInterval{};
+  app.add_option("--stats-interval", statsInterval,
+                 "Also dump statistics every N instructions (0 for final "
+                 "dump only)")
+      ->needs(statsFileOpt)
+      ->default_val(0);
+
+  std::vector<std::string> statsGroups{};
+  app.add_option("--stats-groups", statsGroups,
+                 "Statistics groups: executor, instr_mix, tlb, memory, "
+                 "bbcache, decoder")
+      ->needs(statsFileOpt)
+      ->delimiter(',')
+      ->default_val("executor,memory,tlb,decoder");
 
   std::int64_t bbCacheSize{};
   app.add_option("--bbc-size", bbCacheSize, "Set size of basic block cache")
       ->default_val(-1);
 
+  std::size_t tlbSize{};
+  app.add_option("--tlb-size", tlbSize, "Set number of entries in each TLB")
+      ->default_val(sim::kTLBSize);
+
+  std::size_t tlbWays{};
+  app.add_option("--tlb-ways", tlbWays, "Set TLB associativity")
+      ->default_val(sim::kTLBWays);
+
+  bool attachDevices{false};
+  auto *devicesOpt = app.add_flag(
+      "--devices", attachDevices, "Attach UART console, CLINT & test finisher");
+
+  fs::path saveCheckpointFile{};
+  auto *saveCheckpointOpt =
+      app.add_option("--save-checkpoint", saveCheckpointFile,
+                     "Save checkpoint to file & exit")
+          ->check(!CLI::ExistingDirectory);
+
+  std::uint64_t atInsn{};
+  app.add_option("--at-insn", atInsn,
+                 "Number of instruction to take checkpoint before")
+      ->needs(saveCheckpointOpt)
+      ->default_val(1);
+
+  fs::path restoreCheckpointFile{};
+  auto *restoreCheckpointOpt =
+      app.add_option("--restore-checkpoint", restoreCheckpointFile,
+                     "Start simulation from checkpoint")
+          ->check(CLI::ExistingFile);
+
+  fs::path traceFile{};
+  auto *traceOpt = app.add_option("--trace", traceFile,
+                                  "Write binary trace (see trace2text tool)")
+                       ->check(!CLI::ExistingDirectory);
+
+  std::uint64_t traceFrom{};
+  app.add_option("--trace-from", traceFrom,
+                 "Number of the first instruction to trace")
+      ->needs(traceOpt)
+      ->default_val(1);
+
+  std::uint64_t traceTo{};
+  app.add_option("--trace-to", traceTo,
+                 "Stop tracing before instruction with this number")
+      ->needs(traceOpt)
+      ->default_val(sim::Hart::kNoStop);
+
+  bool isLockstep{false};
+  auto *lockstepOpt =
+      app.add_flag("--lockstep", isLockstep,
+                   "Compare w/ golden interpreter at every basic block");
+
+  fs::path saveHashesFile{};
+  auto *saveHashesOpt =
+      app.add_option("--save-hashes", saveHashesFile,
+                     "Write state hashes taken every --hash-interval "
+                     "instructions")
+          ->check(!CLI::ExistingDirectory);
+
+  std::uint64_t hashInterval{};
+  app.add_option("--hash-interval", hashInterval,
+                 "Number of instructions between state hashes")
+      ->needs(saveHashesOpt)
+      ->default_val(1000000);
+
+  fs::path checkHashesFile{};
+  auto *checkHashesOpt =
+      app.add_option("--check-hashes", checkHashesFile,
+                     "Compare state hashes w/ reference ones, trace only the "
+                     "diverged interval")
+          ->check(CLI::ExistingFile)
+          ->excludes(saveHashesOpt)
+          ->excludes(lockstepOpt);
+
+  fs::path bisectTraceFile{};
+  app.add_option("--bisect-trace", bisectTraceFile,
+                 "Binary trace of the diverged interval")
+      ->needs(checkHashesOpt)
+      ->check(!CLI::ExistingDirectory)
+      ->default_val("./bisect.trace");
+
+  fs::path profileFile{};
+  auto *profileOpt =
+      app.add_option("--profile", profileFile,
+                     "Sample guest call stacks & write them in collapsed "
+                     "(flamegraph) format")
+          ->check(!CLI::ExistingDirectory)
+          ->excludes(saveCheckpointOpt)
+          ->excludes(saveHashesOpt)
+          ->excludes(checkHashesOpt);
+
+  std::uint64_t profilePeriod{};
+  app.add_option("--profile-period", profilePeriod,
+                 "Number of instructions between profile samples")
+      ->needs(profileOpt)
+      ->default_val(sim::Profiler::kDefaultPeriod);
+
+  std::size_t numHotBlocks{};
+  auto *hotBlocksOpt =
+      app.add_option("--hot-blocks", numHotBlocks,
+                     "Count executions of every basic block & print the "
+                     "hottest ones at exit");
+
+  fs::path hotBlocksFile{};
+  auto *hotBlocksFileOpt =
+      app.add_option("--hot-blocks-json", hotBlocksFile,
+                     "Count executions of every basic block & write them "
+                     "in JSON")
+          ->check(!CLI::ExistingDirectory);
+
+  fs::path bbvFile{};
+  auto *bbvOpt =
+      app.add_option("--bbv", bbvFile,
+                     "Write basic block vectors in SimPoint .bb format")
+          ->check(!CLI::ExistingDirectory)
+          ->excludes(saveCheckpointOpt)
+          ->excludes(saveHashesOpt)
+          ->excludes(checkHashesOpt)
+          ->excludes(traceOpt);
+
+  std::uint64_t bbvInterval{};
+  app.add_option("--bbv-interval", bbvInterval,
+                 "Number of instructions in basic block vector interval")
+      ->needs(bbvOpt)
+      ->default_val(100000000);
+
+  fs::path simpointsFile{};
+  auto *simpointsOpt =
+      app.add_option("--simpoints", simpointsFile,
+                     "Simulate only intervals from SimPoint .simpoints file "
+                     "in parallel & print weighted results")
+          ->check(CLI::ExistingFile)
+          ->excludes(saveCheckpointOpt)
+          ->excludes(restoreCheckpointOpt)
+          ->excludes(saveHashesOpt)
+          ->excludes(checkHashesOpt)
+          ->excludes(traceOpt)
+          ->excludes(bbvOpt);
+
+  fs::path weightsFile{};
+  auto *weightsOpt =
+      app.add_option("--weights", weightsFile, "SimPoint .weights file")
+          ->check(CLI::ExistingFile)
+          ->needs(simpointsOpt);
+  simpointsOpt->needs(weightsOpt);
+
+  std::uint64_t simpointInterval{};
+  app.add_option("--simpoint-interval", simpointInterval,
+                 "Number of instructions in SimPoint interval")
+      ->needs(simpointsOpt)
+      ->default_val(100000000);
+
+  std::size_t numJobs{};
+  app.add_option("-j,--jobs", numJobs,
+                 "Number of threads simulating SimPoint intervals, batch "
+                 "jobs or served clients")
+      ->default_val(std::max(1U, std::thread::hardware_concurrency()));
+
+  fs::path simpointCheckpointDir{};
+  app.add_option("--simpoint-checkpoint-dir", simpointCheckpointDir,
+                 "Directory for temporary checkpoints of intervals")
+      ->needs(simpointsOpt)
+      ->default_val(fs::temp_directory_path().string());
+
+  std::size_t numHarts{};
+  auto *hartsOpt =
+      app.add_option("--harts", numHarts,
+                     "Number of harts sharing memory, each one reads its "
+                     "index from mhartid")
+          ->default_val(1)
+          ->excludes(devicesOpt)
+          ->excludes(hostPerfOpt)
+          ->excludes(instrMixOpt)
+          ->excludes(instrMixFileOpt)
+          ->excludes(statsFileOpt)
+          ->excludes(saveCheckpointOpt)
+          ->excludes(restoreCheckpointOpt)
+          ->excludes(traceOpt)
+          ->excludes(lockstepOpt)
+          ->excludes(saveHashesOpt)
+          ->excludes(checkHashesOpt)
+          ->excludes(profileOpt)
+          ->excludes(hotBlocksOpt)
+          ->excludes(hotBlocksFileOpt)
+          ->excludes(bbvOpt)
+          ->excludes(simpointsOpt);
+
+  std::size_t numHostThreads{};
+  app.add_option("--host-threads", numHostThreads,
+                 "Number of host threads running harts cooperatively, "
+                 "defaults to one per hart")
+      ->needs(hartsOpt);
+
+  std::uint64_t sliceBlocks{};
+  app.add_option("--slice-blocks", sliceBlocks,
+                 "Number of basic blocks hart runs before yielding its host "
+                 "thread to another hart")
+      ->needs(hartsOpt)
+      ->default_val(sim::HartScheduler::kDefaultSliceBlocks);
+
+  fs::path batchFile{};
+  auto *batchOpt =
+      app.add_option("--batch", batchFile,
+                     "Run jobs listed in file on a pool of threads, jobs of "
+                     "identical executables share loaded pages & decoded "
+                     "blocks")
+          ->check(CLI::ExistingFile)
+          ->excludes(inputOpt)
+          ->excludes(hartsOpt)
+          ->excludes(isCosimOpt)
+          ->excludes(devicesOpt)
+          ->excludes(hostPerfOpt)
+          ->excludes(instrMixOpt)
+          ->excludes(instrMixFileOpt)
+          ->excludes(statsFileOpt)
+          ->excludes(saveCheckpointOpt)
+          ->excludes(restoreCheckpointOpt)
+          ->excludes(traceOpt)
+          ->excludes(lockstepOpt)
+          ->excludes(saveHashesOpt)
+          ->excludes(checkHashesOpt)
+          ->excludes(profileOpt)
+          ->excludes(hotBlocksOpt)
+          ->excludes(hotBlocksFileOpt)
+          ->excludes(bbvOpt)
+          ->excludes(simpointsOpt);
+
+  fs::path batchResultsFile{};
+  app.add_option("--batch-results", batchResultsFile,
+                 "Write results of batch jobs to file instead of stdout")
+      ->needs(batchOpt);
+
+  fs::path serveSocket{};
+  auto *serveOpt =
+      app.add_option("--serve", serveSocket,
+                     "Run jobs submitted through UNIX socket (see simclient "
+                     "tool) till SIGINT or SIGTERM, loaded executables stay "
+                     "warm between jobs")
+          ->check(!CLI::ExistingDirectory)
+          ->excludes(inputOpt)
+          ->excludes(batchOpt)
+          ->excludes(hartsOpt)
+          ->excludes(isCosimOpt)
+          ->excludes(devicesOpt)
+          ->excludes(hostPerfOpt)
+          ->excludes(instrMixOpt)
+          ->excludes(instrMixFileOpt)
+          ->excludes(statsFileOpt)
+          ->excludes(saveCheckpointOpt)
+          ->excludes(restoreCheckpointOpt)
+          ->excludes(traceOpt)
+          ->excludes(lockstepOpt)
+          ->excludes(saveHashesOpt)
+          ->excludes(checkHashesOpt)
+          ->excludes(profileOpt)
+          ->excludes(hotBlocksOpt)
+          ->excludes(hotBlocksFileOpt)
+          ->excludes(bbvOpt)
+          ->excludes(simpointsOpt);
+
   try {
     app.parse(argc, argv);
+    if (!*inputOpt && !*batchOpt && !*serveOpt)
+      throw CLI::RequiredError{"input"};
   } catch (const CLI::ParseError &e) {
     return app.exit(e);
   }
@@ -81,21 +397,267 @@ int main(int argc, char **argv) try {
   if (*isCosimOpt) {
     initCosimLogger(cosimFile, !*cosimFileOpt);
   }
+
+  if (*simpointsOpt) {
+    sim::HartConfig config{bbCacheSize, tlbSize, tlbWays};
+    sim::IntervalSampler sampler{input, config, simpointInterval};
+    auto results =
+        sampler.run(sim::loadSimPoints(simpointsFile, weightsFile), numJobs,
+                    simpointCheckpointDir);
+    sim::IntervalSampler::print(std::cout, results);
+    if constexpr (timer::kSelfProfile)
+      timer::printSectionTimes(std::cout);
+    return 0;
+  }
+
+  if (*batchOpt) {
+    auto jobs = sim::loadBatchJobs(batchFile);
+    sim::BatchRunner runner{{bbCacheSize, tlbSize, tlbWays}};
+    auto results = runner.run(jobs, numJobs);
+    if (batchResultsFile.empty())
+      sim::BatchRunner::print(std::cout, jobs, results);
+    else {
+      std::ofstream ost{batchResultsFile};
+      sim::BatchRunner::print(ost, jobs, results);
+      if (!ost.flush())
+        throw std::runtime_error{"Failed to write " +
+                                 batchResultsFile.string()};
+    }
+
+    if (printPerf)
+      std::cout << "Executables loaded: " << runner.getNumImages()
+                << std::endl;
+    bool isPassed = std::all_of(results.begin(), results.end(),
+                                [](const auto &res) { return res.isPassed(); });
+    return isPassed ? 0 : 1;
+  }
+
+  if (*serveOpt) {
+    // Signals are handled by dedicated thread, workers never see them
+    sigset_t signals{};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    sim::JobServer server{serveSocket, {bbCacheSize, tlbSize, tlbWays},
+                          numJobs};
+    spdlog::info("Serving on {}", serveSocket.string());
+    // Waiter is stopped on exit if server has failed
+    std::jthread waiter{[&](const std::stop_token &stop) {
+      timespec timeout{0, 100'000'000};
+      while (!stop.stop_requested())
+        if (sigtimedwait(&signals, nullptr, &timeout) > 0) {
+          server.stop();
+          return;
+        }
+    }};
+    server.run();
+    if (printPerf)
+      std::cout << "Jobs run: " << server.getNumJobs() << std::endl;
+    return 0;
+  }
+
+  if (numHarts > 1) {
+    sim::MultiHart harts{input, numHarts, {bbCacheSize, tlbSize, tlbWays}};
+    if (numHostThreads == 0)
+      numHostThreads = numHarts;
+    timer::Timer timer;
+    auto schedStats = harts.run(numHostThreads, sliceBlocks);
+    auto time = timer.elapsedMcs();
+
+    if (printPerf) {
+      auto numInstrs = harts.getNumInstrs();
+      for (std::size_t i = 0; i < harts.getNumHarts(); ++i)
+        std::cout << "Hart " << i << " instruction number: "
+                  << harts.getHart(i).getInstrCount() << std::endl;
+      std::cout << "Time slices: " << schedStats.numSlices
+                << ", steals: " << schedStats.numSteals << std::endl;
+      std::cout << "Elapsed time: " << static_cast<double>(time) / 1e6 << "s"
+                << std::endl;
+      if (time > 0)
+        std::cout << "Perf: "
+                  << (static_cast<double>(numInstrs) /
+                      static_cast<double>(time))
+                  << " MIPS" << std::endl;
+    }
+    if constexpr (timer::kSelfProfile)
+      timer::printSectionTimes(std::cout);
+    return 0;
+  }
+
+  std::unique_ptr<sim::HostPerf> hostPerf{};
+  if (isHostPerf) {
+    hostPerf = std::make_unique<sim::HostPerf>();
+    if (!hostPerf->isAvailable()) {
+      spdlog::warn("Host performance counters are unavailable: {}",
+                   hostPerf->getError());
+      hostPerf.reset();
+    }
+  }
+
+  if (hostPerf)
+    hostPerf->begin(sim::HostPerf::LOAD);
   sim::Hart hart{input, bbCacheSize};
+  if (hostPerf) {
+    hostPerf->end(sim::HostPerf::LOAD);
+    hart.setHostPerf(hostPerf.get());
+  }
+  hart.configureTLB(tlbSize, tlbWays);
+  if (attachDevices)
+    hart.attachDevices(std::cout);
+  if (*restoreCheckpointOpt)
+    hart.restoreCheckpoint(restoreCheckpointFile);
+  if (isLockstep)
+    hart.enableLockstep();
+  if (*profileOpt)
+    hart.enableProfiler(sim::ELFLoader{input}.getFunctionSymbols(),
+                        profilePeriod);
+  bool isBlockStats = *hotBlocksOpt || *hotBlocksFileOpt;
+  if (isBlockStats)
+    hart.enableBlockStats();
+  if (isInstrMix || *instrMixFileOpt)
+    hart.enableInstrMix();
+
+  sim::StatsRegistry statsRegistry{statsGroups};
+  std::ofstream statsOst{};
+  std::unique_ptr<sim::StatsWriter> statsWriter{};
+  if (*statsFileOpt) {
+    hart.registerStats(statsRegistry);
+    statsOst.open(statsFile);
+    if (!statsOst)
+      throw std::runtime_error{"Failed to create " + statsFile.string()};
+    auto format = statsFile.extension() == ".csv"
+                      ? sim::StatsWriter::Format::CSV
+                      : sim::StatsWriter::Format::JSON;
+    statsWriter =
+        std::make_unique<sim::StatsWriter>(statsRegistry, statsOst, format);
+  }
+  // Run in intervals if statistics are dumped periodically
+  auto runTo = [&](std::uint64_t stopAt) {
+    if (!statsWriter || !statsInterval)
+      return hart.run(stopAt);
+    for (;;) {
+      auto numInstrs = hart.getInstrCount() - 1;
+      auto next = (numInstrs / statsInterval + 1) * statsInterval + 1;
+      if (next >= stopAt)
+        return hart.run(stopAt);
+      if (hart.run(next))
+        return true;
+      statsWriter->dump(next - 1);
+    }
+  };
+
+  if (*saveCheckpointOpt) {
+    if (hart.run(atInsn))
+      throw std::runtime_error{"Program has completed before instruction " +
+                               std::to_string(atInsn)};
+    hart.saveCheckpoint(saveCheckpointFile);
+    return 0;
+  }
+
+  if (*saveHashesOpt) {
+    std::ofstream ost{saveHashesFile};
+    if (!ost)
+      throw std::runtime_error{"Failed to create " + saveHashesFile.string()};
+    sim::HashCosim{hart, hashInterval}.record(ost);
+    return hart.getExitCode();
+  }
+
+  if (*checkHashesOpt) {
+    auto reference = sim::loadHashStream(checkHashesFile);
+    sim::HashCosim cosim{hart, reference.interval};
+    auto mismatch = cosim.check(reference, bisectTraceFile);
+    if (!mismatch)
+      return hart.getExitCode();
+
+    spdlog::error("State hash #{} mismatch: instructions [{}, {}) are traced "
+                  "to {}",
+                  mismatch->index, mismatch->from, mismatch->to,
+                  bisectTraceFile.string());
+    return 1;
+  }
+
+  auto firstInstr = hart.getInstrCount();
   timer::Timer timer;
-  hart.run();
+  if (hostPerf)
+    hostPerf->begin(sim::HostPerf::RUN);
+  if (*bbvOpt) {
+    std::ofstream ost{bbvFile};
+    sim::BBVRecorder{hart, bbvInterval}.record(ost);
+    if (!ost.flush())
+      throw std::runtime_error{"Failed to write " + bbvFile.string()};
+  } else if (*traceOpt) {
+    bool isDone = traceFrom > hart.getInstrCount() && runTo(traceFrom);
+    if (!isDone) {
+      hart.startTrace(traceFile);
+      isDone = runTo(traceTo);
+      hart.stopTrace();
+    }
+    if (!isDone)
+      runTo(sim::Hart::kNoStop);
+  } else
+    runTo(sim::Hart::kNoStop);
   auto time = timer.elapsedMcs();
+  if (hostPerf)
+    hostPerf->end(sim::HostPerf::RUN);
+
+  if (statsWriter) {
+    statsWriter->dump(hart.getInstrCount() - 1);
+    statsWriter->finish();
+    if (!statsOst)
+      throw std::runtime_error{"Failed to write " + statsFile.string()};
+  }
+
+  if (*profileOpt) {
+    std::ofstream ost{profileFile};
+    hart.writeProfile(ost);
+    if (!ost.flush())
+      throw std::runtime_error{"Failed to write " + profileFile.string()};
+  }
+
+  if (isBlockStats) {
+    sim::SymbolTable symbols{sim::ELFLoader{input}.getFunctionSymbols()};
+    const auto &stats = *hart.getBlockStats();
+    if (*hotBlocksOpt)
+      stats.print(std::cout, numHotBlocks, symbols);
+    if (*hotBlocksFileOpt) {
+      std::ofstream ost{hotBlocksFile};
+      stats.writeJSON(ost, symbols);
+      if (!ost.flush())
+        throw std::runtime_error{"Failed to write " + hotBlocksFile.string()};
+    }
+  }
 
   if (printPerf) {
     auto ic = hart.getInstrCount();
     std::cout << "Instruction number: " << ic << std::endl;
-    std::cout << "Elapsed time: " << time << "s" << std::endl;
-    std::cout << "Perf: "
-              << (static_cast<double>(ic) / static_cast<double>(time))
-              << " MIPS" << std::endl;
+    std::cout << "Elapsed time: " << static_cast<double>(time) / 1e6 << "s"
+              << std::endl;
+    // Instructions per microsecond are millions per second
+    if (time > 0)
+      std::cout << "Perf: "
+                << (static_cast<double>(ic) / static_cast<double>(time))
+                << " MIPS" << std::endl;
+    if constexpr (sim::TLB::kCollectStats)
+      hart.getMemory().printTLBStats(std::cout);
+    if (isInstrMix)
+      hart.getInstrMix()->print(std::cout);
+  }
+
+  if (hostPerf)
+    hostPerf->print(std::cout, hart.getInstrCount() - firstInstr);
+  if constexpr (timer::kSelfProfile)
+    timer::printSectionTimes(std::cout);
+
+  if (*instrMixFileOpt) {
+    std::ofstream ost{instrMixFile};
+    hart.getInstrMix()->writeJSON(ost);
+    if (!ost.flush())
+      throw std::runtime_error{"Failed to write " + instrMixFile.string()};
   }
 
-  return 0;
+  return hart.getExitCode();
 } catch (const std::exception &e) {
   spdlog::error(e.what());
   return 1;
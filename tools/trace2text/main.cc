@@ -0,0 +1,88 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <CLI/App.hpp>
+#include <CLI/Config.hpp>
+#include <CLI/Formatter.hpp>
+
+#include <fmt/format.h>
+
+#include "trace/trace.hh"
+
+namespace fs = std::filesystem;
+
+/* Print trace in the same text format as cosim logger does */
+static void convert(sim::TraceReader &reader, std::ostream &ost) {
+  sim::TraceRecord rec{};
+  bool isInstrStarted = false;
+  fmt::memory_buffer buf{};
+  auto out = std::back_inserter(buf);
+
+  while (reader.next(rec)) {
+    if (rec.type == sim::trace::SYNC)
+      continue;
+
+    if (!isInstrStarted) {
+      fmt::format_to(out, "-----------------------\nNUM={}\n", rec.instrNum);
+      isInstrStarted = true;
+    }
+
+    switch (rec.type) {
+    case sim::trace::REG:
+      fmt::format_to(out, "x{}=0x{:08x}\n", rec.reg, rec.value);
+      break;
+    case sim::trace::MEM:
+      fmt::format_to(out, "M[0x{:08x}]=0x{:08x}\n", rec.addr, rec.value);
+      break;
+    case sim::trace::INSN:
+      fmt::format_to(out, "PC=0x{:08x}\n", rec.pc);
+      isInstrStarted = false;
+      break;
+    case sim::trace::SYNC:
+    case sim::trace::INSN_SEQ:
+    default:
+      break;
+    }
+
+    if (buf.size() > (1 << 16)) {
+      ost.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+      buf.clear();
+    }
+  }
+  ost.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+int main(int argc, char **argv) try {
+  CLI::App app{"Convert binary trace to text cosim format"};
+
+  fs::path input{};
+  app.add_option("input", input, "Binary trace")
+      ->required()
+      ->check(CLI::ExistingFile);
+
+  fs::path output{};
+  auto *outputOpt =
+      app.add_option("-o,--output", output, "Output file instead of stdout")
+          ->check(!CLI::ExistingDirectory);
+
+  try {
+    app.parse(argc, argv);
+  } catch (const CLI::ParseError &e) {
+    return app.exit(e);
+  }
+
+  sim::TraceReader reader{input};
+  if (*outputOpt) {
+    std::ofstream ost{output};
+    if (!ost)
+      throw std::runtime_error{"Failed to open " + output.string()};
+    convert(reader, ost);
+  } else
+    convert(reader, std::cout);
+
+  return 0;
+} catch (const std::exception &e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+}